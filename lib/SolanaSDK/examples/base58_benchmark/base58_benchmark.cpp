@@ -0,0 +1,85 @@
+// Base58 throughput of the fixed width codecs used for keys, hashes and
+// signatures against the generic codec, the fallback for other sizes, on
+// random 32 and 64 byte values. Both must produce the same results.
+#include <Arduino.h>
+#include <esp_random.h>
+#include <cstring>
+#include "SolanaSDK/base58.h"
+
+constexpr int ITERATIONS = 1000;
+
+uint8_t values[8][64];
+
+// Average microseconds per call of `body(i)`
+template <typename Body>
+double timeCalls(Body body)
+{
+  unsigned long start = micros();
+  for (int i = 0; i < ITERATIONS; ++i)
+  {
+    body(i);
+  }
+  return double(micros() - start) / ITERATIONS;
+}
+
+template <size_t N, size_t MAX_LEN>
+void benchmark(size_t (*encodeFixed)(const uint8_t *, char *), bool (*decodeFixed)(const char *, size_t, uint8_t *))
+{
+  char fixed[8][MAX_LEN + 1];
+  char generic[8][MAX_LEN + 1];
+  size_t fixedLens[8];
+  size_t genericLens[8];
+  uint8_t decoded[N];
+  bool identical = true;
+
+  const double encodeFixedMicros = timeCalls([&](int i)
+                                             { fixedLens[i % 8] = encodeFixed(values[i % 8], fixed[i % 8]); });
+  const double encodeGenericMicros = timeCalls([&](int i)
+                                               { Base58::encode(values[i % 8], N, Span<char>(generic[i % 8], MAX_LEN + 1), genericLens[i % 8]); });
+  for (int v = 0; v < 8; ++v)
+  {
+    identical &= fixedLens[v] == genericLens[v] && memcmp(fixed[v], generic[v], fixedLens[v]) == 0;
+  }
+
+  const double decodeFixedMicros = timeCalls([&](int i)
+                                             { identical &= decodeFixed(fixed[i % 8], fixedLens[i % 8], decoded) && memcmp(decoded, values[i % 8], N) == 0; });
+  const double decodeGenericMicros = timeCalls([&](int i)
+                                               {
+                                                 size_t len = 0;
+                                                 Base58::decode(fixed[i % 8], fixedLens[i % 8], Span<uint8_t>(decoded, N), len);
+                                                 identical &= len == N && memcmp(decoded, values[i % 8], N) == 0; });
+
+  Serial.printf("encode%u: %.2f us, generic %.2f us\n", unsigned(N), encodeFixedMicros, encodeGenericMicros);
+  Serial.printf("decode%u: %.2f us, generic %.2f us\n", unsigned(N), decodeFixedMicros, decodeGenericMicros);
+  Serial.printf("Identical results: %s\n", identical ? "yes" : "no");
+}
+
+void setup()
+{
+  Serial.begin(115200);
+
+  for (auto &value : values)
+  {
+    for (auto &byte : value)
+    {
+      byte = static_cast<uint8_t>(esp_random());
+    }
+  }
+  // Leading zero bytes take the '1' path of the codecs
+  values[0][0] = 0;
+
+  benchmark<32, BASE58_ENCODED_32_MAX_LEN>(
+      [](const uint8_t *bytes, char *out)
+      { return Base58::encode32(bytes, out); },
+      [](const char *str, size_t len, uint8_t *out)
+      { return Base58::decode32(str, len, out); });
+  benchmark<64, BASE58_ENCODED_64_MAX_LEN>(
+      [](const uint8_t *bytes, char *out)
+      { return Base58::encode64(bytes, out); },
+      [](const char *str, size_t len, uint8_t *out)
+      { return Base58::decode64(str, len, out); });
+}
+
+void loop()
+{
+}
@@ -0,0 +1,54 @@
+// Signing throughput of a SigningKey against crypto_sign_ed25519_detached
+// with the Keypair it comes from, over a message the size of a typical
+// transfer. Both must produce the same signatures.
+#include <Arduino.h>
+#include <cstring>
+#include <sodium/crypto_sign_ed25519.h>
+#include "SolanaSDK/keypair.h"
+#include "SolanaSDK/signing_key.h"
+
+constexpr int ITERATIONS = 500;
+
+uint8_t message[215];
+
+void setup()
+{
+  Serial.begin(115200);
+
+  Keypair keypair = Keypair::generate();
+  SigningKey signingKey(keypair);
+  for (size_t i = 0; i < sizeof(message); ++i)
+  {
+    message[i] = static_cast<uint8_t>(i);
+  }
+
+  uint8_t expected[crypto_sign_ed25519_BYTES];
+  uint8_t actual[crypto_sign_ed25519_BYTES];
+
+  unsigned long start = micros();
+  for (int i = 0; i < ITERATIONS; ++i)
+  {
+    message[0] = static_cast<uint8_t>(i);
+    crypto_sign_ed25519_detached(expected, nullptr, message, sizeof(message), keypair.getSecretKey());
+  }
+  const unsigned long libsodiumMicros = micros() - start;
+
+  start = micros();
+  for (int i = 0; i < ITERATIONS; ++i)
+  {
+    message[0] = static_cast<uint8_t>(i);
+    signingKey.signDetached(actual, message, sizeof(message));
+  }
+  const unsigned long signingKeyMicros = micros() - start;
+
+  // The last message of both loops is the same
+  const bool identical = memcmp(expected, actual, sizeof(actual)) == 0;
+
+  Serial.printf("crypto_sign_ed25519_detached: %.1f us per signature\n", double(libsodiumMicros) / ITERATIONS);
+  Serial.printf("SigningKey: %.1f us per signature\n", double(signingKeyMicros) / ITERATIONS);
+  Serial.printf("Identical signatures: %s\n", identical ? "yes" : "no");
+}
+
+void loop()
+{
+}
@@ -0,0 +1,27 @@
+// Grinds for an address starting with a short prefix on both cores,
+// printing the search rate after every round of attempts
+#include <Arduino.h>
+#include "SolanaSDK/keypair_grinder.h"
+
+constexpr uint64_t ATTEMPTS_PER_ROUND = 2000;
+
+KeypairGrinder grinder("So");
+
+void setup()
+{
+  Serial.begin(115200);
+}
+
+void loop()
+{
+  GrindResult result = grinder.grind(0, ATTEMPTS_PER_ROUND);
+  Serial.printf("%llu keys in %.2f s, %.0f keys/s\n", result.attempts, result.seconds, result.keysPerSecond());
+  if (result.keypair)
+  {
+    Serial.printf("Found %s\n", result.keypair->publicKey.toBase58().c_str());
+    while (true)
+    {
+      delay(1000);
+    }
+  }
+}
@@ -2,24 +2,25 @@
 #include <sstream>
 #include "public_key.h"
 #include "account_meta.h"
+#include "result.h"
 
 // Construct metadata for a writable account.
-AccountMeta *AccountMeta::newWritable(PublicKey publicKey, bool isSigner)
+AccountMeta AccountMeta::newWritable(const PublicKey &publicKey, bool isSigner)
 {
-    AccountMeta *accountMeta = new AccountMeta();
-    accountMeta->publicKey = publicKey;
-    accountMeta->isSigner = isSigner;
-    accountMeta->isWritable = true;
+    AccountMeta accountMeta;
+    accountMeta.publicKey = publicKey;
+    accountMeta.isSigner = isSigner;
+    accountMeta.isWritable = true;
     return accountMeta;
 }
 
 // Construct metadata for a read-only account.
-AccountMeta *AccountMeta::newReadonly(PublicKey publicKey, bool isSigner)
+AccountMeta AccountMeta::newReadonly(const PublicKey &publicKey, bool isSigner)
 {
-    AccountMeta *accountMeta = new AccountMeta();
-    accountMeta->publicKey = publicKey;
-    accountMeta->isSigner = isSigner;
-    accountMeta->isWritable = false;
+    AccountMeta accountMeta;
+    accountMeta.publicKey = publicKey;
+    accountMeta.isSigner = isSigner;
+    accountMeta.isWritable = false;
     return accountMeta;
 }
 
@@ -39,7 +40,7 @@ AccountMeta AccountMeta::deserialize(const std::vector<uint8_t> &input)
 {
     if (input.size() < PUBLIC_KEY_LEN + 2)
     {
-        throw std::runtime_error("Invalid input vector for deserialization");
+        SOLANA_THROW(std::runtime_error("Invalid input vector for deserialization"));
     }
     AccountMeta accountMeta;
     std::vector<uint8_t> publicKeyBytes(input.begin(), input.begin() + PUBLIC_KEY_LEN);
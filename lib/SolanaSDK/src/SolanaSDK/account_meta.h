@@ -16,10 +16,10 @@ public:
   bool isWritable;
 
   // Construct metadata for a writable account.
-  static AccountMeta *newWritable(PublicKey publicKey, bool isSigner);
+  static AccountMeta newWritable(const PublicKey &publicKey, bool isSigner);
 
   // Construct metadata for a read-only account.
-  static AccountMeta *newReadonly(PublicKey publicKey, bool isSigner);
+  static AccountMeta newReadonly(const PublicKey &publicKey, bool isSigner);
 
   std::vector<uint8_t> serialize();
 
@@ -7,20 +7,34 @@
 std::vector<uint8_t> AddressLookupTable::serialize()
 {
   std::vector<uint8_t> serializedData;
+  serializedData.reserve(this->serializedSize());
+  VectorSink sink(serializedData);
+  this->serialize(sink);
+  return serializedData;
+}
 
+void AddressLookupTable::serialize(ByteSink &sink) const
+{
   // Serialize account key
-  std::vector<uint8_t> accountKeyBytes = accountKey.serialize();
-  serializedData.insert(serializedData.end(), accountKeyBytes.begin(), accountKeyBytes.end());
+  sink.write(accountKey.key, PUBLIC_KEY_LEN);
 
   // Serialize writable indexes
-  serializedData.push_back(writableIndexes.size());
-  serializedData.insert(serializedData.end(), writableIndexes.begin(), writableIndexes.end());
+  sink.writeLength(writableIndexes.size());
+  sink.write(writableIndexes.data(), writableIndexes.size());
 
   // Serialize readonly indexes
-  serializedData.push_back(readonlyIndexes.size());
-  serializedData.insert(serializedData.end(), readonlyIndexes.begin(), readonlyIndexes.end());
+  sink.writeLength(readonlyIndexes.size());
+  sink.write(readonlyIndexes.data(), readonlyIndexes.size());
+}
 
-  return serializedData;
+size_t AddressLookupTable::serializedSize() const
+{
+  return PUBLIC_KEY_LEN + shortVecSize(writableIndexes.size(), 1) + shortVecSize(readonlyIndexes.size(), 1);
+}
+
+Result<size_t> AddressLookupTable::serializeInto(Span<uint8_t> out) const
+{
+  return serializeToSpan(*this, out);
 }
 
 AddressLookupTable AddressLookupTable::deserialize(const std::vector<uint8_t> &data)
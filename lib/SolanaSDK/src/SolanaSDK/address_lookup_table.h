@@ -4,6 +4,14 @@
 #include <vector>
 #include <string>
 #include "public_key.h"
+#include "byte_sink.h"
+
+// Contents of an on-chain address lookup table, as loaded from its account
+struct AddressLookupTableAccount
+{
+  PublicKey key;
+  std::vector<PublicKey> addresses;
+};
 
 class AddressLookupTable
 {
@@ -19,6 +27,14 @@ public:
 
   std::vector<uint8_t> serialize();
 
+  void serialize(ByteSink &sink) const;
+
+  // Exact length of the serialized lookup
+  size_t serializedSize() const;
+
+  // Serialize into `out`, returns the number of bytes written
+  Result<size_t> serializeInto(Span<uint8_t> out) const;
+
   static AddressLookupTable deserialize(const std::vector<uint8_t> &data);
 };
 
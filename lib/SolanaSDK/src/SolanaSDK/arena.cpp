@@ -0,0 +1,121 @@
+#include <cstddef>
+#include <cstdint>
+#include <new>
+#include "arena.h"
+#include "result.h"
+
+namespace
+{
+  class HeapResource : public MemoryResource
+  {
+  public:
+    void *allocate(size_t bytes, size_t) override
+    {
+      return ::operator new(bytes);
+    }
+
+    void deallocate(void *p, size_t, size_t) override
+    {
+      ::operator delete(p);
+    }
+  };
+
+  uint8_t *alignUp(uint8_t *p, size_t alignment)
+  {
+    const uintptr_t address = reinterpret_cast<uintptr_t>(p);
+    return p + ((alignment - address % alignment) % alignment);
+  }
+}
+
+MemoryResource *heapResource()
+{
+  static HeapResource resource;
+  return &resource;
+}
+
+Arena::Arena(void *buffer, size_t size, size_t blockSize)
+    : buffer(static_cast<uint8_t *>(buffer)), bufferSize(size), blockSize(blockSize),
+      pos(static_cast<uint8_t *>(buffer)), end(static_cast<uint8_t *>(buffer) + size) {}
+
+Arena::Arena(size_t blockSize) : Arena(nullptr, 0, blockSize) {}
+
+Arena::~Arena()
+{
+  while (this->blocks != nullptr)
+  {
+    Block *next = this->blocks->next;
+    ::operator delete(this->blocks);
+    this->blocks = next;
+  }
+}
+
+void *Arena::allocate(size_t bytes, size_t alignment)
+{
+  uint8_t *p = this->pos == nullptr ? nullptr : alignUp(this->pos, alignment);
+  if (p == nullptr || p > this->end || bytes > static_cast<size_t>(this->end - p))
+  {
+    if (!this->nextBlock(bytes + alignment))
+    {
+      SOLANA_THROW(std::bad_alloc());
+    }
+    p = alignUp(this->pos, alignment);
+  }
+  this->allocated += (p - this->pos) + bytes;
+  this->pos = p + bytes;
+  return p;
+}
+
+bool Arena::nextBlock(size_t bytes)
+{
+  // Blocks kept from before the last reset come first, those too small for
+  // this allocation are skipped until the next reset
+  Block *next = this->current == nullptr ? this->blocks : this->current->next;
+  while (next != nullptr && next->size < bytes)
+  {
+    next = next->next;
+  }
+
+  if (next == nullptr)
+  {
+    // Grow geometrically so a long cycle needs few blocks
+    size_t size = this->blockSize;
+    while (size < bytes)
+    {
+      size *= 2;
+    }
+    this->blockSize = size * 2;
+
+    void *memory = ::operator new(sizeof(Block) + size, std::nothrow);
+    if (memory == nullptr)
+    {
+      return false;
+    }
+    next = static_cast<Block *>(memory);
+    next->size = size;
+
+    // Link it after the current block so it is reused in this order
+    if (this->current == nullptr)
+    {
+      next->next = this->blocks;
+      this->blocks = next;
+    }
+    else
+    {
+      next->next = this->current->next;
+      this->current->next = next;
+    }
+  }
+
+  this->current = next;
+  this->pos = reinterpret_cast<uint8_t *>(next + 1);
+  this->end = this->pos + next->size;
+  return true;
+}
+
+void Arena::reset()
+{
+  this->current = nullptr;
+  this->pos = this->buffer;
+  this->end = this->buffer + this->bufferSize;
+  this->allocated = 0;
+}
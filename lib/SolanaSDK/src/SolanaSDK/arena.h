@@ -0,0 +1,137 @@
+#ifndef ARENA_H
+#define ARENA_H
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+// Source of memory for ArenaAllocator. A minimal stand-in for
+// std::pmr::memory_resource, which the libstdc++ of the ESP32 toolchains we
+// target does not ship.
+class MemoryResource
+{
+public:
+  virtual ~MemoryResource() = default;
+
+  virtual void *allocate(size_t bytes, size_t alignment) = 0;
+
+  virtual void deallocate(void *p, size_t bytes, size_t alignment) = 0;
+};
+
+// Plain operator new and delete, the resource of default constructed
+// allocators
+MemoryResource *heapResource();
+
+// Monotonic allocator: allocations bump a pointer through a caller provided
+// buffer, then through heap blocks of growing size once the buffer is used
+// up. deallocate does nothing and reset releases everything at once. The
+// heap blocks are kept across reset, so a loop that builds, signs and
+// serializes a transaction per iteration and resets the arena in between
+// stops touching the heap after its first iterations.
+//
+// An arena is not synchronized, use one per thread.
+class Arena : public MemoryResource
+{
+public:
+  // Allocate from `buffer` first, e.g. a static or stack array
+  Arena(void *buffer, size_t size, size_t blockSize = 1024);
+
+  // Allocate from heap blocks only
+  explicit Arena(size_t blockSize = 1024);
+
+  ~Arena() override;
+
+  Arena(const Arena &) = delete;
+  Arena &operator=(const Arena &) = delete;
+
+  void *allocate(size_t bytes, size_t alignment) override;
+
+  void deallocate(void *, size_t, size_t) override {}
+
+  // Invalidate everything allocated since the last reset
+  void reset();
+
+  // Bytes handed out since the last reset, alignment padding included.
+  // Size the initial buffer with this to avoid heap blocks altogether.
+  size_t bytesAllocated() const { return allocated; }
+
+private:
+  // Header of a heap block, its memory follows
+  struct Block
+  {
+    Block *next;
+    size_t size;
+  };
+
+  // Move to the next kept block with room for `bytes`, or a new one
+  bool nextBlock(size_t bytes);
+
+  uint8_t *buffer;
+  size_t bufferSize;
+  size_t blockSize;
+
+  // Heap blocks in the order they are used, current is null while
+  // allocating from `buffer`
+  Block *blocks = nullptr;
+  Block *current = nullptr;
+
+  uint8_t *pos;
+  uint8_t *end;
+  size_t allocated = 0;
+};
+
+// Allocator over a MemoryResource, following the semantics of
+// std::pmr::polymorphic_allocator: it converts implicitly from a resource,
+// is not propagated on assignment or swap, and copies of a container fall
+// back to the heap so they never outlive the arena of the original.
+// Containers built with it are moved, not copied, to keep them in the arena.
+template <typename T>
+class ArenaAllocator
+{
+public:
+  using value_type = T;
+
+  ArenaAllocator() : memoryResource(heapResource()) {}
+
+  ArenaAllocator(MemoryResource *resource) : memoryResource(resource) {}
+
+  template <typename U>
+  ArenaAllocator(const ArenaAllocator<U> &other) : memoryResource(other.resource()) {}
+
+  T *allocate(size_t n)
+  {
+    return static_cast<T *>(memoryResource->allocate(n * sizeof(T), alignof(T)));
+  }
+
+  void deallocate(T *p, size_t n)
+  {
+    memoryResource->deallocate(p, n * sizeof(T), alignof(T));
+  }
+
+  ArenaAllocator select_on_container_copy_construction() const
+  {
+    return ArenaAllocator();
+  }
+
+  MemoryResource *resource() const { return memoryResource; }
+
+private:
+  MemoryResource *memoryResource;
+};
+
+template <typename T, typename U>
+bool operator==(const ArenaAllocator<T> &a, const ArenaAllocator<U> &b)
+{
+  return a.resource() == b.resource();
+}
+
+template <typename T, typename U>
+bool operator!=(const ArenaAllocator<T> &a, const ArenaAllocator<U> &b)
+{
+  return a.resource() != b.resource();
+}
+
+template <typename T>
+using ArenaVector = std::vector<T, ArenaAllocator<T>>;
+
+#endif // ARENA_H
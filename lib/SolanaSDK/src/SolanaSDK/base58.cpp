@@ -1,9 +1,337 @@
-#include "Base58.h"
+#include "base58.h"
 #include <Arduino.h>
+#include <array>
+#include <algorithm>
+#include <cstring>
+#include <stdexcept>
 #include <iostream>
 #include <iomanip>
+#include "result.h"
 
-const std::string Base58::ALPHABET = "123456789ABCDEFGHJKLMNPQRSTUVWXYZabcdefghijkmnopqrstuvwxyz";
+namespace
+{
+    constexpr char ALPHABET_CHARS[] = "123456789ABCDEFGHJKLMNPQRSTUVWXYZabcdefghijkmnopqrstuvwxyz";
+
+    // Reverse lookup from an ASCII character to its base58 digit, -1 if the
+    // character is not part of the alphabet
+    constexpr std::array<int8_t, 256> makeReverseAlphabet()
+    {
+        std::array<int8_t, 256> table{};
+        for (size_t i = 0; i < table.size(); ++i)
+        {
+            table[i] = -1;
+        }
+        for (size_t i = 0; i < 58; ++i)
+        {
+            table[static_cast<uint8_t>(ALPHABET_CHARS[i])] = static_cast<int8_t>(i);
+        }
+        return table;
+    }
+
+    constexpr std::array<int8_t, 256> REVERSE_ALPHABET = makeReverseAlphabet();
+
+    // 58^5 is the largest power of 58 that fits a 32-bit limb, so the fixed
+    // width codecs move five base58 digits per limb operation.
+    constexpr uint32_t R1 = 58;
+    constexpr uint32_t R5 = R1 * R1 * R1 * R1 * R1;
+
+    template <size_t N, size_t MAX_LEN>
+    size_t encodeFixed(const uint8_t *bytes, char *out)
+    {
+        constexpr size_t LIMBS = N / 4;
+        constexpr size_t DIGITS = ((MAX_LEN + 4) / 5) * 5;
+
+        uint32_t limbs[LIMBS];
+        for (size_t i = 0; i < LIMBS; ++i)
+        {
+            limbs[i] = (static_cast<uint32_t>(bytes[4 * i]) << 24) |
+                       (static_cast<uint32_t>(bytes[4 * i + 1]) << 16) |
+                       (static_cast<uint32_t>(bytes[4 * i + 2]) << 8) |
+                       static_cast<uint32_t>(bytes[4 * i + 3]);
+        }
+
+        size_t zeros = 0;
+        while (zeros < N && bytes[zeros] == 0)
+        {
+            ++zeros;
+        }
+
+        // Repeatedly divide the big-endian limbs by 58^5, each pass yields the
+        // next five least significant digits
+        uint8_t digits[DIGITS];
+        size_t top = zeros / 4;
+        for (size_t group = DIGITS / 5; group-- > 0;)
+        {
+            uint64_t rem = 0;
+            for (size_t i = top; i < LIMBS; ++i)
+            {
+                uint64_t cur = (rem << 32) | limbs[i];
+                limbs[i] = static_cast<uint32_t>(cur / R5);
+                rem = cur % R5;
+            }
+            while (top < LIMBS && limbs[top] == 0)
+            {
+                ++top;
+            }
+
+            uint32_t r = static_cast<uint32_t>(rem);
+            for (size_t k = 5; k-- > 0;)
+            {
+                digits[group * 5 + k] = static_cast<uint8_t>(r % R1);
+                r /= R1;
+            }
+        }
+
+        size_t first = 0;
+        while (first < DIGITS && digits[first] == 0)
+        {
+            ++first;
+        }
+
+        size_t len = 0;
+        for (size_t i = 0; i < zeros; ++i)
+        {
+            out[len++] = '1';
+        }
+        for (size_t i = first; i < DIGITS; ++i)
+        {
+            out[len++] = ALPHABET_CHARS[digits[i]];
+        }
+        out[len] = '\0';
+        return len;
+    }
+
+    // Row g holds the 32-bit big-endian limbs of 58^(5 * (GROUPS - 1 - g)),
+    // the weight of the g-th five digit group of a right aligned string
+    template <size_t N, size_t GROUPS>
+    constexpr std::array<std::array<uint32_t, N / 4>, GROUPS> makeDecodeTable()
+    {
+        std::array<std::array<uint32_t, N / 4>, GROUPS> table{};
+        std::array<uint32_t, N / 4> power{};
+        power[N / 4 - 1] = 1;
+        for (size_t group = GROUPS; group-- > 0;)
+        {
+            table[group] = power;
+            uint64_t carry = 0;
+            for (size_t i = N / 4; i-- > 0;)
+            {
+                uint64_t cur = static_cast<uint64_t>(power[i]) * R5 + carry;
+                power[i] = static_cast<uint32_t>(cur);
+                carry = cur >> 32;
+            }
+        }
+        return table;
+    }
+
+    constexpr size_t DECODE_32_GROUPS = (BASE58_ENCODED_32_MAX_LEN + 4) / 5;
+    constexpr size_t DECODE_64_GROUPS = (BASE58_ENCODED_64_MAX_LEN + 4) / 5;
+
+    constexpr auto DECODE_TABLE_32 = makeDecodeTable<32, DECODE_32_GROUPS>();
+    constexpr auto DECODE_TABLE_64 = makeDecodeTable<64, DECODE_64_GROUPS>();
+
+    template <size_t N>
+    constexpr const std::array<std::array<uint32_t, N / 4>, (N == 32 ? DECODE_32_GROUPS : DECODE_64_GROUPS)> &decodeTable()
+    {
+        if constexpr (N == 32)
+        {
+            return DECODE_TABLE_32;
+        }
+        else
+        {
+            return DECODE_TABLE_64;
+        }
+    }
+
+    template <size_t N, size_t MAX_LEN>
+    Base58Status decodeFixed(const char *str, size_t len, uint8_t *out)
+    {
+        constexpr size_t LIMBS = N / 4;
+        constexpr size_t GROUPS = (MAX_LEN + 4) / 5;
+        constexpr size_t DIGITS = GROUPS * 5;
+        const auto &table = decodeTable<N>();
+
+        if (len == 0 || len > MAX_LEN)
+        {
+            return Base58Status::InvalidLength;
+        }
+
+        size_t ones = 0;
+        while (ones < len && str[ones] == '1')
+        {
+            ++ones;
+        }
+        if (ones > N)
+        {
+            return Base58Status::InvalidLength;
+        }
+
+        // Pack the right aligned digits into base 58^5 groups
+        uint32_t groups[GROUPS] = {0};
+        size_t pad = DIGITS - len;
+        for (size_t i = 0; i < len; ++i)
+        {
+            int8_t digit = REVERSE_ALPHABET[static_cast<uint8_t>(str[i])];
+            if (digit < 0)
+            {
+                return Base58Status::InvalidCharacter;
+            }
+            uint32_t &group = groups[(pad + i) / 5];
+            group = group * R1 + static_cast<uint32_t>(digit);
+        }
+
+        // Every group adds an independent product to each limb, carries are
+        // only propagated once at the end. The table is chosen so that the
+        // 64-bit accumulators cannot overflow.
+        uint64_t acc[LIMBS] = {0};
+        for (size_t group = 0; group < GROUPS; ++group)
+        {
+            for (size_t i = 0; i < LIMBS; ++i)
+            {
+                acc[i] += static_cast<uint64_t>(groups[group]) * table[group][i];
+            }
+        }
+
+        uint64_t carry = 0;
+        for (size_t i = LIMBS; i-- > 0;)
+        {
+            acc[i] += carry;
+            carry = acc[i] >> 32;
+            acc[i] &= 0xffffffff;
+        }
+        if (carry != 0)
+        {
+            // Value does not fit in N bytes
+            return Base58Status::InvalidLength;
+        }
+
+        for (size_t i = 0; i < LIMBS; ++i)
+        {
+            out[4 * i] = static_cast<uint8_t>(acc[i] >> 24);
+            out[4 * i + 1] = static_cast<uint8_t>(acc[i] >> 16);
+            out[4 * i + 2] = static_cast<uint8_t>(acc[i] >> 8);
+            out[4 * i + 3] = static_cast<uint8_t>(acc[i]);
+        }
+
+        // Canonical encodings carry exactly one leading '1' per leading zero byte
+        size_t zeros = 0;
+        while (zeros < N && out[zeros] == 0)
+        {
+            ++zeros;
+        }
+        return zeros == ones ? Base58Status::Ok : Base58Status::InvalidLength;
+    }
+
+    constexpr size_t BATCH_LANES = 4;
+
+    // Decodes BATCH_LANES 32 byte values at once with the same table driven
+    // conversion as decodeFixed, interleaving the lanes in the innermost loop
+    // so their multiply/accumulate chains overlap. Returns a bit mask of the
+    // lanes that decoded to a canonical value.
+    uint32_t decode32Lanes(const char *const *strs, const size_t *lens, size_t lanes, uint8_t *out)
+    {
+        constexpr size_t LIMBS = 8;
+        constexpr size_t GROUPS = DECODE_32_GROUPS;
+
+        constexpr size_t DIGITS = GROUPS * 5;
+
+        // Right align every lane in a buffer padded with '1', the zero digit,
+        // so all lanes share the same group boundaries
+        char padded[BATCH_LANES][DIGITS];
+        uint32_t invalid[BATCH_LANES] = {};
+        size_t ones[BATCH_LANES] = {};
+        for (size_t lane = 0; lane < BATCH_LANES; ++lane)
+        {
+            size_t len = lane < lanes ? lens[lane] : 0;
+            if (len == 0 || len > BASE58_ENCODED_32_MAX_LEN)
+            {
+                invalid[lane] = 1;
+                len = 0;
+            }
+            std::fill(padded[lane], padded[lane] + DIGITS - len, '1');
+            if (len > 0)
+            {
+                std::memcpy(padded[lane] + DIGITS - len, strs[lane], len);
+            }
+            while (ones[lane] < len && strs[lane][ones[lane]] == '1')
+            {
+                ++ones[lane];
+            }
+        }
+
+        uint32_t groups[GROUPS][BATCH_LANES];
+        for (size_t group = 0; group < GROUPS; ++group)
+        {
+            for (size_t lane = 0; lane < BATCH_LANES; ++lane)
+            {
+                const char *c = padded[lane] + group * 5;
+                uint8_t d0 = static_cast<uint8_t>(REVERSE_ALPHABET[static_cast<uint8_t>(c[0])]);
+                uint8_t d1 = static_cast<uint8_t>(REVERSE_ALPHABET[static_cast<uint8_t>(c[1])]);
+                uint8_t d2 = static_cast<uint8_t>(REVERSE_ALPHABET[static_cast<uint8_t>(c[2])]);
+                uint8_t d3 = static_cast<uint8_t>(REVERSE_ALPHABET[static_cast<uint8_t>(c[3])]);
+                uint8_t d4 = static_cast<uint8_t>(REVERSE_ALPHABET[static_cast<uint8_t>(c[4])]);
+                // Invalid characters map to -1, which sets the top bit
+                invalid[lane] |= (d0 | d1 | d2 | d3 | d4) >> 7;
+                groups[group][lane] = (((static_cast<uint32_t>(d0 & 0x3f) * R1 + (d1 & 0x3f)) * R1 + (d2 & 0x3f)) * R1 + (d3 & 0x3f)) * R1 + (d4 & 0x3f);
+            }
+        }
+
+        uint64_t acc[LIMBS][BATCH_LANES] = {};
+        for (size_t group = 0; group < GROUPS; ++group)
+        {
+            for (size_t i = 0; i < LIMBS; ++i)
+            {
+                uint64_t weight = DECODE_TABLE_32[group][i];
+                for (size_t lane = 0; lane < BATCH_LANES; ++lane)
+                {
+                    acc[i][lane] += groups[group][lane] * weight;
+                }
+            }
+        }
+
+        uint64_t carry[BATCH_LANES] = {};
+        for (size_t i = LIMBS; i-- > 0;)
+        {
+            for (size_t lane = 0; lane < BATCH_LANES; ++lane)
+            {
+                acc[i][lane] += carry[lane];
+                carry[lane] = acc[i][lane] >> 32;
+            }
+        }
+
+        uint32_t valid = 0;
+        for (size_t lane = 0; lane < lanes; ++lane)
+        {
+            uint8_t *bytes = out + lane * 32;
+            for (size_t i = 0; i < LIMBS; ++i)
+            {
+                bytes[4 * i] = static_cast<uint8_t>(acc[i][lane] >> 24);
+                bytes[4 * i + 1] = static_cast<uint8_t>(acc[i][lane] >> 16);
+                bytes[4 * i + 2] = static_cast<uint8_t>(acc[i][lane] >> 8);
+                bytes[4 * i + 3] = static_cast<uint8_t>(acc[i][lane]);
+            }
+
+            size_t zeros = 0;
+            while (zeros < 32 && bytes[zeros] == 0)
+            {
+                ++zeros;
+            }
+            if (invalid[lane] || carry[lane] != 0 || zeros != ones[lane])
+            {
+                std::fill(bytes, bytes + 32, 0);
+                continue;
+            }
+            valid |= 1u << lane;
+        }
+        return valid;
+    }
+}
+
+const std::string Base58::ALPHABET = ALPHABET_CHARS;
+
+void invalidBase58Literal()
+{
+    SOLANA_THROW(std::invalid_argument("Invalid base58 literal"));
+}
 
 Base58::Base58() {}
 
@@ -44,7 +372,11 @@ std::vector<uint8_t> Base58::decode(const std::string &addr)
     int c, tmp;
     for (const auto &a : addr)
     {
-        c = ALPHABET.find(a);
+        c = REVERSE_ALPHABET[static_cast<uint8_t>(a)];
+        if (c < 0)
+        {
+            SOLANA_THROW(std::invalid_argument("Invalid base58 character"));
+        }
         for (int j = buf.size() - 1; j >= 0; --j)
         {
             tmp = buf[j] * 58 + c;
@@ -57,20 +389,206 @@ std::vector<uint8_t> Base58::decode(const std::string &addr)
 
 std::string Base58::trimEncode(const std::vector<uint8_t> &input)
 {
-    std::string encoded = encode(input);
-    size_t first = encoded.find_first_not_of('1');
-    if (std::string::npos == first)
+    // Leading zero bytes are dropped instead of being encoded as '1's
+    auto first = std::find_if(input.begin(), input.end(), [](uint8_t i)
+                              { return i != 0; });
+    size_t skip = std::distance(input.begin(), first);
+    size_t len = input.size() - skip;
+
+    // log(256) / log(58) < 1.38, plus one digit of rounding and the terminator
+    std::string encoded(len * 138 / 100 + 2, '\0');
+    size_t encodedLen = 0;
+    encode(input.data() + skip, len, Span<char>(&encoded[0], encoded.size()), encodedLen);
+    encoded.resize(encodedLen);
+    return encoded;
+}
+
+std::vector<uint8_t> Base58::trimDecode(const std::string &addr)
+{
+    // Leading '1's are dropped instead of being decoded as zero bytes
+    size_t skip = std::min(addr.find_first_not_of('1'), addr.size());
+    size_t len = addr.size() - skip;
+
+    // log(58) / log(256) < 0.733, plus one byte of rounding
+    std::vector<uint8_t> decoded(len * 733 / 1000 + 1);
+    size_t decodedLen = 0;
+    if (decode(addr.data() + skip, len, Span<uint8_t>(decoded), decodedLen) != Base58Status::Ok)
     {
-        return "";
+        SOLANA_THROW(std::invalid_argument("Invalid base58 string"));
     }
-    size_t last = encoded.find_last_not_of('1');
-    return encoded.substr(first, (last - first + 1));
+    decoded.resize(decodedLen);
+    return decoded;
 }
 
-std::vector<uint8_t> Base58::trimDecode(const std::string &addr)
+size_t Base58::encode32(const uint8_t bytes[32], char out[BASE58_ENCODED_32_MAX_LEN + 1])
 {
-    std::vector<uint8_t> decoded = decode(addr);
-    auto start = std::find_if(decoded.begin(), decoded.end(), [](int i)
-                              { return i != 0; });
-    return std::vector<uint8_t>(start, decoded.end());
+    return encodeFixed<32, BASE58_ENCODED_32_MAX_LEN>(bytes, out);
+}
+
+size_t Base58::encode64(const uint8_t bytes[64], char out[BASE58_ENCODED_64_MAX_LEN + 1])
+{
+    return encodeFixed<64, BASE58_ENCODED_64_MAX_LEN>(bytes, out);
+}
+
+std::string Base58::encode32(const uint8_t bytes[32])
+{
+    char out[BASE58_ENCODED_32_MAX_LEN + 1];
+    size_t len = encode32(bytes, out);
+    return std::string(out, len);
+}
+
+std::string Base58::encode64(const uint8_t bytes[64])
+{
+    char out[BASE58_ENCODED_64_MAX_LEN + 1];
+    size_t len = encode64(bytes, out);
+    return std::string(out, len);
+}
+
+bool Base58::decode32(const char *str, size_t len, uint8_t out[32])
+{
+    return decodeFixed<32, BASE58_ENCODED_32_MAX_LEN>(str, len, out) == Base58Status::Ok;
+}
+
+bool Base58::decode64(const char *str, size_t len, uint8_t out[64])
+{
+    return decodeFixed<64, BASE58_ENCODED_64_MAX_LEN>(str, len, out) == Base58Status::Ok;
+}
+
+size_t Base58::decode32Batch(const char *const *strs, const size_t *lens, size_t count, uint8_t *out, uint8_t *validBitmap)
+{
+    std::fill(validBitmap, validBitmap + (count + 7) / 8, 0);
+
+    size_t validCount = 0;
+    for (size_t i = 0; i < count; i += BATCH_LANES)
+    {
+        size_t lanes = std::min(BATCH_LANES, count - i);
+        uint32_t valid = decode32Lanes(strs + i, lens + i, lanes, out + i * 32);
+        for (size_t lane = 0; lane < lanes; ++lane)
+        {
+            if (valid & (1u << lane))
+            {
+                validBitmap[(i + lane) / 8] |= static_cast<uint8_t>(1u << ((i + lane) % 8));
+                ++validCount;
+            }
+        }
+    }
+    return validCount;
+}
+
+Base58Status Base58::encode(const uint8_t *input, size_t len, Span<char> out, size_t &outLen)
+{
+    outLen = 0;
+
+    size_t zeros = 0;
+    while (zeros < len && input[zeros] == 0)
+    {
+        ++zeros;
+    }
+    if (out.size() < zeros + 1)
+    {
+        return Base58Status::BufferTooSmall;
+    }
+
+    // Accumulate digits right aligned in the space left after the leading
+    // '1's and the terminator, so no scratch buffer is needed
+    char *digits = out.data() + zeros;
+    size_t capacity = out.size() - zeros - 1;
+    size_t used = 0;
+    for (size_t i = zeros; i < len; ++i)
+    {
+        uint32_t carry = input[i];
+        size_t j = 0;
+        for (; j < used || carry != 0; ++j)
+        {
+            if (j == capacity)
+            {
+                return Base58Status::BufferTooSmall;
+            }
+            char &digit = digits[capacity - 1 - j];
+            uint32_t cur = (j < used ? static_cast<uint32_t>(digit) : 0) * 256 + carry;
+            digit = static_cast<char>(cur % 58);
+            carry = cur / 58;
+        }
+        used = j;
+    }
+
+    std::memmove(digits, digits + capacity - used, used);
+    for (size_t i = 0; i < used; ++i)
+    {
+        digits[i] = ALPHABET_CHARS[static_cast<uint8_t>(digits[i])];
+    }
+    std::fill(out.data(), digits, '1');
+
+    outLen = zeros + used;
+    out[outLen] = '\0';
+    return Base58Status::Ok;
+}
+
+Base58Status Base58::decode(const char *str, size_t len, Span<uint8_t> out, size_t &outLen)
+{
+    outLen = 0;
+
+    size_t ones = 0;
+    while (ones < len && str[ones] == '1')
+    {
+        ++ones;
+    }
+    if (out.size() < ones)
+    {
+        return Base58Status::BufferTooSmall;
+    }
+
+    // Accumulate bytes right aligned in the space left after the leading
+    // zero bytes, so no scratch buffer is needed
+    uint8_t *bytes = out.data() + ones;
+    size_t capacity = out.size() - ones;
+    size_t used = 0;
+    for (size_t i = ones; i < len; ++i)
+    {
+        int8_t digit = REVERSE_ALPHABET[static_cast<uint8_t>(str[i])];
+        if (digit < 0)
+        {
+            return Base58Status::InvalidCharacter;
+        }
+        uint32_t carry = static_cast<uint32_t>(digit);
+        size_t j = 0;
+        for (; j < used || carry != 0; ++j)
+        {
+            if (j == capacity)
+            {
+                return Base58Status::BufferTooSmall;
+            }
+            uint8_t &byte = bytes[capacity - 1 - j];
+            uint32_t cur = (j < used ? static_cast<uint32_t>(byte) : 0) * 58 + carry;
+            byte = static_cast<uint8_t>(cur);
+            carry = cur >> 8;
+        }
+        used = j;
+    }
+
+    std::memmove(bytes, bytes + capacity - used, used);
+    std::fill(out.data(), bytes, 0);
+
+    outLen = ones + used;
+    return Base58Status::Ok;
+}
+
+Base58Status Base58::decodeExact(const char *str, size_t len, uint8_t *out, size_t n)
+{
+    if (n == 32)
+    {
+        return decodeFixed<32, BASE58_ENCODED_32_MAX_LEN>(str, len, out);
+    }
+    if (n == 64)
+    {
+        return decodeFixed<64, BASE58_ENCODED_64_MAX_LEN>(str, len, out);
+    }
+
+    size_t outLen = 0;
+    Base58Status status = decode(str, len, Span<uint8_t>(out, n), outLen);
+    if (status == Base58Status::BufferTooSmall || (status == Base58Status::Ok && outLen != n))
+    {
+        return Base58Status::InvalidLength;
+    }
+    return status;
 }
@@ -1,8 +1,33 @@
 #ifndef BASE58_H
 #define BASE58_H
 
+#include <cstdint>
+#include <cstddef>
+#include <array>
 #include <vector>
 #include <string>
+#include "span.h"
+
+// Maximum string length of a base58 encoded 32 byte value (public keys, hashes)
+constexpr size_t BASE58_ENCODED_32_MAX_LEN = 44;
+
+// Maximum string length of a base58 encoded 64 byte value (signatures)
+constexpr size_t BASE58_ENCODED_64_MAX_LEN = 88;
+
+enum class Base58Status
+{
+  Ok,
+  // The output buffer cannot hold the encoded or decoded value
+  BufferTooSmall,
+  // The input contains a character outside of the base58 alphabet
+  InvalidCharacter,
+  // The decoded value does not have the expected number of bytes
+  InvalidLength,
+};
+
+// Not constexpr on purpose: reaching it during constant evaluation turns an
+// invalid base58 literal into a compile error
+void invalidBase58Literal();
 
 class Base58
 {
@@ -14,8 +39,103 @@ public:
   static std::string trimEncode(const std::vector<uint8_t> &input);
   static std::vector<uint8_t> trimDecode(const std::string &addr);
 
+  // Fixed width encoders for 32 and 64 byte values. They write a NUL
+  // terminated string into `out` and return its length.
+  static size_t encode32(const uint8_t bytes[32], char out[BASE58_ENCODED_32_MAX_LEN + 1]);
+  static size_t encode64(const uint8_t bytes[64], char out[BASE58_ENCODED_64_MAX_LEN + 1]);
+  static std::string encode32(const uint8_t bytes[32]);
+  static std::string encode64(const uint8_t bytes[64]);
+
+  // Fixed width decoders for 32 and 64 byte values. They return false if
+  // `str` is not the canonical encoding of exactly 32 or 64 bytes.
+  static bool decode32(const char *str, size_t len, uint8_t out[32]);
+  static bool decode64(const char *str, size_t len, uint8_t out[64]);
+
+  // Decode `count` strings of 32 byte values into `out`, which holds
+  // count * 32 bytes. Strings are decoded several at a time in lock step so
+  // their multiply/carry chains overlap. Bit i of `validBitmap`, which holds
+  // (count + 7) / 8 bytes, is set when strs[i] is a canonical encoding;
+  // invalid entries are zeroed. Returns the number of valid entries.
+  static size_t decode32Batch(const char *const *strs, const size_t *lens, size_t count, uint8_t *out, uint8_t *validBitmap);
+
+  // Encode `len` bytes into `out` as a NUL terminated string, the encoded
+  // length (without the terminator) is written to `outLen`. Leading zero
+  // bytes are encoded as leading '1's.
+  static Base58Status encode(const uint8_t *input, size_t len, Span<char> out, size_t &outLen);
+
+  // Decode `len` characters into `out`, the decoded length is written to
+  // `outLen`. Leading '1's are decoded as leading zero bytes.
+  static Base58Status decode(const char *str, size_t len, Span<uint8_t> out, size_t &outLen);
+
+  // Decode the canonical base58 literal of a 32 byte value at compile time
+  template <size_t N>
+  static constexpr std::array<uint8_t, 32> decode32Literal(const char (&str)[N])
+  {
+    std::array<uint8_t, 32> bytes{};
+    constexpr size_t len = N - 1;
+    if (len == 0 || len > BASE58_ENCODED_32_MAX_LEN)
+    {
+      invalidBase58Literal();
+    }
+
+    size_t ones = 0;
+    while (ones < len && str[ones] == '1')
+    {
+      ++ones;
+    }
+
+    for (size_t i = 0; i < len; ++i)
+    {
+      uint32_t carry = literalDigit(str[i]);
+      for (size_t j = bytes.size(); j-- > 0;)
+      {
+        uint32_t cur = bytes[j] * 58u + carry;
+        bytes[j] = static_cast<uint8_t>(cur);
+        carry = cur >> 8;
+      }
+      if (carry != 0)
+      {
+        invalidBase58Literal();
+      }
+    }
+
+    size_t zeros = 0;
+    while (zeros < bytes.size() && bytes[zeros] == 0)
+    {
+      ++zeros;
+    }
+    if (zeros != ones)
+    {
+      invalidBase58Literal();
+    }
+    return bytes;
+  }
+
+  // Decode into a value of exactly N bytes
+  template <size_t N>
+  static Base58Status decode(const char *str, size_t len, std::array<uint8_t, N> &out)
+  {
+    return decodeExact(str, len, out.data(), N);
+  }
+
 private:
   static const std::string ALPHABET;
+
+  static constexpr uint32_t literalDigit(char c)
+  {
+    constexpr char alphabet[] = "123456789ABCDEFGHJKLMNPQRSTUVWXYZabcdefghijkmnopqrstuvwxyz";
+    for (uint32_t i = 0; i < 58; ++i)
+    {
+      if (alphabet[i] == c)
+      {
+        return i;
+      }
+    }
+    invalidBase58Literal();
+    return 0;
+  }
+
+  static Base58Status decodeExact(const char *str, size_t len, uint8_t *out, size_t n);
 };
 
 #endif // BASE58_H
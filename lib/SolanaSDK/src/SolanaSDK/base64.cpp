@@ -0,0 +1,100 @@
+#include <cstdint>
+#include <cstddef>
+#include <vector>
+#include <string>
+#include "base64.h"
+
+#if (defined(__x86_64__) || defined(__i386__)) && (defined(__GNUC__) || defined(__clang__))
+#define BASE64_SSSE3
+#include <tmmintrin.h>
+#endif
+
+namespace
+{
+  constexpr char ALPHABET[] = "ABCDEFGHIJKLMNOPQRSTUVWXYZabcdefghijklmnopqrstuvwxyz0123456789+/";
+
+  size_t encodeScalar(const uint8_t *input, size_t len, char *out)
+  {
+    char *start = out;
+    size_t i = 0;
+    for (; i + 3 <= len; i += 3)
+    {
+      uint32_t triple = (static_cast<uint32_t>(input[i]) << 16) |
+                        (static_cast<uint32_t>(input[i + 1]) << 8) |
+                        static_cast<uint32_t>(input[i + 2]);
+      *out++ = ALPHABET[(triple >> 18) & 0x3f];
+      *out++ = ALPHABET[(triple >> 12) & 0x3f];
+      *out++ = ALPHABET[(triple >> 6) & 0x3f];
+      *out++ = ALPHABET[triple & 0x3f];
+    }
+
+    size_t rest = len - i;
+    if (rest > 0)
+    {
+      uint32_t triple = static_cast<uint32_t>(input[i]) << 16;
+      if (rest == 2)
+      {
+        triple |= static_cast<uint32_t>(input[i + 1]) << 8;
+      }
+      *out++ = ALPHABET[(triple >> 18) & 0x3f];
+      *out++ = ALPHABET[(triple >> 12) & 0x3f];
+      *out++ = rest == 2 ? ALPHABET[(triple >> 6) & 0x3f] : '=';
+      *out++ = '=';
+    }
+    return out - start;
+  }
+
+#ifdef BASE64_SSSE3
+  // Encodes 12 input bytes into 16 characters per iteration: a byte shuffle
+  // spreads each 3 byte group over 4 lanes, multiplies shift the 6-bit
+  // indexes into place and a pshufb lookup maps index ranges to ASCII.
+  __attribute__((target("ssse3"))) size_t encodeSsse3(const uint8_t *input, size_t len, char *out)
+  {
+    const __m128i shuffle = _mm_set_epi8(10, 11, 9, 10, 7, 8, 6, 7, 4, 5, 3, 4, 1, 2, 0, 1);
+    const __m128i shiftLut = _mm_setr_epi8('a' - 26, '0' - 52, '0' - 52, '0' - 52, '0' - 52, '0' - 52,
+                                           '0' - 52, '0' - 52, '0' - 52, '0' - 52, '0' - 52, '+' - 62,
+                                           '/' - 63, 'A', 0, 0);
+    size_t i = 0;
+    size_t written = 0;
+    // Every load reads 16 bytes, of which 12 are consumed
+    for (; i + 16 <= len; i += 12, written += 16)
+    {
+      __m128i in = _mm_loadu_si128(reinterpret_cast<const __m128i *>(input + i));
+      in = _mm_shuffle_epi8(in, shuffle);
+
+      const __m128i t0 = _mm_and_si128(in, _mm_set1_epi32(0x0fc0fc00));
+      const __m128i t1 = _mm_mulhi_epu16(t0, _mm_set1_epi32(0x04000040));
+      const __m128i t2 = _mm_and_si128(in, _mm_set1_epi32(0x003f03f0));
+      const __m128i t3 = _mm_mullo_epi16(t2, _mm_set1_epi32(0x01000010));
+      const __m128i indices = _mm_or_si128(t1, t3);
+
+      __m128i offsets = _mm_subs_epu8(indices, _mm_set1_epi8(51));
+      const __m128i lessThan26 = _mm_cmpgt_epi8(_mm_set1_epi8(26), indices);
+      offsets = _mm_or_si128(offsets, _mm_and_si128(lessThan26, _mm_set1_epi8(13)));
+      const __m128i result = _mm_add_epi8(_mm_shuffle_epi8(shiftLut, offsets), indices);
+
+      _mm_storeu_si128(reinterpret_cast<__m128i *>(out + written), result);
+    }
+    return written + encodeScalar(input + i, len - i, out + written);
+  }
+#endif
+}
+
+size_t Base64::encode(const uint8_t *input, size_t len, char *out)
+{
+#ifdef BASE64_SSSE3
+  static const bool hasSsse3 = __builtin_cpu_supports("ssse3");
+  if (hasSsse3)
+  {
+    return encodeSsse3(input, len, out);
+  }
+#endif
+  return encodeScalar(input, len, out);
+}
+
+std::string Base64::encode(const std::vector<uint8_t> &input)
+{
+  std::string encoded(encodedLen(input.size()), '\0');
+  encode(input.data(), input.size(), &encoded[0]);
+  return encoded;
+}
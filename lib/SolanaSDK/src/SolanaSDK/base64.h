@@ -0,0 +1,26 @@
+#ifndef BASE64_H
+#define BASE64_H
+
+#include <cstdint>
+#include <cstddef>
+#include <vector>
+#include <string>
+
+class Base64
+{
+public:
+  // Length of the padded base64 encoding of `len` bytes
+  static constexpr size_t encodedLen(size_t len)
+  {
+    return (len + 2) / 3 * 4;
+  }
+
+  // Encode `len` bytes into `out`, which must hold at least encodedLen(len)
+  // characters. The output is not NUL terminated, returns the number of
+  // characters written.
+  static size_t encode(const uint8_t *input, size_t len, char *out);
+
+  static std::string encode(const std::vector<uint8_t> &input);
+};
+
+#endif // BASE64_H
@@ -0,0 +1,121 @@
+#ifndef BYTE_SINK_H
+#define BYTE_SINK_H
+
+#include <cstdint>
+#include <cstddef>
+#include <cstring>
+#include <memory>
+#include <vector>
+#include "span.h"
+#include "short_vec.h"
+#include "result.h"
+
+// Destination for serialized bytes. Serializers write through a sink so the
+// same code can fill a buffer, feed a hash, or both in a single pass.
+class ByteSink
+{
+public:
+  virtual ~ByteSink() = default;
+
+  virtual void write(const uint8_t *data, size_t len) = 0;
+
+  void write(uint8_t byte)
+  {
+    write(&byte, 1);
+  }
+
+  // Compact-u16 length prefix, lengths past 0xffff cannot be encoded and
+  // are rejected by sanitize before they get here
+  void writeLength(size_t len)
+  {
+    uint8_t encoded[ShortVec::MAX_ENCODED_LEN];
+    write(encoded, ShortVec::encode(static_cast<uint16_t>(len), encoded));
+  }
+};
+
+// Appends to a vector, of any allocator
+template <typename Allocator = std::allocator<uint8_t>>
+class VectorSink : public ByteSink
+{
+public:
+  explicit VectorSink(std::vector<uint8_t, Allocator> &out) : out(out) {}
+
+  void write(const uint8_t *data, size_t len) override
+  {
+    out.insert(out.end(), data, data + len);
+  }
+
+  using ByteSink::write;
+
+private:
+  std::vector<uint8_t, Allocator> &out;
+};
+
+// Fills a caller provided buffer. Writes past its end are dropped, callers
+// size the buffer with serializedSize() first.
+class SpanSink : public ByteSink
+{
+public:
+  explicit SpanSink(Span<uint8_t> out) : out(out), pos(0) {}
+
+  void write(const uint8_t *data, size_t len) override
+  {
+    if (len > out.size() - pos)
+    {
+      len = out.size() - pos;
+    }
+    memcpy(out.data() + pos, data, len);
+    pos += len;
+  }
+
+  using ByteSink::write;
+
+  // Number of bytes written so far
+  size_t size() const { return pos; }
+
+private:
+  Span<uint8_t> out;
+  size_t pos;
+};
+
+// Forwards every write to two sinks
+class TeeSink : public ByteSink
+{
+public:
+  TeeSink(ByteSink &first, ByteSink &second) : first(first), second(second) {}
+
+  void write(const uint8_t *data, size_t len) override
+  {
+    first.write(data, len);
+    second.write(data, len);
+  }
+
+  using ByteSink::write;
+
+private:
+  ByteSink &first;
+  ByteSink &second;
+};
+
+// Serialize `value`, which has serializedSize() and serialize(ByteSink &),
+// into `out`. Returns the number of bytes written.
+template <typename T>
+Result<size_t> serializeToSpan(const T &value, Span<uint8_t> out)
+{
+  const size_t size = value.serializedSize();
+  if (size > out.size())
+  {
+    return Error("Buffer too small");
+  }
+  SpanSink sink(out);
+  value.serialize(sink);
+  return size;
+}
+
+// Length of `len` items behind a compact-u16 prefix
+inline size_t shortVecSize(size_t len, size_t itemLen)
+{
+  return ShortVec::encodedLen(static_cast<uint16_t>(len)) + len * itemLen;
+}
+
+#endif // BYTE_SINK_H
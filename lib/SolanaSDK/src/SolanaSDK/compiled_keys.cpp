@@ -1,98 +1,237 @@
-#include <map>
+#include <algorithm>
 #include <vector>
 #include <optional>
 #include <stdexcept>
 #include <variant>
+#include <utility>
 #include "public_key.h"
 #include "instruction.h"
 #include "message.h"
 #include "compiled_keys.h"
+#include "result.h"
+
+CompiledKeys::CompiledKeys(const std::optional<PublicKey> &payer, MemoryResource *resource)
+    : payer(payer), keyIndex(resource) {}
 
 // Compiles the public keys referenced by a list of instructions and organizes
 // by signer/non-signer and writable/readonly
-CompiledKeys CompiledKeys::compile(std::vector<Instruction> &instructions, std::optional<PublicKey> &payer)
+CompiledKeys CompiledKeys::compile(const std::vector<Instruction> &instructions, const std::optional<PublicKey> &payer, MemoryResource *resource)
 {
-  std::map<PublicKey, CompiledKeyMeta> keyMetaMap;
+  CompiledKeys compiled(payer, resource);
 
+  size_t maxKeys = 1;
   for (const Instruction &ix : instructions)
   {
-    CompiledKeyMeta &meta = keyMetaMap[ix.programId];
-    meta.isInvoked = true;
+    maxKeys += 1 + ix.accounts.size();
+  }
+  compiled.keyIndex.reserve(maxKeys);
+
+  if (payer.has_value())
+  {
+    CompiledKeyMeta &meta = compiled.keyIndex.insert(*payer).meta;
+    meta.isSigner = true;
+    meta.isWritable = true;
+  }
+
+  for (const Instruction &ix : instructions)
+  {
+    compiled.keyIndex.insert(ix.programId).meta.isInvoked = true;
 
     for (const AccountMeta &accountMeta : ix.accounts)
     {
-      CompiledKeyMeta &meta = keyMetaMap[accountMeta.publicKey];
+      CompiledKeyMeta &meta = compiled.keyIndex.insert(accountMeta.publicKey).meta;
       meta.isSigner |= accountMeta.isSigner;
       meta.isWritable |= accountMeta.isWritable;
     }
   }
-  if (payer.has_value())
-  {
-    CompiledKeyMeta &meta = keyMetaMap[*payer];
-    meta.isSigner = true;
-    meta.isWritable = true;
-  }
 
-  return CompiledKeys{
-      payer,
-      keyMetaMap};
+  return compiled;
 }
 
-std::pair<MessageHeader, std::vector<PublicKey>> CompiledKeys::tryIntoMessageComponents()
+// A lookup costs its table key, two length prefixes and one index per key,
+// so it only saves space once it replaces two or more 32-byte keys
+constexpr size_t MIN_KEYS_PER_LOOKUP = 2;
+
+// Lookup tables index at most this many addresses
+constexpr size_t MAX_LOOKUP_TABLE_ADDRESSES = 256;
+
+// No table or entry
+constexpr size_t NONE = static_cast<size_t>(-1);
+
+std::vector<AddressLookupTable> CompiledKeys::extractTableLookups(const std::vector<AddressLookupTableAccount> &tables, std::vector<PublicKey> &loadedWritable, std::vector<PublicKey> &loadedReadonly)
 {
-  if (payer.has_value())
+  ArenaVector<KeyIndex::Entry> &entries = this->keyIndex.entries();
+
+  // Keys of each table that may be loaded from it, as an entry and the
+  // first address index of its key
+  std::vector<std::vector<std::pair<size_t, uint8_t>>> candidates(tables.size());
+  std::vector<size_t> lastTable(entries.size(), NONE);
+  for (size_t t = 0; t < tables.size(); ++t)
   {
-    keyMetaMap.erase(payer.value());
+    const std::vector<PublicKey> &addresses = tables[t].addresses;
+    const size_t count = std::min(addresses.size(), MAX_LOOKUP_TABLE_ADDRESSES);
+    for (size_t i = 0; i < count; ++i)
+    {
+      const KeyIndex::Entry *entry = this->keyIndex.find(addresses[i]);
+      if (entry == nullptr || entry->meta.isSigner || entry->meta.isInvoked || entry->meta.isLoaded)
+      {
+        continue;
+      }
+      const size_t e = entry - entries.data();
+      if (lastTable[e] != t)
+      {
+        lastTable[e] = t;
+        candidates[t].emplace_back(e, static_cast<uint8_t>(i));
+      }
+    }
   }
 
-  std::vector<PublicKey> writableSignerKeys;
-  std::vector<PublicKey> readonlySignerKeys;
-  std::vector<PublicKey> writableNonSignerKeys;
-  std::vector<PublicKey> readonlyNonSignerKeys;
-
-  for (const auto &[key, meta] : keyMetaMap)
+  // Greedy set cover: keep taking the table that loads the most keys not
+  // loaded yet
+  std::vector<size_t> loadedFrom(entries.size(), NONE);
+  std::vector<bool> used(tables.size(), false);
+  while (true)
   {
-    if (meta.isSigner && meta.isWritable)
+    size_t best = 0;
+    size_t bestCount = 0;
+    for (size_t t = 0; t < tables.size(); ++t)
+    {
+      if (used[t])
+      {
+        continue;
+      }
+      size_t count = 0;
+      for (const auto &candidate : candidates[t])
+      {
+        count += loadedFrom[candidate.first] == NONE;
+      }
+      if (count > bestCount)
+      {
+        best = t;
+        bestCount = count;
+      }
+    }
+    if (bestCount < MIN_KEYS_PER_LOOKUP)
     {
-      writableSignerKeys.push_back(key);
+      break;
     }
-    else if (meta.isSigner && !meta.isWritable)
+    used[best] = true;
+    for (const auto &candidate : candidates[best])
     {
-      readonlySignerKeys.push_back(key);
+      if (loadedFrom[candidate.first] == NONE)
+      {
+        loadedFrom[candidate.first] = best;
+      }
     }
-    else if (!meta.isSigner && meta.isWritable)
+  }
+
+  // Loaded keys keep their rank among the loaded writable or readonly keys
+  // in their position until tryIntoMessageComponents offsets it
+  std::vector<AddressLookupTable> lookups;
+  for (size_t t = 0; t < tables.size(); ++t)
+  {
+    if (!used[t])
     {
-      writableNonSignerKeys.push_back(key);
+      continue;
     }
-    else
+    AddressLookupTable lookup;
+    lookup.accountKey = tables[t].key;
+    for (const auto &[e, index] : candidates[t])
     {
-      readonlyNonSignerKeys.push_back(key);
+      if (loadedFrom[e] != t)
+      {
+        continue;
+      }
+      KeyIndex::Entry &entry = entries[e];
+      if (entry.meta.isWritable)
+      {
+        lookup.writableIndexes.push_back(index);
+        loadedWritable.push_back(entry.key);
+        entry.position = static_cast<uint16_t>(this->numLoadedWritable++);
+      }
+      else
+      {
+        lookup.readonlyIndexes.push_back(index);
+        loadedReadonly.push_back(entry.key);
+        entry.position = static_cast<uint16_t>(this->numLoadedReadonly++);
+      }
+      entry.meta.isLoaded = true;
     }
+    lookups.push_back(lookup);
   }
 
-  if (payer.has_value())
+  return lookups;
+}
+
+Result<std::pair<MessageHeader, ArenaVector<PublicKey>>> CompiledKeys::tryIntoMessageComponents()
+{
+  ArenaVector<KeyIndex::Entry> &entries = this->keyIndex.entries();
+  const size_t firstKey = payer.has_value() ? 1 : 0;
+
+  // Static keys other than the payer, sorted into writable signers,
+  // readonly signers, writable non-signers and readonly non-signers, each
+  // group in key order
+  auto rank = [](const CompiledKeyMeta &meta)
+  {
+    return meta.isSigner ? (meta.isWritable ? 0 : 1) : (meta.isWritable ? 2 : 3);
+  };
+  ArenaVector<uint16_t> order(entries.get_allocator());
+  order.reserve(entries.size());
+  size_t numReadonlySigners = 0;
+  size_t numReadonlyNonSigners = 0;
+  size_t signersLen = firstKey;
+  for (size_t e = firstKey; e < entries.size(); ++e)
   {
-    writableSignerKeys.insert(writableSignerKeys.begin(), payer.value());
+    const CompiledKeyMeta &meta = entries[e].meta;
+    if (meta.isLoaded)
+    {
+      continue;
+    }
+    order.push_back(static_cast<uint16_t>(e));
+    signersLen += meta.isSigner;
+    numReadonlySigners += meta.isSigner && !meta.isWritable;
+    numReadonlyNonSigners += !meta.isSigner && !meta.isWritable;
   }
 
-  size_t signersLen = writableSignerKeys.size() + readonlySignerKeys.size();
-
-  if (signersLen > 255 || readonlySignerKeys.size() > 255 || readonlyNonSignerKeys.size() > 255)
+  const size_t numStaticKeys = firstKey + order.size();
+  if (signersLen > 255 || numReadonlySigners > 255 || numReadonlyNonSigners > 255 ||
+      numStaticKeys + this->numLoadedWritable + this->numLoadedReadonly > 256)
   {
-    throw CompileError("AccountIndexOverflow");
+    return Error("AccountIndexOverflow");
   }
 
+  std::sort(order.begin(), order.end(), [&](uint16_t a, uint16_t b)
+            {
+              const int rankA = rank(entries[a].meta);
+              const int rankB = rank(entries[b].meta);
+              return rankA != rankB ? rankA < rankB : entries[a].key < entries[b].key; });
+
   MessageHeader header = {
       static_cast<uint8_t>(signersLen),
-      static_cast<uint8_t>(readonlySignerKeys.size()),
-      static_cast<uint8_t>(readonlyNonSignerKeys.size()),
+      static_cast<uint8_t>(numReadonlySigners),
+      static_cast<uint8_t>(numReadonlyNonSigners),
   };
 
-  std::vector<PublicKey> staticAccountKeys;
-  staticAccountKeys.insert(staticAccountKeys.end(), writableSignerKeys.begin(), writableSignerKeys.end());
-  staticAccountKeys.insert(staticAccountKeys.end(), readonlySignerKeys.begin(), readonlySignerKeys.end());
-  staticAccountKeys.insert(staticAccountKeys.end(), writableNonSignerKeys.begin(), writableNonSignerKeys.end());
-  staticAccountKeys.insert(staticAccountKeys.end(), readonlyNonSignerKeys.begin(), readonlyNonSignerKeys.end());
+  ArenaVector<PublicKey> staticAccountKeys(entries.get_allocator());
+  staticAccountKeys.reserve(numStaticKeys);
+  if (payer.has_value())
+  {
+    entries[0].position = 0;
+    staticAccountKeys.push_back(entries[0].key);
+  }
+  for (uint16_t e : order)
+  {
+    entries[e].position = static_cast<uint16_t>(staticAccountKeys.size());
+    staticAccountKeys.push_back(entries[e].key);
+  }
+
+  for (KeyIndex::Entry &entry : entries)
+  {
+    if (entry.meta.isLoaded)
+    {
+      entry.position += numStaticKeys + (entry.meta.isWritable ? 0 : this->numLoadedWritable);
+    }
+  }
 
-  return {header, staticAccountKeys};
+  return std::make_pair(header, std::move(staticAccountKeys));
 }
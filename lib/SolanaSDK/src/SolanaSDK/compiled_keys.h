@@ -1,19 +1,15 @@
 #ifndef COMPILED_KEYS_H
 #define COMPILED_KEYS_H
 
-#include <map>
 #include <vector>
 #include <optional>
 #include "public_key.h"
 #include "instruction.h"
 #include "message.h"
-
-struct CompiledKeyMeta
-{
-  bool isSigner = false;
-  bool isWritable = false;
-  bool isInvoked = false;
-};
+#include "address_lookup_table.h"
+#include "result.h"
+#include "arena.h"
+#include "key_index.h"
 
 using CompileError = std::runtime_error;
 
@@ -21,11 +17,32 @@ class CompiledKeys
 {
 public:
   std::optional<PublicKey> payer;
-  std::map<PublicKey, CompiledKeyMeta> keyMetaMap;
 
-  static CompiledKeys compile(std::vector<Instruction> &instructions, std::optional<PublicKey> &payer);
+  // Every key with its metadata, the payer first
+  KeyIndex keyIndex;
+
+  CompiledKeys(const std::optional<PublicKey> &payer, MemoryResource *resource = heapResource());
+
+  // Collect the keys of `instructions`, the index allocates from `resource`
+  static CompiledKeys compile(const std::vector<Instruction> &instructions, const std::optional<PublicKey> &payer, MemoryResource *resource = heapResource());
+
+  // Move keys that are neither signers nor invoked programs out of the
+  // static keys and into lookups of `tables`. Tables are picked greedily by
+  // how many keys they cover, and only when that shrinks the message. The
+  // moved keys are appended to `loadedWritable` and `loadedReadonly`, the
+  // order the runtime appends them to the static keys.
+  std::vector<AddressLookupTable> extractTableLookups(const std::vector<AddressLookupTableAccount> &tables, std::vector<PublicKey> &loadedWritable, std::vector<PublicKey> &loadedReadonly);
+
+  // The header and the static account keys, which allocate from the
+  // resource of keyIndex. Also sets the position of every key in keyIndex:
+  // the static keys, then the loaded writable and loaded readonly keys in
+  // the order extractTableLookups returned them, so compileInstructions can
+  // look each account up once.
+  Result<std::pair<MessageHeader, ArenaVector<PublicKey>>> tryIntoMessageComponents();
 
-  std::pair<MessageHeader, std::vector<PublicKey>> tryIntoMessageComponents();
+private:
+  size_t numLoadedWritable = 0;
+  size_t numLoadedReadonly = 0;
 };
 
 #endif // COMPILED_KEYS_H
@@ -1,10 +1,20 @@
 #include <string>
+#include <cstring>
+#include <vector>
 #include <ArduinoJson.h>
 #include "connection.h"
 #include "hash.h"
 #include "base58.h"
+#include "base64.h"
 #include "send_request.h"
 
+// Upper bound of a base58 encoded transaction, log(256) / log(58) < 1.38
+constexpr size_t BASE58_TRANSACTION_MAX_LEN = PACKET_DATA_SIZE * 138 / 100 + 1;
+
+// Upper bound of a sendTransaction request: the encoded transaction plus the
+// JSON-RPC envelope and send options
+constexpr size_t SEND_TRANSACTION_PAYLOAD_MAX_LEN = BASE58_TRANSACTION_MAX_LEN + 256;
+
 std::string to_string(Commitment commitment)
 {
   switch (commitment)
@@ -19,6 +29,18 @@ std::string to_string(Commitment commitment)
   return ""; // Default case, should not be reached
 }
 
+std::string to_string(TransactionEncoding encoding)
+{
+  switch (encoding)
+  {
+  case TransactionEncoding::base58:
+    return "base58";
+  case TransactionEncoding::base64:
+    return "base64";
+  }
+  return ""; // Default case, should not be reached
+}
+
 String Connection::createRequestPayload(uint16_t id, const std::string &method, JsonObject &additionalParams)
 {
   StaticJsonDocument<1024> doc;
@@ -62,7 +84,7 @@ Connection::Connection(std::string endpoint)
   this->commitment = Commitment::processed;
 }
 
-BlockhashWithExpiryBlockHeight Connection::_getLatestBlockhash(Commitment commitment)
+Result<BlockhashWithExpiryBlockHeight> Connection::_getLatestBlockhash(Commitment commitment)
 {
   // Create a JSON document to hold the request payload
   DynamicJsonDocument doc(256);
@@ -85,11 +107,12 @@ BlockhashWithExpiryBlockHeight Connection::_getLatestBlockhash(Commitment commit
     // Extract the blockhash string from the response
     const char *blockhashString = responseDoc["result"]["value"]["blockhash"];
 
-    // Decode the blockhash string using Base58 decoding
-    std::vector<uint8_t> recentBlockhashBytes = Base58::trimDecode(blockhashString);
-
-    // Construct the Hash object from the decoded bytes
-    Hash blockhash = Hash(recentBlockhashBytes);
+    // Decode the blockhash string straight into the Hash bytes
+    Hash blockhash;
+    if (blockhashString == nullptr || Base58::decode(blockhashString, strlen(blockhashString), blockhash.data) != Base58Status::Ok)
+    {
+      return Error("Invalid blockhash");
+    }
 
     // Construct the BlockhashWithExpiryBlockHeight object
     BlockhashWithExpiryBlockHeight blockhashWithExpiryBlockHeight;
@@ -106,79 +129,132 @@ BlockhashWithExpiryBlockHeight Connection::_getLatestBlockhash(Commitment commit
   }
   else
   {
-    // Throw an exception or handle the error as needed
-    throw std::runtime_error("Request failed");
+    return Error("Request failed");
   }
 }
 
 BlockhashWithExpiryBlockHeight Connection::getLatestBlockhash(Commitment commitment)
 {
-  return _getLatestBlockhash(commitment);
+  return valueOrThrow<std::runtime_error>(_getLatestBlockhash(commitment));
 }
 
 BlockhashWithExpiryBlockHeight Connection::getLatestBlockhash()
+{
+  return valueOrThrow<std::runtime_error>(_getLatestBlockhash(commitment));
+}
+
+Result<BlockhashWithExpiryBlockHeight> Connection::tryGetLatestBlockhash(Commitment commitment)
 {
   return _getLatestBlockhash(commitment);
 }
 
-Signature Connection::_sendTransaction(Transaction transaction, SendOptions sendOptions)
+Result<BlockhashWithExpiryBlockHeight> Connection::tryGetLatestBlockhash()
 {
-  // Create a JSON document to hold the request payload
-  DynamicJsonDocument doc(512);
+  return _getLatestBlockhash(commitment);
+}
 
-  // Create the params array
-  JsonArray params = doc.createNestedArray("params");
+Result<Signature> Connection::_sendTransaction(const Transaction &transaction, SendOptions sendOptions)
+{
+  // A transaction that does not fit a packet would be rejected anyway
+  const size_t transactionSerializedLen = transaction.serializedSize();
+  if (transactionSerializedLen > PACKET_DATA_SIZE)
+  {
+    return Error("Transaction too large");
+  }
 
-  // Serialize transaction and add it to the params array
-  String transactionSerialized = Base58::trimEncode(transaction.serialize()).c_str();
-  params.add(transactionSerialized);
+  // One heap block holds the serialized transaction followed by the request
+  // encoded from it. Both on the stack would take over 3 KB of the 8 KB
+  // Arduino loop task, before HTTPClient and TLS add their frames.
+  std::vector<uint8_t> buffer(transactionSerializedLen + SEND_TRANSACTION_PAYLOAD_MAX_LEN);
+  const uint8_t *transactionSerialized = buffer.data();
+  if (!transaction.serializeInto(Span<uint8_t>(buffer.data(), transactionSerializedLen)))
+  {
+    return Error("Transaction too large");
+  }
 
-  // Create options object and add parameters
-  StaticJsonDocument<128> options;
-  options["encoding"] = "base58";
-  options["skipPreflight"] = sendOptions.skipPreflight;
-  options["preflightCommitment"] = to_string(sendOptions.preflightCommitment);
-  options["maxRetries"] = sendOptions.maxRetires;
+  // The transaction is encoded in place between the JSON-RPC prefix and
+  // the send options
+  char *requestPayload = reinterpret_cast<char *>(buffer.data() + transactionSerializedLen);
+  const size_t requestPayloadCapacity = SEND_TRANSACTION_PAYLOAD_MAX_LEN;
+  size_t requestPayloadLen = snprintf(requestPayload, requestPayloadCapacity,
+                                      "{\"id\":1,\"jsonrpc\":\"2.0\",\"method\":\"sendTransaction\",\"params\":[\"");
 
-  // Add options object to the params array
-  params.add(options);
+  if (sendOptions.encoding == TransactionEncoding::base58)
+  {
+    size_t transactionEncodedLen = 0;
+    Span<char> transactionEncoded(requestPayload + requestPayloadLen, requestPayloadCapacity - requestPayloadLen);
+    if (Base58::encode(transactionSerialized, transactionSerializedLen, transactionEncoded, transactionEncodedLen) != Base58Status::Ok)
+    {
+      return Error("Transaction too large");
+    }
+    requestPayloadLen += transactionEncodedLen;
+  }
+  else
+  {
+    if (Base64::encodedLen(transactionSerializedLen) >= requestPayloadCapacity - requestPayloadLen)
+    {
+      return Error("Transaction too large");
+    }
+    requestPayloadLen += Base64::encode(transactionSerialized, transactionSerializedLen, requestPayload + requestPayloadLen);
+  }
 
-  // Create the request payload using createRequestPayload method
-  String requestPayload = createRequestPayload(1, "sendTransaction", params);
+  // Append the options object and close the params array
+  int optionsLen = snprintf(requestPayload + requestPayloadLen, requestPayloadCapacity - requestPayloadLen,
+                            "\",{\"encoding\":\"%s\",\"skipPreflight\":%s,\"preflightCommitment\":\"%s\",\"maxRetries\":%d}]}",
+                            to_string(sendOptions.encoding).c_str(),
+                            sendOptions.skipPreflight ? "true" : "false",
+                            to_string(sendOptions.preflightCommitment).c_str(),
+                            sendOptions.maxRetires);
+  if (optionsLen < 0 || static_cast<size_t>(optionsLen) >= requestPayloadCapacity - requestPayloadLen)
+  {
+    return Error("Transaction too large");
+  }
+  requestPayloadLen += optionsLen;
 
   // Send the HTTP request and get the response
   String response;
-  if (sendHttpRequest(rpcEndpoint.c_str(), requestPayload, response))
+  if (sendHttpRequest(rpcEndpoint.c_str(), reinterpret_cast<const uint8_t *>(requestPayload), requestPayloadLen, response))
   {
     // Parse the JSON response
     DynamicJsonDocument responseDoc(128); // Adjust capacity as needed
     deserializeJson(responseDoc, response);
 
     // Extract the signature string from the response
-    String signatureString = responseDoc["result"];
+    const char *signatureString = responseDoc["result"];
 
-    // Decode the signature string using Base58 decoding
-    std::vector<uint8_t> signatureBytes = Base58::trimDecode(signatureString.c_str());
-
-    // Deserialize the signature
-    Signature signature = Signature::deserialize(signatureBytes);
+    // Decode the signature string straight into the Signature bytes
+    Signature signature;
+    if (signatureString == nullptr || Base58::decode(signatureString, strlen(signatureString), signature.value) != Base58Status::Ok)
+    {
+      return Error("Invalid signature");
+    }
 
     return signature;
   }
   else
   {
-    // Throw an exception or handle the error as needed
-    throw std::runtime_error("Request failed");
+    return Error("Request failed");
   }
 }
 
-Signature Connection::sendTransaction(Transaction transaction, SendOptions sendOptions)
+Signature Connection::sendTransaction(const Transaction &transaction, SendOptions sendOptions)
+{
+  return valueOrThrow<std::runtime_error>(_sendTransaction(transaction, sendOptions));
+}
+
+Signature Connection::sendTransaction(const Transaction &transaction)
+{
+  SendOptions defaultSendOptions;
+  return valueOrThrow<std::runtime_error>(_sendTransaction(transaction, defaultSendOptions));
+}
+
+Result<Signature> Connection::trySendTransaction(const Transaction &transaction, SendOptions sendOptions)
 {
   return _sendTransaction(transaction, sendOptions);
 }
 
-Signature Connection::sendTransaction(Transaction transaction)
+Result<Signature> Connection::trySendTransaction(const Transaction &transaction)
 {
   SendOptions defaultSendOptions;
   return _sendTransaction(transaction, defaultSendOptions);
-}
\ No newline at end of file
+}
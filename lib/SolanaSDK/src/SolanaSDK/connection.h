@@ -6,6 +6,7 @@
 #include "hash.h"
 #include "signature.h"
 #include "transaction.h"
+#include "result.h"
 
 enum class Commitment
 {
@@ -17,8 +18,19 @@ enum class Commitment
 // Overload the std::string conversion operator for Commitment enum class
 std::string to_string(Commitment commitment);
 
+enum class TransactionEncoding
+{
+  base58,
+  base64
+};
+
+std::string to_string(TransactionEncoding encoding);
+
 struct SendOptions
 {
+  // Wire encoding of the serialized transaction, base58 is quadratic in the
+  // transaction size and only kept for RPC nodes that require it
+  TransactionEncoding encoding = TransactionEncoding::base64;
   bool skipPreflight = false;
   Commitment preflightCommitment = Commitment::confirmed;
   int maxRetires = 5;
@@ -40,17 +52,23 @@ private:
   String createRequestPayload(uint16_t id, const std::string &method, JsonObject &additionalParams);
   String createRequestPayload(uint16_t id, const std::string &method, JsonArray &additionalParams);
   // TODO: Add proper commitment or config args
-  BlockhashWithExpiryBlockHeight _getLatestBlockhash(Commitment commitment);
+  Result<BlockhashWithExpiryBlockHeight> _getLatestBlockhash(Commitment commitment);
   // TODO: Add proper signer arg and
-  Signature _sendTransaction(Transaction transaction, SendOptions sendOptions);
+  Result<Signature> _sendTransaction(const Transaction &transaction, SendOptions sendOptions);
 
 public:
   Connection(std::string endpoint, Commitment commitment);
   Connection(std::string endpoint);
   BlockhashWithExpiryBlockHeight getLatestBlockhash(Commitment commitment);
   BlockhashWithExpiryBlockHeight getLatestBlockhash();
-  Signature sendTransaction(Transaction transaction, SendOptions sendOptions);
-  Signature sendTransaction(Transaction transaction);
+  Signature sendTransaction(const Transaction &transaction, SendOptions sendOptions);
+  Signature sendTransaction(const Transaction &transaction);
+
+  // Non-throwing counterparts, returning request and response failures
+  Result<BlockhashWithExpiryBlockHeight> tryGetLatestBlockhash(Commitment commitment);
+  Result<BlockhashWithExpiryBlockHeight> tryGetLatestBlockhash();
+  Result<Signature> trySendTransaction(const Transaction &transaction, SendOptions sendOptions);
+  Result<Signature> trySendTransaction(const Transaction &transaction);
 };
 
 #endif // CONNECTION_H
\ No newline at end of file
@@ -0,0 +1,334 @@
+#include <cstdint>
+#include "edwards25519.h"
+
+namespace
+{
+  inline uint32_t load32(const uint8_t *p)
+  {
+    return static_cast<uint32_t>(p[0]) | (static_cast<uint32_t>(p[1]) << 8) |
+           (static_cast<uint32_t>(p[2]) << 16) | (static_cast<uint32_t>(p[3]) << 24);
+  }
+
+#ifdef __SIZEOF_INT128__
+  // Field elements of GF(2^255 - 19) as five 51-bit limbs, for hosts with
+  // 64x64 -> 128 bit multiplication
+  struct Fe
+  {
+    uint64_t v[5];
+  };
+
+  using u128 = unsigned __int128;
+
+  constexpr uint64_t MASK51 = (uint64_t(1) << 51) - 1;
+
+  // d = -121665 / 121666
+  constexpr Fe D = {{0x34dca135978a3, 0x1a8283b156ebd, 0x5e7a26001c029, 0x739c663a03cbb, 0x52036cee2b6ff}};
+
+  constexpr Fe ONE = {{1, 0, 0, 0, 0}};
+
+  inline uint64_t load64(const uint8_t *p)
+  {
+    return static_cast<uint64_t>(load32(p)) | (static_cast<uint64_t>(load32(p + 4)) << 32);
+  }
+
+  // Loads the low 255 bits, the sign bit of x is ignored
+  Fe feFromBytes(const uint8_t s[32])
+  {
+    return {{load64(s) & MASK51,
+             (load64(s + 6) >> 3) & MASK51,
+             (load64(s + 12) >> 6) & MASK51,
+             (load64(s + 19) >> 1) & MASK51,
+             (load64(s + 24) >> 12) & MASK51}};
+  }
+
+  // One carry pass, the carry out of the top limb wraps around as * 19 and
+  // is returned
+  uint64_t feCarryPass(Fe &h)
+  {
+    uint64_t carry = 0;
+    for (int i = 0; i < 5; ++i)
+    {
+      carry = h.v[i] >> 51;
+      h.v[i] &= MASK51;
+      if (i < 4)
+      {
+        h.v[i + 1] += carry;
+      }
+    }
+    h.v[0] += carry * 19;
+    return carry;
+  }
+
+  Fe feAdd(const Fe &f, const Fe &g)
+  {
+    Fe h;
+    for (int i = 0; i < 5; ++i)
+    {
+      h.v[i] = f.v[i] + g.v[i];
+    }
+    feCarryPass(h);
+    return h;
+  }
+
+  // f + 2p - g keeps every limb positive
+  Fe feSub(const Fe &f, const Fe &g)
+  {
+    Fe h;
+    h.v[0] = f.v[0] + 0xfffffffffffda - g.v[0];
+    for (int i = 1; i < 5; ++i)
+    {
+      h.v[i] = f.v[i] + 0xffffffffffffe - g.v[i];
+    }
+    feCarryPass(h);
+    return h;
+  }
+
+  Fe feReduce(const u128 r[5])
+  {
+    Fe h;
+    uint64_t carry = static_cast<uint64_t>(r[0] >> 51);
+    h.v[0] = static_cast<uint64_t>(r[0]) & MASK51;
+    for (int i = 1; i < 5; ++i)
+    {
+      const u128 t = r[i] + carry;
+      carry = static_cast<uint64_t>(t >> 51);
+      h.v[i] = static_cast<uint64_t>(t) & MASK51;
+    }
+    h.v[0] += carry * 19;
+    h.v[1] += h.v[0] >> 51;
+    h.v[0] &= MASK51;
+    return h;
+  }
+
+  Fe feMul(const Fe &f, const Fe &g)
+  {
+    const uint64_t *a = f.v;
+    const uint64_t *b = g.v;
+    const uint64_t b1 = b[1] * 19, b2 = b[2] * 19, b3 = b[3] * 19, b4 = b[4] * 19;
+    const u128 r[5] = {
+        (u128)a[0] * b[0] + (u128)a[1] * b4 + (u128)a[2] * b3 + (u128)a[3] * b2 + (u128)a[4] * b1,
+        (u128)a[0] * b[1] + (u128)a[1] * b[0] + (u128)a[2] * b4 + (u128)a[3] * b3 + (u128)a[4] * b2,
+        (u128)a[0] * b[2] + (u128)a[1] * b[1] + (u128)a[2] * b[0] + (u128)a[3] * b4 + (u128)a[4] * b3,
+        (u128)a[0] * b[3] + (u128)a[1] * b[2] + (u128)a[2] * b[1] + (u128)a[3] * b[0] + (u128)a[4] * b4,
+        (u128)a[0] * b[4] + (u128)a[1] * b[3] + (u128)a[2] * b[2] + (u128)a[3] * b[1] + (u128)a[4] * b[0]};
+    return feReduce(r);
+  }
+
+  Fe feSquare(const Fe &f)
+  {
+    const uint64_t *a = f.v;
+    const uint64_t a0_2 = a[0] * 2, a1_2 = a[1] * 2, a2_2 = a[2] * 2, a3_2 = a[3] * 2;
+    const uint64_t a3_19 = a[3] * 19, a4_19 = a[4] * 19;
+    const u128 r[5] = {
+        (u128)a[0] * a[0] + (u128)a1_2 * a4_19 + (u128)a2_2 * a3_19,
+        (u128)a0_2 * a[1] + (u128)a2_2 * a4_19 + (u128)a[3] * a3_19,
+        (u128)a0_2 * a[2] + (u128)a[1] * a[1] + (u128)a3_2 * a4_19,
+        (u128)a0_2 * a[3] + (u128)a1_2 * a[2] + (u128)a[4] * a4_19,
+        (u128)a0_2 * a[4] + (u128)a1_2 * a[3] + (u128)a[2] * a[2]};
+    return feReduce(r);
+  }
+
+  // Whether h is congruent to p - 1
+  bool feIsMinusOne(Fe h)
+  {
+    h.v[0] += 1;
+    // Carry until nothing wraps, the limbs then spell out a value below 2^255
+    while (feCarryPass(h) != 0)
+    {
+    }
+    // Below 2^255 the value is zero mod p exactly when it is 0 or p itself
+    uint64_t zero = 0;
+    uint64_t isP = 0;
+    for (int i = 0; i < 5; ++i)
+    {
+      zero |= h.v[i];
+      isP |= h.v[i] ^ (i == 0 ? MASK51 - 18 : MASK51);
+    }
+    return zero == 0 || isP == 0;
+  }
+#else
+  // Field elements of GF(2^255 - 19) in radix 2^25.5: even limbs hold 26
+  // bits and odd limbs 25 bits, so every product is a single 32x32 -> 64
+  // bit multiplication on 32-bit targets such as the ESP32
+  struct Fe
+  {
+    int32_t v[10];
+  };
+
+  constexpr unsigned LIMB_BITS[10] = {26, 25, 26, 25, 26, 25, 26, 25, 26, 25};
+
+  // d = -121665 / 121666
+  constexpr Fe D = {{-10913610, 13857413, -15372611, 6949391, 114729,
+                     -8787816, -6275908, -3247719, -18696448, -12055116}};
+
+  constexpr Fe ONE = {{1, 0, 0, 0, 0, 0, 0, 0, 0, 0}};
+
+  // Loads the low 255 bits, the sign bit of x is ignored
+  Fe feFromBytes(const uint8_t s[32])
+  {
+    return {{static_cast<int32_t>(load32(s) & 0x3ffffff),
+             static_cast<int32_t>((load32(s + 3) >> 2) & 0x1ffffff),
+             static_cast<int32_t>((load32(s + 6) >> 3) & 0x3ffffff),
+             static_cast<int32_t>((load32(s + 9) >> 5) & 0x1ffffff),
+             static_cast<int32_t>((load32(s + 12) >> 6) & 0x3ffffff),
+             static_cast<int32_t>(load32(s + 16) & 0x1ffffff),
+             static_cast<int32_t>((load32(s + 19) >> 1) & 0x3ffffff),
+             static_cast<int32_t>((load32(s + 22) >> 3) & 0x1ffffff),
+             static_cast<int32_t>((load32(s + 25) >> 4) & 0x3ffffff),
+             static_cast<int32_t>((load32(s + 28) >> 6) & 0x1ffffff)}};
+  }
+
+  // One carry pass bringing every limb back into its width. The carry out of
+  // the top limb wraps around as * 19 and is returned.
+  int64_t feCarryPass(int64_t h[10])
+  {
+    int64_t carry = 0;
+    for (int i = 0; i < 10; ++i)
+    {
+      carry = h[i] >> LIMB_BITS[i];
+      h[i] -= carry * (int64_t(1) << LIMB_BITS[i]);
+      if (i < 9)
+      {
+        h[i + 1] += carry;
+      }
+    }
+    h[0] += carry * 19;
+    return carry;
+  }
+
+  // Two passes bring the limbs back within a bit of their width
+  Fe feCarry(int64_t h[10])
+  {
+    feCarryPass(h);
+    feCarryPass(h);
+    Fe out;
+    for (int i = 0; i < 10; ++i)
+    {
+      out.v[i] = static_cast<int32_t>(h[i]);
+    }
+    return out;
+  }
+
+  Fe feAdd(const Fe &f, const Fe &g)
+  {
+    int64_t h[10];
+    for (int i = 0; i < 10; ++i)
+    {
+      h[i] = int64_t(f.v[i]) + g.v[i];
+    }
+    return feCarry(h);
+  }
+
+  Fe feSub(const Fe &f, const Fe &g)
+  {
+    int64_t h[10];
+    for (int i = 0; i < 10; ++i)
+    {
+      h[i] = int64_t(f.v[i]) - g.v[i];
+    }
+    return feCarry(h);
+  }
+
+  // Limb i sits at bit ceil(25.5 * i), so the product of two odd limbs lands
+  // one bit above limb i + j and is doubled; wrapping past 2^255 is * 19.
+  Fe feMul(const Fe &f, const Fe &g)
+  {
+    int32_t g19[10];
+    for (int i = 0; i < 10; ++i)
+    {
+      g19[i] = g.v[i] * 19;
+    }
+
+    int64_t h[10] = {};
+    for (int i = 0; i < 10; ++i)
+    {
+      const int32_t fi = f.v[i];
+      const int32_t fi2 = (i & 1) ? fi * 2 : fi;
+      for (int j = 0; j < 10; ++j)
+      {
+        const int32_t a = (j & 1) ? fi2 : fi;
+        if (i + j < 10)
+        {
+          h[i + j] += int64_t(a) * g.v[j];
+        }
+        else
+        {
+          h[i + j - 10] += int64_t(a) * g19[j];
+        }
+      }
+    }
+    return feCarry(h);
+  }
+
+  Fe feSquare(const Fe &f)
+  {
+    return feMul(f, f);
+  }
+
+  // Whether h is congruent to p - 1
+  bool feIsMinusOne(const Fe &f)
+  {
+    int64_t h[10];
+    for (int i = 0; i < 10; ++i)
+    {
+      h[i] = f.v[i];
+    }
+    h[0] += 1;
+    // Carry until nothing wraps, the limbs then spell out a value below 2^255
+    while (feCarryPass(h) != 0)
+    {
+    }
+    // Below 2^255 the value is zero mod p exactly when it is 0 or p itself
+    int64_t zero = 0;
+    int64_t isP = 0;
+    for (int i = 0; i < 10; ++i)
+    {
+      zero |= h[i];
+      isP |= h[i] ^ ((int64_t(1) << LIMB_BITS[i]) - (i == 0 ? 19 : 1));
+    }
+    return zero == 0 || isP == 0;
+  }
+#endif
+
+  Fe feSquareTimes(Fe f, int n)
+  {
+    for (int i = 0; i < n; ++i)
+    {
+      f = feSquare(f);
+    }
+    return f;
+  }
+
+  // z^((p - 1) / 2) = z^(2^254 - 10), the Legendre symbol of z
+  Fe feLegendre(const Fe &z)
+  {
+    const Fe z2 = feSquare(z);
+    const Fe z8 = feSquareTimes(z2, 2);
+    const Fe z9 = feMul(z, z8);
+    const Fe z11 = feMul(z2, z9);
+    const Fe z2_5_0 = feMul(z9, feSquare(z11));
+    const Fe z2_10_0 = feMul(feSquareTimes(z2_5_0, 5), z2_5_0);
+    const Fe z2_20_0 = feMul(feSquareTimes(z2_10_0, 10), z2_10_0);
+    const Fe z2_40_0 = feMul(feSquareTimes(z2_20_0, 20), z2_20_0);
+    const Fe z2_50_0 = feMul(feSquareTimes(z2_40_0, 10), z2_10_0);
+    const Fe z2_100_0 = feMul(feSquareTimes(z2_50_0, 50), z2_50_0);
+    const Fe z2_200_0 = feMul(feSquareTimes(z2_100_0, 100), z2_100_0);
+    const Fe z2_250_0 = feMul(feSquareTimes(z2_200_0, 50), z2_50_0);
+    // 2^254 - 10 = (2^250 - 1) * 2^4 + 6
+    const Fe z6 = feMul(feSquare(z2), z2);
+    return feMul(feSquareTimes(z2_250_0, 4), z6);
+  }
+}
+
+bool isOnCurve(const uint8_t bytes[32])
+{
+  // The point decompresses when x^2 = u / v has a solution, with
+  // u = y^2 - 1 and v = d y^2 + 1. v is never zero, so that is the case
+  // exactly when u * v is a square or zero, which a single exponentiation
+  // (the Legendre symbol) decides without computing x.
+  const Fe y = feFromBytes(bytes);
+  const Fe y2 = feSquare(y);
+  const Fe u = feSub(y2, ONE);
+  const Fe v = feAdd(feMul(y2, D), ONE);
+  return !feIsMinusOne(feLegendre(feMul(u, v)));
+}
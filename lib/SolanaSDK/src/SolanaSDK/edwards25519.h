@@ -0,0 +1,12 @@
+#ifndef EDWARDS25519_H
+#define EDWARDS25519_H
+
+#include <cstdint>
+
+// Whether `bytes` is the compressed encoding of a point on the edwards25519
+// curve, i.e. whether it decompresses. This matches the on-curve check the
+// runtime uses for program derived addresses: the y coordinate is reduced
+// modulo p and small order points count as on the curve.
+bool isOnCurve(const uint8_t bytes[32]);
+
+#endif // EDWARDS25519_H
@@ -1,7 +1,9 @@
 #include <atomic>
 #include <sstream>
 #include <iomanip>
-#include "Hash.h"
+#include <algorithm>
+#include <stdexcept>
+#include "hash.h"
 #include "base58.h"
 
 Hash::Hash()
@@ -17,29 +19,34 @@ Hash::Hash(std::array<uint8_t, HASH_BYTES> &hashArray)
 }
 
 Hash::Hash(const std::vector<uint8_t> &hashSlice)
+{
+    this->data = valueOrThrow<std::runtime_error>(tryFromBytes(hashSlice)).data;
+}
+
+Result<Hash> Hash::tryFromBytes(const std::vector<uint8_t> &hashSlice)
 {
     if (hashSlice.size() != HASH_BYTES && hashSlice.size() != HASH_MAX_BASE58_LEN)
     {
-        throw std::runtime_error("Invalid vector size");
+        return Error("Invalid vector size");
     }
     auto firstNonZero = std::find_if(hashSlice.begin(), hashSlice.end(), [](uint8_t i)
                                      { return i != 0; });
 
+    Hash hash;
     if (firstNonZero == hashSlice.end())
     {
         // All elements in the hash are zero
-        std::copy(hashSlice.begin(), hashSlice.end(), this->data.begin());
+        return hash;
     }
     else if (std::distance(firstNonZero, hashSlice.end()) != HASH_BYTES)
     {
         // Hash size is not HASH_BYTES after the first non-zero element
-        throw std::runtime_error("Invalid hash size");
-    }
-    else
-    {
-        // Copy the hash starting from the first non-zero element
-        std::copy(firstNonZero, hashSlice.end(), this->data.begin());
+        return Error("Invalid hash size");
     }
+
+    // Copy the hash starting from the first non-zero element
+    std::copy(firstNonZero, hashSlice.end(), hash.data.begin());
+    return hash;
 }
 
 // Constructor to initialize from an array
@@ -75,10 +82,15 @@ std::vector<uint8_t> Hash::serialize()
 
 // Deserialize method
 Hash Hash::deserialize(const std::vector<uint8_t> &input)
+{
+    return valueOrThrow<std::invalid_argument>(tryDeserialize(input));
+}
+
+Result<Hash> Hash::tryDeserialize(const std::vector<uint8_t> &input)
 {
     if (input.size() != HASH_BYTES)
     {
-        throw std::invalid_argument("Invalid hash string");
+        return Error("Invalid hash string");
     }
     Hash hash;
     for (size_t i = 0; i < HASH_BYTES; ++i)
@@ -91,32 +103,20 @@ Hash Hash::deserialize(const std::vector<uint8_t> &input)
 // Method to create a Hash from a Base58 encoded string
 Hash Hash::fromString(const std::string &str)
 {
-    std::string s_trimmed = str.substr(str.find_first_not_of('1')); // Skip initial '1's
-    const unsigned char *uchar_str = reinterpret_cast<const unsigned char *>(s_trimmed.c_str());
-    std::vector<uint8_t> decoded;
-
-    if (s_trimmed.size() == HASH_MAX_BASE58_LEN)
-    {
-        decoded = Base58::decode(str);
-    }
-    else if (s_trimmed.size() == HASH_BYTES)
-    {
-        decoded = Base58::decode(str);
-    }
-    else
-    {
-        throw std::invalid_argument("Invalid string length");
-    }
+    return valueOrThrow<std::invalid_argument>(tryFromString(str));
+}
 
-    if (decoded.size() != HASH_BYTES)
+Result<Hash> Hash::tryFromString(const std::string &str)
+{
+    if (str.size() > HASH_MAX_BASE58_LEN)
     {
-        throw std::invalid_argument("Invalid hash string");
+        return Error("Invalid string length");
     }
 
     Hash hash;
-    for (size_t i = 0; i < HASH_BYTES; ++i)
+    if (!Base58::decode32(str.data(), str.size(), hash.data.data()))
     {
-        hash.data[i] = decoded[i];
+        return Error("Invalid hash string");
     }
     return hash;
 }
@@ -125,30 +125,57 @@ std::string Hash::toStr()
 {
     if (data.size() != HASH_BYTES)
     {
-        throw std::invalid_argument("Invalid byte length for hash");
+        SOLANA_THROW(std::invalid_argument("Invalid byte length for hash"));
     }
 
-    // Convert std::array to std::vector
-    std::vector<uint8_t> dataVector(data.begin(), data.end());
+    return Base58::encode32(data.data());
+}
 
-    std::string base58Encoded = Base58::trimEncode(dataVector);
-    return base58Encoded;
+size_t Hash::toStr(char out[HASH_MAX_BASE58_LEN + 1]) const
+{
+    return Base58::encode32(data.data(), out);
 }
 
 void Hasher::hash(const uint8_t *val, size_t len)
 {
-    this->hasher.doUpdate(val, len);
+    this->hasher.update(val, len);
 }
 
-void Hasher::hashv(const std::vector<uint8_t *> &vals)
+void Hasher::hashv(const std::vector<Span<const uint8_t>> &vals)
 {
-    for (auto &val : vals)
+    for (const auto &val : vals)
     {
-        this->hash(val, std::strlen(reinterpret_cast<const char *>(val)));
+        this->hash(val.data(), val.size());
     }
 }
 
 void Hasher::result(Hash *hash)
 {
-    this->hasher.doFinal(reinterpret_cast<byte *>(hash->data.data()));
+    this->hasher.finalize(hash->data.data());
+}
+
+Hash Hasher::result()
+{
+    Hash hash;
+    this->result(&hash);
+    return hash;
+}
+
+void Hasher::write(const uint8_t *data, size_t len)
+{
+    this->hash(data, len);
+}
+
+Hash hashBytes(const uint8_t *val, size_t len)
+{
+    Hasher hasher;
+    hasher.hash(val, len);
+    return hasher.result();
+}
+
+Hash hashv(const std::vector<Span<const uint8_t>> &vals)
+{
+    Hasher hasher;
+    hasher.hashv(vals);
+    return hasher.result();
 }
@@ -4,7 +4,11 @@
 #include <cstring>
 #include <array>
 #include <vector>
-#include <Crypto.h>
+#include <string>
+#include "sha256.h"
+#include "byte_sink.h"
+#include "span.h"
+#include "result.h"
 
 // Size of hash in bytes
 constexpr size_t HASH_BYTES = 32;
@@ -26,7 +30,13 @@ public:
     std::vector<uint8_t> serialize();
     static Hash deserialize(const std::vector<uint8_t> &input);
     static Hash fromString(const std::string &str);
+
+    // Non-throwing counterparts of Hash(vec), deserialize and fromString
+    static Result<Hash> tryFromBytes(const std::vector<uint8_t> &vec);
+    static Result<Hash> tryDeserialize(const std::vector<uint8_t> &input);
+    static Result<Hash> tryFromString(const std::string &str);
     std::string toStr();
+    size_t toStr(char out[HASH_MAX_BASE58_LEN + 1]) const;
 
     bool operator!=(const Hash &other) const
     {
@@ -53,14 +63,26 @@ public:
     }
 };
 
-class Hasher
+// Incremental SHA-256 producing a Hash. Serializers can write straight into
+// a Hasher, which is a ByteSink, so hashing needs no intermediate buffer.
+class Hasher : public ByteSink
 {
 public:
-    SHA256 hasher;
+    Sha256 hasher;
 
     void hash(const uint8_t *val, size_t len);
-    void hashv(const std::vector<uint8_t *> &vals);
+    void hashv(const std::vector<Span<const uint8_t>> &vals);
     void result(Hash *hash);
+    Hash result();
+
+    void write(const uint8_t *data, size_t len) override;
+    using ByteSink::write;
 };
 
+// SHA-256 of a single buffer
+Hash hashBytes(const uint8_t *val, size_t len);
+
+// SHA-256 of the concatenation of several buffers
+Hash hashv(const std::vector<Span<const uint8_t>> &vals);
+
 #endif // HASH_H
\ No newline at end of file
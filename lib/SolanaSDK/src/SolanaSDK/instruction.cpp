@@ -8,15 +8,18 @@
 #include "instruction.h"
 #include "public_key.h"
 #include "account_meta.h"
+#include "result.h"
+#include "transaction_view.h"
+
+Instruction::Instruction(MemoryResource *resource) : accounts(resource), data(resource) {}
+
+Instruction::Instruction(const PublicKey &programId, Span<const AccountMeta> accounts, Span<const uint8_t> data, MemoryResource *resource)
+    : programId(programId), accounts(accounts.begin(), accounts.end(), resource), data(data.begin(), data.end(), resource) {}
 
 // Create a new instruction from a byte slice.
 Instruction Instruction::newWithBytes(PublicKey programId, std::vector<uint8_t> &data, std::vector<AccountMeta> accounts)
 {
-    return {
-        programId,
-        accounts,
-        data,
-    };
+    return Instruction(programId, accounts, data);
 }
 
 // Serialize method for Instruction
@@ -60,17 +63,13 @@ Instruction Instruction::deserialize(const std::vector<uint8_t> &input)
     return instruction;
 }
 
-template <typename T>
-CompiledInstruction::CompiledInstruction(uint8_t programIdsIndex, const T &data, std::vector<uint8_t> accounts)
-    : programIdIndex(programIdsIndex), accounts(std::move(accounts))
-{
-    this->data.insert(this->data.end(), data.begin(), data.end());
-}
+CompiledInstruction::CompiledInstruction(uint8_t programIdIndex, MemoryResource *resource)
+    : programIdIndex(programIdIndex), accounts(resource), data(resource) {}
 
-CompiledInstruction::CompiledInstruction(uint8_t programIdIndex, std::vector<uint8_t> data, std::vector<uint8_t> accounts)
-    : programIdIndex(programIdIndex), data(std::move(data)), accounts(std::move(accounts)) {}
+CompiledInstruction::CompiledInstruction(uint8_t programIdIndex, Span<const uint8_t> data, Span<const uint8_t> accounts, MemoryResource *resource)
+    : programIdIndex(programIdIndex), accounts(accounts.begin(), accounts.end(), resource), data(data.begin(), data.end(), resource) {}
 
-PublicKey CompiledInstruction::programId(const std::vector<PublicKey> &programIds) const
+PublicKey CompiledInstruction::programId(Span<const PublicKey> programIds) const
 {
     return programIds[this->programIdIndex];
 }
@@ -81,87 +80,116 @@ void CompiledInstruction::sanitize() {}
 std::vector<uint8_t> CompiledInstruction::serialize()
 {
     std::vector<uint8_t> result;
+    result.reserve(this->serializedSize());
+    VectorSink sink(result);
+    this->serialize(sink);
+    return result;
+}
 
+void CompiledInstruction::serialize(ByteSink &sink) const
+{
     // Serialize programIdIndex
-    result.push_back(static_cast<uint8_t>(programIdIndex));
-
-    // Serialize number of accounts
-    uint8_t numAccounts = static_cast<uint8_t>(accounts.size());
-    result.push_back(numAccounts);
+    sink.write(static_cast<uint8_t>(programIdIndex));
 
     // Serialize accounts
-    for (const auto &accountIndex : accounts)
-    {
-        result.push_back(static_cast<uint8_t>(accountIndex));
-    }
-
-    // Serialize data size
-    size_t dataSize = data.size();
-    result.push_back(static_cast<uint8_t>(dataSize));
-
-    // TODO: CHECK WHAT TO US LSB/MSB
-    // result.push_back(static_cast<uint8_t>((dataSize >> 0) & 0xFF)); // LSB
-    // result.push_back(static_cast<uint8_t>((dataSize >> 8) & 0xFF)); // MSB
+    sink.writeLength(accounts.size());
+    sink.write(accounts.data(), accounts.size());
 
     // Serialize data
-    result.insert(result.end(), data.begin(), data.end());
-
-    return result;
+    sink.writeLength(data.size());
+    sink.write(data.data(), data.size());
 }
 
-// Deserialize method for CompiledInstruction
-CompiledInstruction CompiledInstruction::deserialize(uint8_t programIdIndex, const std::vector<uint8_t> &accounts, const std::vector<uint8_t> &data, const std::vector<uint8_t> &input)
+size_t CompiledInstruction::serializedSize() const
 {
-    CompiledInstruction instruction(programIdIndex, data, accounts);
-    std::vector<uint8_t>::const_iterator it = input.begin();
+    return 1 + shortVecSize(accounts.size(), 1) + shortVecSize(data.size(), 1);
+}
 
-    // Deserialize programIdIndex
-    instruction.programIdIndex = *it++;
+Result<size_t> CompiledInstruction::serializeInto(Span<uint8_t> out) const
+{
+    return serializeToSpan(*this, out);
+}
 
-    // Deserialize accounts
-    while (it != input.end() && *it != 0)
+Result<CompiledInstruction> CompiledInstruction::tryDeserialize(Span<const uint8_t> input, MemoryResource *resource)
+{
+    size_t consumed = 0;
+    Result<InstructionView> view = InstructionView::parsePrefix(input, consumed);
+    if (!view)
     {
-        instruction.accounts.push_back(*it++);
+        return view.error();
     }
-
-    // Skip the zero byte separator
-    if (it != input.end())
+    if (consumed != input.size())
     {
-        ++it;
+        return Error("Trailing bytes after instruction");
     }
+    const InstructionView &instruction = view.value();
+    return CompiledInstruction(instruction.programIdIndex, instruction.data, instruction.accounts, resource);
+}
 
-    // Deserialize data
-    instruction.data.assign(it, input.end());
-
-    return instruction;
+CompiledInstruction CompiledInstruction::deserialize(const std::vector<uint8_t> &input)
+{
+    return valueOrThrow<std::runtime_error>(tryDeserialize(input));
 }
 
-uint8_t position(const std::vector<PublicKey> &keys, const PublicKey &key)
+uint8_t position(Span<const PublicKey> keys, const PublicKey &key)
 {
     auto it = std::find(keys.begin(), keys.end(), key);
     if (it == keys.end())
     {
-        throw std::runtime_error("Key not found");
+        SOLANA_THROW(std::runtime_error("Key not found"));
     }
     return std::distance(keys.begin(), it);
 }
 
-CompiledInstruction compileIx(const Instruction &ix, const std::vector<PublicKey> &keys)
+namespace
 {
-    std::vector<uint8_t> accounts;
-    for (const auto &accountMeta : ix.accounts)
+    // Compile `ix` with `positionOf` mapping keys to their index
+    template <typename PositionOf>
+    CompiledInstruction compileWith(const Instruction &ix, const PositionOf &positionOf, MemoryResource *resource)
     {
-        accounts.push_back(position(keys, accountMeta.publicKey));
+        CompiledInstruction compiled(positionOf(ix.programId), resource);
+        compiled.accounts.reserve(ix.accounts.size());
+        for (const auto &accountMeta : ix.accounts)
+        {
+            compiled.accounts.push_back(positionOf(accountMeta.publicKey));
+        }
+        compiled.data.assign(ix.data.begin(), ix.data.end());
+        return compiled;
     }
-    return CompiledInstruction{position(keys, ix.programId), ix.data, accounts};
-}
 
-std::vector<CompiledInstruction> compileInstructions(const std::vector<Instruction> &ixs, const std::vector<PublicKey> &keys)
-{
-    std::vector<CompiledInstruction> compiled;
-    for (const auto &ix : ixs)
+    template <typename PositionOf>
+    ArenaVector<CompiledInstruction> compileAllWith(const std::vector<Instruction> &ixs, const PositionOf &positionOf, MemoryResource *resource)
     {
-        compiled.push_back(compileIx(ix, keys));
+        ArenaVector<CompiledInstruction> compiled(resource);
+        compiled.reserve(ixs.size());
+        for (const auto &ix : ixs)
+        {
+            compiled.push_back(compileWith(ix, positionOf, resource));
+        }
+        return compiled;
     }
-    return compiled;
-}
\ No newline at end of file
+}
+
+CompiledInstruction compileIx(const Instruction &ix, Span<const PublicKey> keys, MemoryResource *resource)
+{
+    return compileWith(ix, [keys](const PublicKey &key)
+                       { return position(keys, key); }, resource);
+}
+
+ArenaVector<CompiledInstruction> compileInstructions(const std::vector<Instruction> &ixs, Span<const PublicKey> keys, MemoryResource *resource)
+{
+    return compileAllWith(ixs, [keys](const PublicKey &key)
+                          { return position(keys, key); }, resource);
+}
+
+CompiledInstruction compileIx(const Instruction &ix, const KeyIndex &keys, MemoryResource *resource)
+{
+    return compileWith(ix, [&keys](const PublicKey &key)
+                       { return keys.position(key); }, resource);
+}
+
+ArenaVector<CompiledInstruction> compileInstructions(const std::vector<Instruction> &ixs, const KeyIndex &keys, MemoryResource *resource)
+{
+    return compileAllWith(ixs, [&keys](const PublicKey &key)
+                          { return keys.position(key); }, resource);
+}
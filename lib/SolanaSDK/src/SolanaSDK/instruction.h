@@ -9,6 +9,10 @@
 #include <iomanip>
 #include "public_key.h"
 #include "account_meta.h"
+#include "byte_sink.h"
+#include "arena.h"
+#include "key_index.h"
+#include "result.h"
 
 class Instruction
 {
@@ -17,10 +21,17 @@ public:
     PublicKey programId;
 
     // Metadata describing accounts that should be passed to the program
-    std::vector<AccountMeta> accounts;
+    ArenaVector<AccountMeta> accounts;
 
     // Opaque data passed to the program for its own interpretation
-    std::vector<uint8_t> data;
+    ArenaVector<uint8_t> data;
+
+    Instruction() = default;
+
+    // Empty instruction whose accounts and data allocate from `resource`
+    explicit Instruction(MemoryResource *resource);
+
+    Instruction(const PublicKey &programId, Span<const AccountMeta> accounts, Span<const uint8_t> data, MemoryResource *resource = heapResource());
 
     static Instruction newWithBytes(PublicKey programId, std::vector<uint8_t> &data, std::vector<AccountMeta> accounts);
     std::vector<uint8_t> serialize();
@@ -34,22 +45,41 @@ public:
     uint8_t programIdIndex;
 
     // Ordered indices into the transaction keys array indicating which accounts to pass to the program.
-    std::vector<uint8_t> accounts;
+    ArenaVector<uint8_t> accounts;
 
     // The program input data.
-    std::vector<uint8_t> data;
+    ArenaVector<uint8_t> data;
 
-    template <typename T>
-    CompiledInstruction(uint8_t programIdsIndex, const T &data, std::vector<uint8_t> accounts);
-    CompiledInstruction(uint8_t programIdIndex, std::vector<uint8_t> data, std::vector<uint8_t> accounts);
-    PublicKey programId(const std::vector<PublicKey> &program_ids) const;
+    // Empty instruction whose accounts and data allocate from `resource`
+    explicit CompiledInstruction(uint8_t programIdIndex, MemoryResource *resource = heapResource());
+    CompiledInstruction(uint8_t programIdIndex, Span<const uint8_t> data, Span<const uint8_t> accounts, MemoryResource *resource = heapResource());
+    PublicKey programId(Span<const PublicKey> programIds) const;
     void sanitize();
     std::vector<uint8_t> serialize();
-    static CompiledInstruction deserialize(uint8_t programIdIndex, const std::vector<uint8_t> &accounts, const std::vector<uint8_t> &data, const std::vector<uint8_t> &input);
+    void serialize(ByteSink &sink) const;
+
+    // Exact length of the serialized instruction
+    size_t serializedSize() const;
+
+    // Serialize into `out`, returns the number of bytes written
+    Result<size_t> serializeInto(Span<uint8_t> out) const;
+
+    // Parse one instruction in the wire layout of serialize, as
+    // InstructionView::parsePrefix does, copying it into `resource`. Fails
+    // on truncated input and trailing bytes.
+    static Result<CompiledInstruction> tryDeserialize(Span<const uint8_t> input, MemoryResource *resource = heapResource());
+
+    // As tryDeserialize, throwing std::runtime_error
+    static CompiledInstruction deserialize(const std::vector<uint8_t> &input);
 };
 
-uint8_t position(const std::vector<PublicKey> &keys, const PublicKey &key);
-CompiledInstruction compileIx(const Instruction &ix, const std::vector<PublicKey> &keys);
-std::vector<CompiledInstruction> compileInstructions(const std::vector<Instruction> &ixs, const std::vector<PublicKey> &keys);
+uint8_t position(Span<const PublicKey> keys, const PublicKey &key);
+CompiledInstruction compileIx(const Instruction &ix, Span<const PublicKey> keys, MemoryResource *resource = heapResource());
+ArenaVector<CompiledInstruction> compileInstructions(const std::vector<Instruction> &ixs, Span<const PublicKey> keys, MemoryResource *resource = heapResource());
+
+// As compileIx and compileInstructions, with one lookup per account in the
+// positions CompiledKeys::tryIntoMessageComponents set in `keys`
+CompiledInstruction compileIx(const Instruction &ix, const KeyIndex &keys, MemoryResource *resource = heapResource());
+ArenaVector<CompiledInstruction> compileInstructions(const std::vector<Instruction> &ixs, const KeyIndex &keys, MemoryResource *resource = heapResource());
 
 #endif // COMPILED_INSTRUCTION_H
@@ -0,0 +1,107 @@
+#include <cstring>
+#include <stdexcept>
+#include "key_index.h"
+#include "result.h"
+
+// Slot count of an empty index
+constexpr size_t MIN_SLOTS = 16;
+
+KeyIndex::KeyIndex(MemoryResource *resource) : entryList(resource), slots(resource), shift(64)
+{
+  this->rehash(MIN_SLOTS);
+}
+
+uint64_t KeyIndex::prefixOf(const PublicKey &key)
+{
+  uint64_t prefix;
+  memcpy(&prefix, key.key, sizeof(prefix));
+  return prefix;
+}
+
+size_t KeyIndex::probe(const PublicKey &key, uint64_t prefix) const
+{
+  const size_t mask = this->slots.size() - 1;
+  size_t i = static_cast<size_t>((prefix * 0x9e3779b97f4a7c15ULL) >> this->shift);
+  while (true)
+  {
+    const Slot &slot = this->slots[i];
+    if (slot.entry == 0 || (slot.prefix == prefix && this->entryList[slot.entry - 1].key == key))
+    {
+      return i;
+    }
+    i = (i + 1) & mask;
+  }
+}
+
+void KeyIndex::rehash(size_t capacity)
+{
+  // At most half full, so probe sequences stay short
+  size_t count = MIN_SLOTS;
+  unsigned bits = 4;
+  while (count < capacity * 2)
+  {
+    count *= 2;
+    ++bits;
+  }
+  if (count <= this->slots.size())
+  {
+    return;
+  }
+
+  this->slots.assign(count, Slot{0, 0});
+  this->shift = 64 - bits;
+  for (size_t e = 0; e < this->entryList.size(); ++e)
+  {
+    const uint64_t prefix = prefixOf(this->entryList[e].key);
+    Slot &slot = this->slots[this->probe(this->entryList[e].key, prefix)];
+    slot.prefix = prefix;
+    slot.entry = static_cast<uint32_t>(e + 1);
+  }
+}
+
+void KeyIndex::reserve(size_t count)
+{
+  this->entryList.reserve(count);
+  this->rehash(count);
+}
+
+KeyIndex::Entry &KeyIndex::insert(const PublicKey &key)
+{
+  const uint64_t prefix = prefixOf(key);
+  size_t i = this->probe(key, prefix);
+  if (this->slots[i].entry != 0)
+  {
+    return this->entryList[this->slots[i].entry - 1];
+  }
+
+  if ((this->entryList.size() + 1) * 2 > this->slots.size())
+  {
+    this->rehash(this->entryList.size() + 1);
+    i = this->probe(key, prefix);
+  }
+  this->entryList.push_back(Entry{key, CompiledKeyMeta(), 0});
+  this->slots[i] = Slot{prefix, static_cast<uint32_t>(this->entryList.size())};
+  return this->entryList.back();
+}
+
+KeyIndex::Entry *KeyIndex::find(const PublicKey &key)
+{
+  const Slot &slot = this->slots[this->probe(key, prefixOf(key))];
+  return slot.entry == 0 ? nullptr : &this->entryList[slot.entry - 1];
+}
+
+const KeyIndex::Entry *KeyIndex::find(const PublicKey &key) const
+{
+  const Slot &slot = this->slots[this->probe(key, prefixOf(key))];
+  return slot.entry == 0 ? nullptr : &this->entryList[slot.entry - 1];
+}
+
+uint8_t KeyIndex::position(const PublicKey &key) const
+{
+  const Entry *entry = this->find(key);
+  if (entry == nullptr)
+  {
+    SOLANA_THROW(std::runtime_error("Key not found"));
+  }
+  return static_cast<uint8_t>(entry->position);
+}
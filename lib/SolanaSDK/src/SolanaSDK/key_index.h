@@ -0,0 +1,82 @@
+#ifndef KEY_INDEX_H
+#define KEY_INDEX_H
+
+#include <cstddef>
+#include <cstdint>
+#include "public_key.h"
+#include "arena.h"
+
+struct CompiledKeyMeta
+{
+  bool isSigner = false;
+  bool isWritable = false;
+  bool isInvoked = false;
+
+  // Loaded through an address table lookup instead of a static key
+  bool isLoaded = false;
+};
+
+// Flat open addressing table from the account keys of a message being
+// compiled to their metadata and final index. Slots hold the first 8 bytes
+// of their key, so probing compares 64-bit prefixes and only a matching
+// prefix costs a full 32 byte comparison. Entries stay in insertion order.
+class KeyIndex
+{
+public:
+  struct Entry
+  {
+    PublicKey key;
+    CompiledKeyMeta meta;
+
+    // Index of the key in the compiled message, set by
+    // CompiledKeys::tryIntoMessageComponents
+    uint16_t position = 0;
+  };
+
+  explicit KeyIndex(MemoryResource *resource = heapResource());
+
+  // Make room for `count` keys without rehashing
+  void reserve(size_t count);
+
+  // Entry of `key`, added with empty metadata when missing. Adding a key
+  // invalidates references to other entries.
+  Entry &insert(const PublicKey &key);
+
+  Entry *find(const PublicKey &key);
+
+  const Entry *find(const PublicKey &key) const;
+
+  // Final index of `key`, throws when the key is not indexed
+  uint8_t position(const PublicKey &key) const;
+
+  size_t size() const { return entryList.size(); }
+
+  ArenaVector<Entry> &entries() { return entryList; }
+
+  const ArenaVector<Entry> &entries() const { return entryList; }
+
+private:
+  struct Slot
+  {
+    uint64_t prefix;
+
+    // Index into entryList plus one, zero for an empty slot
+    uint32_t entry;
+  };
+
+  static uint64_t prefixOf(const PublicKey &key);
+
+  // Slot holding `key` or the empty slot where it belongs
+  size_t probe(const PublicKey &key, uint64_t prefix) const;
+
+  void rehash(size_t capacity);
+
+  ArenaVector<Entry> entryList;
+  ArenaVector<Slot> slots;
+
+  // 64 minus log2 of the slot count, slots are picked by the high bits of
+  // a multiplicative hash of the prefix
+  unsigned shift;
+};
+
+#endif // KEY_INDEX_H
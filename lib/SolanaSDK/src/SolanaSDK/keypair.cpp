@@ -29,7 +29,7 @@ Keypair::Keypair(const std::vector<unsigned char> &seed)
 Keypair::Keypair(const unsigned char seed[SECRET_KEY_LEN]) : Keypair(std::vector<unsigned char>(seed, seed + SECRET_KEY_LEN)) {}
 
 // Access secret key with authorization
-const unsigned char *Keypair::getSecretKey()
+const unsigned char *Keypair::getSecretKey() const
 {
     return this->secretKey;
 }
@@ -40,20 +40,14 @@ Keypair::~Keypair()
     std::fill(secretKey, secretKey + SECRET_KEY_LEN, 0);
 }
 
-// Generate a new Keypair with a random seed
 // Generate a new Keypair with a random seed
 Keypair Keypair::generate()
 {
-    std::vector<unsigned char> seed(SECRET_KEY_LEN);
-
-    // Fill the seed vector with random bytes one character at a time
-    for (size_t i = 0; i < seed.size(); ++i)
-    {
-        seed[i] = static_cast<unsigned char>(randombytes_random() % 256);
-    }
-
-    // Ensure that the size of the seed vector matches SECRET_KEY_LEN
-    assert(seed.size() == SECRET_KEY_LEN);
+    // Only the first 32 bytes are the Ed25519 seed
+    std::vector<unsigned char> seed(SECRET_KEY_LEN, 0);
+    randombytes_buf(seed.data(), 32);
 
-    return Keypair(seed);
+    Keypair keypair(seed);
+    sodium_memzero(seed.data(), seed.size());
+    return keypair;
 }
@@ -29,7 +29,7 @@ public:
     Keypair(const unsigned char seed[SECRET_KEY_LEN]);
 
     // Access secret key with authorization
-    const unsigned char *getSecretKey();
+    const unsigned char *getSecretKey() const;
 
     // Destructor to securely clear secret key
     ~Keypair();
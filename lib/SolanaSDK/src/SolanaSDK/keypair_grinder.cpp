@@ -0,0 +1,253 @@
+#include <sodium.h>
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstring>
+#include <stdexcept>
+#include "keypair_grinder.h"
+#include "base58.h"
+#include "worker_pool.h"
+
+namespace
+{
+    constexpr char ALPHABET_CHARS[] = "123456789ABCDEFGHJKLMNPQRSTUVWXYZabcdefghijkmnopqrstuvwxyz";
+
+    // 58^5 is the largest power of 58 that fits a 32-bit limb
+    constexpr uint32_t R1 = 58;
+    constexpr uint32_t R5 = R1 * R1 * R1 * R1 * R1;
+
+    constexpr size_t SEED_LEN = 32;
+
+    // Seeds cut from each ChaCha20 call. The attempts are counted and the
+    // other workers' success noticed per block.
+    constexpr size_t SEEDS_PER_BLOCK = 16;
+
+    // Decode base58 `digits` into a right aligned big-endian value, false
+    // when it does not fit 32 bytes
+    bool decodeValue(const std::string &digits, uint8_t out[PUBLIC_KEY_LEN])
+    {
+        size_t len = 0;
+        if (Base58::decode(digits.data(), digits.size(), Span<uint8_t>(out, PUBLIC_KEY_LEN), len) != Base58Status::Ok)
+        {
+            return false;
+        }
+        std::memmove(out + PUBLIC_KEY_LEN - len, out, len);
+        std::memset(out, 0, PUBLIC_KEY_LEN - len);
+        return true;
+    }
+}
+
+KeypairGrinder::KeypairGrinder(const std::string &prefix, const std::string &suffix)
+    : KeypairGrinder(valueOrThrow<std::invalid_argument>(tryCreate(prefix, suffix)))
+{
+}
+
+Result<KeypairGrinder> KeypairGrinder::tryCreate(const std::string &prefix, const std::string &suffix)
+{
+    if (prefix.size() + suffix.size() > BASE58_ENCODED_32_MAX_LEN)
+    {
+        return Error("Pattern longer than an address");
+    }
+    if (prefix.find_first_not_of(ALPHABET_CHARS) != std::string::npos || suffix.find_first_not_of(ALPHABET_CHARS) != std::string::npos)
+    {
+        return Error("Invalid base58 character");
+    }
+
+    KeypairGrinder grinder;
+    grinder.prefix = prefix;
+    grinder.suffix = suffix;
+
+    // An address is one '1' per leading zero byte of the key followed by the
+    // digits of its value, which never start with a '1'
+    const size_t ones = std::min(prefix.find_first_not_of('1'), prefix.size());
+    const std::string digits = prefix.substr(ones);
+    if (ones > PUBLIC_KEY_LEN || (ones == PUBLIC_KEY_LEN && !digits.empty()))
+    {
+        return Error("No address starts with this prefix");
+    }
+
+    // The keys with exactly `ones` leading zero bytes, or at least as many
+    // when no digit follows
+    KeyRange zeros{};
+    std::fill(zeros.high + ones, zeros.high + PUBLIC_KEY_LEN, 0xff);
+    if (digits.empty())
+    {
+        grinder.prefixRanges.push_back(zeros);
+        return grinder;
+    }
+    zeros.low[ones] = 1;
+
+    // The values whose encoding is `digits` followed by j more digits run
+    // from `digits` and j '1's to `digits` and j 'z's. Only the few j whose
+    // range meets the keys above can match.
+    for (size_t j = 0; j <= BASE58_ENCODED_32_MAX_LEN; ++j)
+    {
+        KeyRange range;
+        if (!decodeValue(digits + std::string(j, '1'), range.low))
+        {
+            break;
+        }
+        if (!decodeValue(digits + std::string(j, 'z'), range.high))
+        {
+            std::fill(range.high, range.high + PUBLIC_KEY_LEN, 0xff);
+        }
+        if (std::memcmp(range.low, zeros.low, PUBLIC_KEY_LEN) < 0)
+        {
+            std::memcpy(range.low, zeros.low, PUBLIC_KEY_LEN);
+        }
+        if (std::memcmp(range.high, zeros.high, PUBLIC_KEY_LEN) > 0)
+        {
+            std::memcpy(range.high, zeros.high, PUBLIC_KEY_LEN);
+        }
+        if (std::memcmp(range.low, range.high, PUBLIC_KEY_LEN) <= 0)
+        {
+            grinder.prefixRanges.push_back(range);
+        }
+    }
+    if (grinder.prefixRanges.empty())
+    {
+        return Error("No address starts with this prefix");
+    }
+    return grinder;
+}
+
+GrindResult KeypairGrinder::grind(unsigned threads, uint64_t maxAttempts) const
+{
+    if (threads == 0)
+    {
+        threads = defaultWorkerCount();
+    }
+
+    std::atomic<bool> found{false};
+    std::atomic<uint64_t> claimed{0};
+    std::atomic<uint64_t> tested{0};
+    uint8_t foundSeed[SEED_LEN];
+
+    const auto start = std::chrono::steady_clock::now();
+    auto body = [&](unsigned)
+    {
+        uint8_t streamKey[crypto_stream_chacha20_KEYBYTES];
+        uint8_t nonce[crypto_stream_chacha20_NONCEBYTES] = {0};
+        uint8_t seeds[SEEDS_PER_BLOCK * SEED_LEN];
+        uint8_t publicKey[PUBLIC_KEY_LEN];
+        uint8_t secretKey[SECRET_KEY_LEN];
+        randombytes_buf(streamKey, sizeof(streamKey));
+
+        while (!found.load(std::memory_order_relaxed))
+        {
+            size_t count = SEEDS_PER_BLOCK;
+            if (maxAttempts != 0)
+            {
+                const uint64_t first = claimed.fetch_add(SEEDS_PER_BLOCK, std::memory_order_relaxed);
+                if (first >= maxAttempts)
+                {
+                    break;
+                }
+                count = static_cast<size_t>(std::min<uint64_t>(SEEDS_PER_BLOCK, maxAttempts - first));
+            }
+
+            // A fresh nonce per block, so no seed repeats
+            crypto_stream_chacha20(seeds, count * SEED_LEN, nonce, streamKey);
+            sodium_increment(nonce, sizeof(nonce));
+
+            size_t i = 0;
+            while (i < count)
+            {
+                const uint8_t *seed = seeds + i * SEED_LEN;
+                crypto_sign_ed25519_seed_keypair(publicKey, secretKey, seed);
+                ++i;
+                if (this->matchesKey(publicKey) && !found.exchange(true))
+                {
+                    std::memcpy(foundSeed, seed, SEED_LEN);
+                    break;
+                }
+            }
+            tested.fetch_add(i, std::memory_order_relaxed);
+        }
+
+        sodium_memzero(streamKey, sizeof(streamKey));
+        sodium_memzero(seeds, sizeof(seeds));
+        sodium_memzero(secretKey, sizeof(secretKey));
+    };
+    runWorkers(threads, body);
+
+    GrindResult result;
+    result.attempts = tested.load();
+    result.seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    if (found.load())
+    {
+        std::vector<unsigned char> seed(SECRET_KEY_LEN, 0);
+        std::copy(foundSeed, foundSeed + SEED_LEN, seed.begin());
+        result.keypair.emplace(seed);
+        sodium_memzero(seed.data(), seed.size());
+        sodium_memzero(foundSeed, sizeof(foundSeed));
+    }
+    return result;
+}
+
+bool KeypairGrinder::matches(const PublicKey &publicKey) const
+{
+    return this->matchesKey(publicKey.key);
+}
+
+bool KeypairGrinder::matchesKey(const uint8_t key[PUBLIC_KEY_LEN]) const
+{
+    bool inRange = false;
+    for (const KeyRange &range : this->prefixRanges)
+    {
+        if (std::memcmp(key, range.low, PUBLIC_KEY_LEN) >= 0 && std::memcmp(key, range.high, PUBLIC_KEY_LEN) <= 0)
+        {
+            inRange = true;
+            break;
+        }
+    }
+    if (!inRange || !this->suffixMatches(key))
+    {
+        return false;
+    }
+
+    // Confirmed on the full address, only the rare candidates get here
+    char address[BASE58_ENCODED_32_MAX_LEN + 1];
+    const size_t len = Base58::encode32(key, address);
+    return len >= this->prefix.size() + this->suffix.size() &&
+           std::memcmp(address, this->prefix.data(), this->prefix.size()) == 0 &&
+           std::memcmp(address + len - this->suffix.size(), this->suffix.data(), this->suffix.size()) == 0;
+}
+
+bool KeypairGrinder::suffixMatches(const uint8_t key[PUBLIC_KEY_LEN]) const
+{
+    constexpr size_t LIMBS = PUBLIC_KEY_LEN / 4;
+    uint32_t limbs[LIMBS];
+    for (size_t i = 0; i < LIMBS; ++i)
+    {
+        limbs[i] = (static_cast<uint32_t>(key[4 * i]) << 24) |
+                   (static_cast<uint32_t>(key[4 * i + 1]) << 16) |
+                   (static_cast<uint32_t>(key[4 * i + 2]) << 8) |
+                   static_cast<uint32_t>(key[4 * i + 3]);
+    }
+
+    // Produce the digits from the least significant, five per division of
+    // the limbs by 58^5, and stop at the first one that differs
+    size_t remaining = this->suffix.size();
+    while (remaining > 0)
+    {
+        uint64_t rem = 0;
+        for (size_t i = 0; i < LIMBS; ++i)
+        {
+            const uint64_t cur = (rem << 32) | limbs[i];
+            limbs[i] = static_cast<uint32_t>(cur / R5);
+            rem = cur % R5;
+        }
+
+        uint32_t r = static_cast<uint32_t>(rem);
+        for (size_t k = 0; k < 5 && remaining > 0; ++k)
+        {
+            if (ALPHABET_CHARS[r % R1] != this->suffix[--remaining])
+            {
+                return false;
+            }
+            r /= R1;
+        }
+    }
+    return true;
+}
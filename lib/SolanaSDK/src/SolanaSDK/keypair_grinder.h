@@ -0,0 +1,73 @@
+#ifndef KEYPAIR_GRINDER_H
+#define KEYPAIR_GRINDER_H
+
+#include <cstdint>
+#include <optional>
+#include <string>
+#include <vector>
+#include "keypair.h"
+#include "public_key.h"
+#include "result.h"
+
+// Outcome of KeypairGrinder::grind
+struct GrindResult
+{
+    // The first matching keypair, empty when the attempts ran out
+    std::optional<Keypair> keypair;
+
+    // Candidates tested by all workers together, and the wall time taken
+    uint64_t attempts = 0;
+    double seconds = 0;
+
+    double keysPerSecond() const { return seconds > 0 ? attempts / seconds : 0; }
+};
+
+// Searches for a keypair whose base58 address starts with a given prefix
+// and ends with a given suffix, on every core.
+//
+// Each worker expands a key from the system RNG into a ChaCha20 stream and
+// cuts it into seeds, so the RNG is read once per worker rather than once
+// per byte. No candidate is encoded in full: the addresses starting with
+// the prefix form at most a few ranges of key values, computed once, and
+// the suffix is checked by producing only the trailing base58 digits. The
+// cost per candidate is the seed to public key derivation.
+//
+// Every extra character multiplies the expected attempts by 58.
+class KeypairGrinder
+{
+public:
+    // Throws std::invalid_argument when the pattern cannot be matched, see
+    // tryCreate
+    KeypairGrinder(const std::string &prefix, const std::string &suffix = "");
+
+    // Fails on characters outside the base58 alphabet, a prefix and suffix
+    // together longer than an address, or a prefix no address starts with
+    static Result<KeypairGrinder> tryCreate(const std::string &prefix, const std::string &suffix = "");
+
+    // Test candidates on `threads` workers (0 uses every core) until one
+    // matches or, when maxAttempts is not 0, about maxAttempts were tested
+    GrindResult grind(unsigned threads = 0, uint64_t maxAttempts = 0) const;
+
+    // Whether the base58 address of `publicKey` matches
+    bool matches(const PublicKey &publicKey) const;
+
+private:
+    // Inclusive bounds of big-endian key values
+    struct KeyRange
+    {
+        uint8_t low[PUBLIC_KEY_LEN];
+        uint8_t high[PUBLIC_KEY_LEN];
+    };
+
+    KeypairGrinder() = default;
+
+    bool matchesKey(const uint8_t key[PUBLIC_KEY_LEN]) const;
+
+    bool suffixMatches(const uint8_t key[PUBLIC_KEY_LEN]) const;
+
+    std::string prefix;
+    std::string suffix;
+    std::vector<KeyRange> prefixRanges;
+};
+
+#endif // KEYPAIR_GRINDER_H
@@ -1,12 +1,13 @@
 #include <cstdint>
 #include <vector>
 #include <algorithm>
-#include <mutex>
 #include <list>
 #include <array>
 #include <iterator>
+#include <limits>
 #include <iostream>
 #include <sstream>
+#include <stdexcept>
 #include "public_key.h"
 #include "hash.h"
 #include "instruction.h"
@@ -17,65 +18,197 @@
 #include "programs/bpf_loader_deprecated.h"
 #include "programs/bpf_loader_upgradeable.h"
 #include "programs/system_program.h"
+#include "transaction_view.h"
+#include "result.h"
+
+constexpr std::array<PublicKey, 10> BUILTIN_PROGRAMS_KEYS = {
+    PublicKey::fromLiteral("Config1111111111111111111111111111111111111"),
+    PublicKey::fromLiteral("Feature111111111111111111111111111111111111"),
+    PublicKey::fromLiteral("NativeLoader1111111111111111111111111111111"),
+    PublicKey::fromLiteral("Stake11111111111111111111111111111111111111"),
+    PublicKey::fromLiteral("StakeConfig11111111111111111111111111111111"),
+    PublicKey::fromLiteral("Vote111111111111111111111111111111111111111"),
+    SystemProgram::ID,
+    BPFLoader::ID,
+    BPFLoaderDeprecated::ID,
+    BPFLoaderUpgradeable::ID,
+};
+
+// Builtin program and sysvar keys are looked up through a minimal perfect
+// hash generated at compile time: each key is reduced to a 64-bit value,
+// split into buckets, and every bucket gets a displacement that places its
+// keys into distinct slots of a table with exactly one slot per key. A lookup
+// is a fixed sequence of loads, multiplies and one 32 byte comparison.
+constexpr size_t BUILTIN_KEY_COUNT = BUILTIN_PROGRAMS_KEYS.size() + sysvar::ALL_IDS.size();
+constexpr size_t BUILTIN_KEY_BUCKETS = 8;
+constexpr uint32_t BUILTIN_KEY_MAX_DISPLACEMENT = 1u << 16;
+
+struct BuiltinKeyTable
+{
+  std::array<uint32_t, BUILTIN_KEY_BUCKETS> displacements;
+  std::array<std::array<uint64_t, 4>, BUILTIN_KEY_COUNT> words;
+};
 
-std::array<PublicKey, 10> BUILTIN_PROGRAMS_KEYS;
-std::array<bool, 256> MAYBE_BUILTIN_KEY_OR_SYSVAR;
-
-void initialize()
-{
-  static std::once_flag flag;
-  std::call_once(flag, []
-                 {
-        BUILTIN_PROGRAMS_KEYS = {
-            PublicKey::fromString("Config1111111111111111111111111111111111111").value(),
-            PublicKey::fromString("Feature111111111111111111111111111111111111").value(),
-            PublicKey::fromString("NativeLoader1111111111111111111111111111111").value(),
-            PublicKey::fromString("Stake11111111111111111111111111111111111111").value(),
-            PublicKey::fromString("StakeConfig11111111111111111111111111111111").value(),
-            PublicKey::fromString("Vote111111111111111111111111111111111111111").value(),
-            SystemProgram::id(),
-            BPFLoader::id(),
-            BPFLoaderDeprecated::id(),
-            BPFLoaderUpgradeable::id()
-        };
-
-        for (const auto& key : BUILTIN_PROGRAMS_KEYS) {
-            MAYBE_BUILTIN_KEY_OR_SYSVAR[key[0]] = true;
-        }
+// Not constexpr on purpose: reaching it while building the table turns a
+// failed search into a compile error
+void builtinKeyTableNotFound()
+{
+  SOLANA_THROW(std::logic_error("No perfect hash found for the builtin keys"));
+}
 
-        for (const auto& key : sysvar::ALL_IDS) {
-            MAYBE_BUILTIN_KEY_OR_SYSVAR[key[0]] = true;
-        } });
+// Little endian load, written out so the compiler folds it into a single
+// 64-bit load on the targets we care about
+constexpr uint64_t loadWord(const unsigned char *bytes, size_t index)
+{
+  const unsigned char *p = bytes + index * 8;
+  return static_cast<uint64_t>(p[0]) | static_cast<uint64_t>(p[1]) << 8 |
+         static_cast<uint64_t>(p[2]) << 16 | static_cast<uint64_t>(p[3]) << 24 |
+         static_cast<uint64_t>(p[4]) << 32 | static_cast<uint64_t>(p[5]) << 40 |
+         static_cast<uint64_t>(p[6]) << 48 | static_cast<uint64_t>(p[7]) << 56;
 }
 
-bool isBuiltinKeyOrSysvar(const PublicKey &key)
+constexpr uint64_t mixWord(uint64_t x)
+{
+  x ^= x >> 33;
+  x *= 0xff51afd7ed558ccdULL;
+  x ^= x >> 33;
+  x *= 0xc4ceb9fe1a85ec53ULL;
+  x ^= x >> 33;
+  return x;
+}
+
+// Keys sharing a prefix (the "Sysvar..." family) differ mostly in their
+// low order bytes, so both ends of the key feed the hash
+constexpr uint64_t builtinKeyHash(const std::array<uint64_t, 4> &words)
+{
+  return mixWord(words[0] ^ (words[3] << 32 | words[3] >> 32));
+}
+
+constexpr size_t builtinKeyBucket(uint64_t hash)
+{
+  return static_cast<size_t>(hash >> 61) & (BUILTIN_KEY_BUCKETS - 1);
+}
+
+constexpr size_t builtinKeySlot(uint64_t hash, uint32_t displacement)
 {
-  initialize();
+  uint64_t mixed = (hash ^ displacement) * 0x9e3779b97f4a7c15ULL;
+  return static_cast<size_t>((mixed >> 32) * BUILTIN_KEY_COUNT >> 32);
+}
 
-  if (MAYBE_BUILTIN_KEY_OR_SYSVAR[key[0]])
+constexpr BuiltinKeyTable makeBuiltinKeyTable()
+{
+  std::array<std::array<uint64_t, 4>, BUILTIN_KEY_COUNT> keyWords{};
+  std::array<uint64_t, BUILTIN_KEY_COUNT> hashes{};
+  std::array<size_t, BUILTIN_KEY_COUNT> buckets{};
+  std::array<size_t, BUILTIN_KEY_BUCKETS> bucketSizes{};
+  for (size_t i = 0; i < BUILTIN_KEY_COUNT; ++i)
   {
-    return sysvar::isSysvarId(key) || std::find(BUILTIN_PROGRAMS_KEYS.begin(), BUILTIN_PROGRAMS_KEYS.end(), key) != BUILTIN_PROGRAMS_KEYS.end();
-    return true;
+    const PublicKey &key = i < BUILTIN_PROGRAMS_KEYS.size() ? BUILTIN_PROGRAMS_KEYS[i] : sysvar::ALL_IDS[i - BUILTIN_PROGRAMS_KEYS.size()];
+    for (size_t w = 0; w < 4; ++w)
+    {
+      keyWords[i][w] = loadWord(key.key, w);
+    }
+    hashes[i] = builtinKeyHash(keyWords[i]);
+    buckets[i] = builtinKeyBucket(hashes[i]);
+    ++bucketSizes[buckets[i]];
   }
 
-  return false;
+  BuiltinKeyTable table{};
+  std::array<bool, BUILTIN_KEY_COUNT> occupied{};
+  std::array<bool, BUILTIN_KEY_BUCKETS> placed{};
+
+  // Place the largest buckets first while the table is still empty
+  for (size_t round = 0; round < BUILTIN_KEY_BUCKETS; ++round)
+  {
+    size_t bucket = 0;
+    size_t largest = 0;
+    for (size_t b = 0; b < BUILTIN_KEY_BUCKETS; ++b)
+    {
+      if (!placed[b] && bucketSizes[b] >= largest)
+      {
+        bucket = b;
+        largest = bucketSizes[b];
+      }
+    }
+    placed[bucket] = true;
+    if (largest == 0)
+    {
+      continue;
+    }
+
+    uint32_t displacement = 0;
+    for (; displacement < BUILTIN_KEY_MAX_DISPLACEMENT; ++displacement)
+    {
+      std::array<bool, BUILTIN_KEY_COUNT> taken = occupied;
+      bool fits = true;
+      for (size_t i = 0; i < BUILTIN_KEY_COUNT && fits; ++i)
+      {
+        if (buckets[i] != bucket)
+        {
+          continue;
+        }
+        size_t slot = builtinKeySlot(hashes[i], displacement);
+        fits = !taken[slot];
+        taken[slot] = true;
+      }
+      if (fits)
+      {
+        occupied = taken;
+        break;
+      }
+    }
+    if (displacement == BUILTIN_KEY_MAX_DISPLACEMENT)
+    {
+      builtinKeyTableNotFound();
+    }
+
+    table.displacements[bucket] = displacement;
+    for (size_t i = 0; i < BUILTIN_KEY_COUNT; ++i)
+    {
+      if (buckets[i] == bucket)
+      {
+        table.words[builtinKeySlot(hashes[i], displacement)] = keyWords[i];
+      }
+    }
+  }
+  return table;
+}
+
+constexpr BuiltinKeyTable BUILTIN_KEY_TABLE = makeBuiltinKeyTable();
+
+bool isBuiltinKeyOrSysvar(const PublicKey &key)
+{
+  const std::array<uint64_t, 4> words = {loadWord(key.key, 0), loadWord(key.key, 1), loadWord(key.key, 2), loadWord(key.key, 3)};
+  uint64_t hash = builtinKeyHash(words);
+  size_t slot = builtinKeySlot(hash, BUILTIN_KEY_TABLE.displacements[builtinKeyBucket(hash)]);
+  const std::array<uint64_t, 4> &candidate = BUILTIN_KEY_TABLE.words[slot];
+  return ((words[0] ^ candidate[0]) | (words[1] ^ candidate[1]) | (words[2] ^ candidate[2]) | (words[3] ^ candidate[3])) == 0;
 }
 
 void Message::sanitize()
+{
+  valueOrThrow<std::out_of_range>(this->trySanitize());
+}
+
+Result<void> Message::trySanitize()
 {
   // signing area and read--only on-signing area should no overlap
   if (this->header.numRequiredSignatures + this->header.numReadonlyUnsignedAccounts > this->accountKeys.size())
   {
-    throw std::out_of_range("Number of required signatures plus read-only unsigned accounts exceeds total number of account keys");
+    return Error("Number of required signatures plus read-only unsigned accounts exceeds total number of account keys");
   }
 
   // there should be at least 1 RW fee-payer account
   if (this->header.numReadonlySignedAccounts >= this->header.numRequiredSignatures)
   {
-    throw std::out_of_range("Need at least 1 read-only signed account");
+    return Error("Need at least 1 read-only signed account");
   }
 
   // Check address lookup tables
+  if (!this->versioned && !this->addressTableLookups.empty())
+  {
+    return Error("Address table lookups in a legacy message");
+  }
   size_t totalAccountKeys = this->accountKeys.size();
   size_t maxAccountIndex = totalAccountKeys > 0 ? totalAccountKeys - 1 : 0;
 
@@ -84,13 +217,13 @@ void Message::sanitize()
     size_t numLookupIndexes = lookup.writableIndexes.size() + lookup.readonlyIndexes.size();
     if (numLookupIndexes == 0)
     {
-      throw std::out_of_range("Each lookup table must be used to load at least one account");
+      return Error("Each lookup table must be used to load at least one account");
     }
 
     totalAccountKeys += numLookupIndexes;
     if (totalAccountKeys > 256)
     {
-      throw std::out_of_range("The combined number of static and dynamic account keys must be <= 256");
+      return Error("The combined number of static and dynamic account keys must be <= 256");
     }
 
     size_t maxAccountIndexLookup = totalAccountKeys > 0 ? totalAccountKeys - 1 : 0;
@@ -99,7 +232,7 @@ void Message::sanitize()
     {
       if (ai > maxAccountIndexLookup)
       {
-        throw std::out_of_range("Writable index out of bounds");
+        return Error("Writable index out of bounds");
       }
     }
 
@@ -107,7 +240,7 @@ void Message::sanitize()
     {
       if (ai > maxAccountIndexLookup)
       {
-        throw std::out_of_range("Read-only index out of bounds");
+        return Error("Read-only index out of bounds");
       }
     }
   }
@@ -116,20 +249,20 @@ void Message::sanitize()
   {
     if (ci.programIdIndex >= this->accountKeys.size())
     {
-      throw std::out_of_range("Invalid program id index");
+      return Error("Invalid program id index");
     }
 
     // A program cannot be a payer
     if (ci.programIdIndex == 0)
     {
-      throw std::out_of_range("Program cannot be a payer");
+      return Error("Program cannot be a payer");
     }
 
     for (const auto &ai : ci.accounts)
     {
       if (ai >= this->accountKeys.size())
       {
-        throw std::out_of_range("Invalid account keys size");
+        return Error("Invalid account keys size");
       }
     }
   }
@@ -145,10 +278,15 @@ void Message::sanitize()
   {
     ix.sanitize();
   }
+
+  return {};
 }
 
+Message::Message(MemoryResource *resource)
+    : header(), accountKeys(resource), recentBlockhash(), instructions(resource), addressTableLookups(resource) {}
+
 Message::Message(MessageHeader header, std::vector<PublicKey> accountKeys, Hash recentBlockhash, std::vector<CompiledInstruction> instructions)
-    : header(header), accountKeys(accountKeys), recentBlockhash(recentBlockhash), instructions(instructions) {}
+    : header(header), accountKeys(accountKeys.begin(), accountKeys.end()), recentBlockhash(recentBlockhash), instructions(instructions.begin(), instructions.end()) {}
 
 Message::Message(std::vector<Instruction> instructions, std::optional<PublicKey> payer)
 {
@@ -165,22 +303,53 @@ Message Message::newWithNonce(
   return Message(instructions, payer);
 }
 
-Message Message::newWithBlockhash(std::vector<Instruction> instructions, std::optional<PublicKey> payer, Hash blockhash)
+Message Message::newWithBlockhash(const std::vector<Instruction> &instructions, std::optional<PublicKey> payer, Hash blockhash, MemoryResource *resource)
 {
-  CompiledKeys compiledKeys = CompiledKeys::compile(instructions, payer);
-  MessageHeader header;
-  std::vector<PublicKey> accountKeys;
-  std::tie(header, accountKeys) = compiledKeys.tryIntoMessageComponents();
+  CompiledKeys compiledKeys = CompiledKeys::compile(instructions, payer, resource);
+  Message message(resource);
+  std::tie(message.header, message.accountKeys) = valueOrThrow<CompileError>(compiledKeys.tryIntoMessageComponents());
+  message.recentBlockhash = blockhash;
+  message.instructions = compileInstructions(instructions, compiledKeys.keyIndex, resource);
+  return message;
+}
 
-  std::vector<CompiledInstruction> ixs = compileInstructions(instructions, accountKeys);
+Result<Message> Message::tryCompileV0(
+    const std::vector<Instruction> &instructions,
+    const PublicKey &payer,
+    const std::vector<AddressLookupTableAccount> &lookupTables,
+    const Hash &recentBlockhash,
+    MemoryResource *resource)
+{
+  CompiledKeys compiledKeys = CompiledKeys::compile(instructions, payer, resource);
 
-  return Message::newWithCompiledInstructions(
-      header.numRequiredSignatures,
-      header.numReadonlySignedAccounts,
-      header.numReadonlyUnsignedAccounts,
-      accountKeys,
-      blockhash,
-      ixs);
+  std::vector<PublicKey> loadedWritable;
+  std::vector<PublicKey> loadedReadonly;
+  std::vector<AddressLookupTable> lookups = compiledKeys.extractTableLookups(lookupTables, loadedWritable, loadedReadonly);
+
+  Result<std::pair<MessageHeader, ArenaVector<PublicKey>>> components = compiledKeys.tryIntoMessageComponents();
+  if (!components)
+  {
+    return components.error();
+  }
+
+  // Instructions index the static keys followed by the loaded ones, which
+  // tryIntoMessageComponents checked to be at most 256
+  Message message(resource);
+  std::tie(message.header, message.accountKeys) = std::move(components.value());
+  message.recentBlockhash = recentBlockhash;
+  message.instructions = compileInstructions(instructions, compiledKeys.keyIndex, resource);
+  message.addressTableLookups.assign(std::make_move_iterator(lookups.begin()), std::make_move_iterator(lookups.end()));
+  return message;
+}
+
+Message Message::compileV0(
+    const std::vector<Instruction> &instructions,
+    const PublicKey &payer,
+    const std::vector<AddressLookupTableAccount> &lookupTables,
+    const Hash &recentBlockhash,
+    MemoryResource *resource)
+{
+  return valueOrThrow<CompileError>(tryCompileV0(instructions, payer, lookupTables, recentBlockhash, resource));
 }
 
 Message Message::newWithCompiledInstructions(
@@ -344,114 +513,101 @@ bool Message::isUpgradeableLoaderPresent()
                      { return key == BPFLoaderUpgradeable::id(); });
 }
 
-Hash Message::hashRawMessage(std::vector<uint8_t> messageBytes)
+Hash Message::hashRawMessage(const std::vector<uint8_t> &messageBytes)
 {
-  Hash hash = Hash();
-  std::array<uint8_t, 32> messageArr;
-  std::copy(messageBytes.data(), messageBytes.data() + 32, messageArr.begin());
-  return hash.newFromArray(messageArr);
+  return hashBytes(messageBytes.data(), messageBytes.size());
+}
+
+Hash Message::hash() const
+{
+  Hasher hasher;
+  this->serialize(hasher);
+  return hasher.result();
 }
 
 // Serialize method for Message
-std::vector<uint8_t> Message::serialize()
+std::vector<uint8_t> Message::serialize() const
 {
   std::vector<uint8_t> result;
+  result.reserve(this->serializedSize());
+  VectorSink sink(result);
+  this->serialize(sink);
+  return result;
+}
 
+void Message::serialize(ByteSink &sink) const
+{
   // Set transaction version byte
-  // Adding support for just versioned transactions
   const uint8_t firstBit = 128;
-  // TODO: get the transaction version on more standardized way
-  result.push_back(firstBit);
+  if (this->versioned)
+  {
+    sink.write(firstBit);
+  }
 
   // Serialize header
-  result.push_back(header.numRequiredSignatures);
-  result.push_back(header.numReadonlySignedAccounts);
-  result.push_back(header.numReadonlyUnsignedAccounts);
-
-  // Serialize number of accounts
-  uint8_t numAccounts = static_cast<uint8_t>(accountKeys.size());
-  result.push_back(numAccounts);
+  sink.write(header.numRequiredSignatures);
+  sink.write(header.numReadonlySignedAccounts);
+  sink.write(header.numReadonlyUnsignedAccounts);
 
   // Serialize accountKeys
-  for (auto publicKey : accountKeys)
+  sink.writeLength(accountKeys.size());
+  for (const auto &publicKey : accountKeys)
   {
-    result.insert(result.end(), publicKey.key, publicKey.key + PUBLIC_KEY_LEN);
+    sink.write(publicKey.key, PUBLIC_KEY_LEN);
   }
 
   // Serialize recentBlockhash
-  auto recentBlockhashBytes = this->recentBlockhash.serialize();
-  result.insert(result.end(), recentBlockhashBytes.begin(), recentBlockhashBytes.end());
-
-  // Serialize number of instructions
-  uint8_t numInstructions = static_cast<uint8_t>(instructions.size());
-  result.push_back(numInstructions);
+  sink.write(recentBlockhash.data.data(), HASH_BYTES);
 
   // Serialize instructions
-  for (auto instruction : instructions)
+  sink.writeLength(instructions.size());
+  for (const auto &instruction : instructions)
   {
-    auto instructionBytes = instruction.serialize();
-    result.insert(result.end(), instructionBytes.begin(), instructionBytes.end());
+    instruction.serialize(sink);
   }
 
-  // Serialize number of address table
-  uint8_t numAddressTableLookups = static_cast<uint8_t>(addressTableLookups.size());
-  result.push_back(numAddressTableLookups);
-
-  for (auto addressTableLookup : addressTableLookups)
+  // Serialize address table lookups, which legacy messages do not have
+  if (!this->versioned)
   {
-    auto addressTableLookupBytes = addressTableLookup.serialize();
-    result.insert(result.end(), addressTableLookupBytes.begin(), addressTableLookupBytes.end());
+    return;
+  }
+  sink.writeLength(addressTableLookups.size());
+  for (const auto &addressTableLookup : addressTableLookups)
+  {
+    addressTableLookup.serialize(sink);
   }
-
-  return result;
 }
 
-// Deserialize method for Message
-Message Message::deserialize(const std::vector<uint8_t> &input)
+size_t Message::serializedSize() const
 {
-  Message message;
-  std::vector<uint8_t>::const_iterator it = input.begin();
-
-  // Deserialize header
-  message.header.numRequiredSignatures = *it++;
-  message.header.numReadonlySignedAccounts = *it++;
-  message.header.numReadonlyUnsignedAccounts = *it++;
-
-  // Deserialize accountKeys
-  while (it != input.end())
+  // Version prefix and header
+  size_t size = this->versioned ? 4 : 3;
+  size += shortVecSize(accountKeys.size(), PUBLIC_KEY_LEN);
+  size += HASH_BYTES;
+  size += shortVecSize(instructions.size(), 0);
+  for (const auto &instruction : instructions)
   {
-    auto keyBytes = std::vector<uint8_t>(it, it + sizeof(PublicKey));
-    PublicKey key = PublicKey::deserialize(keyBytes);
-    message.accountKeys.push_back(key);
-    it += sizeof(PublicKey);
+    size += instruction.serializedSize();
   }
-
-  // Deserialize recentBlockhash
-  auto recentBlockhashBytes = std::vector<uint8_t>(it, it + sizeof(Hash));
-  message.recentBlockhash = Hash::deserialize(recentBlockhashBytes);
-  it += sizeof(Hash);
-
-  // Deserialize instructions
-  while (it != input.end())
+  if (!this->versioned)
   {
-    // Extract the necessary parameters for CompiledInstruction::deserialize
-    uint8_t programIdIndex = *it++;
-    std::vector<uint8_t> accounts;
-    while (it != input.end() && *it != 0)
-    {
-      accounts.push_back(*it++);
-    }
-    // Skip the zero byte separator
-    if (it != input.end())
-    {
-      ++it;
-    }
-    std::vector<uint8_t> data(it, input.end());
-
-    CompiledInstruction instruction = CompiledInstruction::deserialize(programIdIndex, accounts, data, input);
-    message.instructions.push_back(instruction);
-    it += sizeof(CompiledInstruction);
+    return size;
   }
+  size += shortVecSize(addressTableLookups.size(), 0);
+  for (const auto &addressTableLookup : addressTableLookups)
+  {
+    size += addressTableLookup.serializedSize();
+  }
+  return size;
+}
 
-  return message;
+Result<size_t> Message::serializeInto(Span<uint8_t> out) const
+{
+  return serializeToSpan(*this, out);
+}
+
+// Deserialize method for Message
+Message Message::deserialize(const std::vector<uint8_t> &input)
+{
+  return valueOrThrow<std::invalid_argument>(MessageView::parse(input)).toMessage();
 }
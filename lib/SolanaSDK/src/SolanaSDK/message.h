@@ -8,6 +8,9 @@
 #include "hash.h"
 #include "instruction.h"
 #include "address_lookup_table.h"
+#include "byte_sink.h"
+#include "result.h"
+#include "arena.h"
 
 struct MessageHeader
 {
@@ -23,26 +26,39 @@ public:
   MessageHeader header;
 
   // All the account keys used by the transaction
-  std::vector<PublicKey> accountKeys;
+  ArenaVector<PublicKey> accountKeys;
 
   // The id of a recent ledger entry
   Hash recentBlockhash;
 
   // Programs the will be executed in sequence and committed in
   // one atomic transaction if all succeed
-  std::vector<CompiledInstruction> instructions;
+  ArenaVector<CompiledInstruction> instructions;
 
-  std::vector<AddressLookupTable> addressTableLookups;
+  ArenaVector<AddressLookupTable> addressTableLookups;
+
+  // Whether the message is written as v0, with the version prefix and the
+  // address table lookups. Compiled messages are; a deserialized legacy
+  // message keeps the legacy layout, so its bytes round trip.
+  bool versioned = true;
 
   void sanitize();
 
+  // As sanitize, returning the first violation instead of throwing
+  Result<void> trySanitize();
+
   Message() = default;
 
+  // Empty message whose vectors allocate from `resource`
+  explicit Message(MemoryResource *resource);
+
   Message(MessageHeader header, std::vector<PublicKey> accountKeys, Hash recentBlockhash, std::vector<CompiledInstruction> instructions);
 
   Message(std::vector<Instruction> instructions, std::optional<PublicKey> payer);
 
-  static Message newWithBlockhash(std::vector<Instruction> instructions, std::optional<PublicKey> payer, Hash blockhash);
+  // Compile a legacy message. Everything it allocates, temporaries
+  // included, comes from `resource`.
+  static Message newWithBlockhash(const std::vector<Instruction> &instructions, std::optional<PublicKey> payer, Hash blockhash, MemoryResource *resource = heapResource());
 
   Message newWithNonce(
       std::vector<Instruction> instructions,
@@ -50,6 +66,24 @@ public:
       PublicKey &nonceAccountPublicKey,
       PublicKey &nonceAuthorityPublicKey);
 
+  // Compile a v0 message whose accounts that are neither signers nor
+  // invoked programs are loaded from `lookupTables` where that makes the
+  // message smaller. Fails with "AccountIndexOverflow" past 256 accounts.
+  static Result<Message> tryCompileV0(
+      const std::vector<Instruction> &instructions,
+      const PublicKey &payer,
+      const std::vector<AddressLookupTableAccount> &lookupTables,
+      const Hash &recentBlockhash,
+      MemoryResource *resource = heapResource());
+
+  // As tryCompileV0, throwing CompileError
+  static Message compileV0(
+      const std::vector<Instruction> &instructions,
+      const PublicKey &payer,
+      const std::vector<AddressLookupTableAccount> &lookupTables,
+      const Hash &recentBlockhash,
+      MemoryResource *resource = heapResource());
+
   static Message newWithCompiledInstructions(
       uint8_t numRequiredSignatures,
       uint8_t numReadonlySignedAccounts,
@@ -88,9 +122,22 @@ public:
 
   bool isUpgradeableLoaderPresent();
 
-  static Hash hashRawMessage(std::vector<uint8_t> messageBytes);
+  // SHA-256 of serialized message bytes
+  static Hash hashRawMessage(const std::vector<uint8_t> &messageBytes);
+
+  // Hash of the serialized message, computed while serializing
+  Hash hash() const;
+
+  std::vector<uint8_t> serialize() const;
+
+  // Write the serialized message into `sink`
+  void serialize(ByteSink &sink) const;
+
+  // Exact length of the serialized message
+  size_t serializedSize() const;
 
-  std::vector<uint8_t> serialize();
+  // Serialize into `out`, returns the number of bytes written
+  Result<size_t> serializeInto(Span<uint8_t> out) const;
 
   static Message deserialize(const std::vector<uint8_t> &input);
 };
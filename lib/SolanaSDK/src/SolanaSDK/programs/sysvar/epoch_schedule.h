@@ -1,24 +1,16 @@
 #ifndef EPOCH_SCHEDULE_H
 #define EPOCH_SCHEDULE_H
 
-#include <optional>
 #include "SolanaSDK/public_key.h"
 
 class EpochSchedule
 {
 public:
-  static PublicKey id()
-  {
-    // std::optional<PublicKey> pubkey = PublicKey::fromString("SysvarEpochSchedu1e111111111111111111111111");
+  static constexpr PublicKey ID = PublicKey::fromLiteral("SysvarEpochSchedu1e111111111111111111111111");
 
-    // if (pubkey.has_value())
-    // {
-    //   return pubkey.value();
-    // }
-    // else
-    // {
-    // }
-    return PublicKey();
+  static constexpr PublicKey id()
+  {
+    return ID;
   }
 };
 
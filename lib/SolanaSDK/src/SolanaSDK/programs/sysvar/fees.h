@@ -0,0 +1,17 @@
+#ifndef FEES_H
+#define FEES_H
+
+#include "SolanaSDK/public_key.h"
+
+class Fees
+{
+public:
+  static constexpr PublicKey ID = PublicKey::fromLiteral("SysvarFees111111111111111111111111111111111");
+
+  static constexpr PublicKey id()
+  {
+    return ID;
+  }
+};
+
+#endif // FEES_H
\ No newline at end of file
@@ -1,24 +1,16 @@
 #ifndef INSTRUCTION_H
 #define INSTRUCTION_H
 
-#include <optional>
 #include "SolanaSDK/public_key.h"
 
 class Instructions
 {
 public:
-  static PublicKey id()
-  {
-    // std::optional<PublicKey> pubkey = PublicKey::fromString("Sysvar1nstructions1111111111111111111111111");
+  static constexpr PublicKey ID = PublicKey::fromLiteral("Sysvar1nstructions1111111111111111111111111");
 
-    // if (pubkey.has_value())
-    // {
-    //   return pubkey.value();
-    // }
-    // else
-    // {
-    // }
-    return PublicKey();
+  static constexpr PublicKey id()
+  {
+    return ID;
   }
 };
 
@@ -1,24 +1,16 @@
 #ifndef RECENT_BLOCKHASHES_H
 #define RECENT_BLOCKHASHES_H
 
-#include <optional>
 #include "SolanaSDK/public_key.h"
 
 class RecentBlockhashes
 {
 public:
-  static PublicKey id()
-  {
-    // std::optional<PublicKey> pubkey = PublicKey::fromString("SysvarRecentB1ockHashes11111111111111111111");
+  static constexpr PublicKey ID = PublicKey::fromLiteral("SysvarRecentB1ockHashes11111111111111111111");
 
-    // if (pubkey.has_value())
-    // {
-    //   return pubkey.value();
-    // }
-    // else
-    // {
-    // }
-    return PublicKey();
+  static constexpr PublicKey id()
+  {
+    return ID;
   }
 };
 
@@ -1,24 +1,16 @@
 #ifndef REWARDS_H
 #define REWARDS_H
 
-#include <optional>
 #include "SolanaSDK/public_key.h"
 
 class Rewards
 {
 public:
-  static PublicKey id()
-  {
-    // std::optional<PublicKey> pubkey = PublicKey::fromString("SysvarRewards111111111111111111111111111111");
+  static constexpr PublicKey ID = PublicKey::fromLiteral("SysvarRewards111111111111111111111111111111");
 
-    // if (pubkey.has_value())
-    // {
-    //   return pubkey.value();
-    // }
-    // else
-    // {
-    // }
-    return PublicKey();
+  static constexpr PublicKey id()
+  {
+    return ID;
   }
 };
 
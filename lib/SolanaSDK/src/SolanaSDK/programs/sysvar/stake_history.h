@@ -1,24 +1,16 @@
 #ifndef STAKE_HISTORY
 #define STAKE_HISTORY
 
-#include <optional>
 #include "SolanaSDK/public_key.h"
 
 class StakeHistory
 {
 public:
-  static PublicKey id()
-  {
-    // std::optional<PublicKey> pubkey = PublicKey::fromString("SysvarStakeHistory1111111111111111111111111");
+  static constexpr PublicKey ID = PublicKey::fromLiteral("SysvarStakeHistory1111111111111111111111111");
 
-    // if (pubkey.has_value())
-    // {
-    //   return pubkey.value();
-    // }
-    // else
-    // {
-    // }
-    return PublicKey();
+  static constexpr PublicKey id()
+  {
+    return ID;
   }
 };
 
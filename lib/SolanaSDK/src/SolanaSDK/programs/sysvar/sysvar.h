@@ -8,6 +8,7 @@
 #include "SolanaSDK/public_key.h"
 #include "clock.h"
 #include "epoch_schedule.h"
+#include "fees.h"
 #include "instructions.h"
 #include "recent_blockhashes.h"
 #include "rent.h"
@@ -20,6 +21,7 @@ namespace sysvar
 {
   using ::Clock;
   using ::EpochSchedule;
+  using ::Fees;
   using ::Instructions;
   using ::RecentBlockhashes;
   using ::Rent;
@@ -28,17 +30,17 @@ namespace sysvar
   using ::SlotHistory;
   using ::StakeHistory;
 
-  const std::vector<PublicKey> ALL_IDS = {
-      sysvar::Clock::id(),
-      sysvar::EpochSchedule::id(),
-      sysvar::Instructions::id(),
-      sysvar::Rent::id(),
-      sysvar::RecentBlockhashes::id(),
-      sysvar::Rent::id(),
-      sysvar::Rewards::id(),
-      sysvar::SlotHashes::id(),
-      sysvar::SlotHistory::id(),
-      sysvar::StakeHistory::id(),
+  constexpr std::array<PublicKey, 10> ALL_IDS = {
+      sysvar::Clock::ID,
+      sysvar::EpochSchedule::ID,
+      sysvar::Fees::ID,
+      sysvar::Instructions::ID,
+      sysvar::RecentBlockhashes::ID,
+      sysvar::Rent::ID,
+      sysvar::Rewards::ID,
+      sysvar::SlotHashes::ID,
+      sysvar::SlotHistory::ID,
+      sysvar::StakeHistory::ID,
   };
 
   static bool isSysvarId(const PublicKey &id)
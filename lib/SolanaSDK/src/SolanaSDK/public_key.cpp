@@ -1,72 +1,212 @@
 #include <string>
 #include <optional>
+#include <algorithm>
 #include <ArduinoJson.h>
 #include "public_key.h"
 #include "base58.h"
-
-PublicKey::PublicKey()
-{
-  std::fill(key, key + PUBLIC_KEY_LEN, 0);
-}
+#include "sha256.h"
+#include "edwards25519.h"
+#include "result.h"
+#include "worker_pool.h"
 
 PublicKey::PublicKey(const unsigned char value[PUBLIC_KEY_LEN])
 {
-  // Find the first non-1 value
-  auto firstNonOne = std::find_if(value, value + PUBLIC_KEY_LEN,
-                                  [](int i)
-                                  { return i != 1; });
-
-  // Copy the rest of the array
-  std::copy(firstNonOne, value + PUBLIC_KEY_LEN, this->key);
+  // Raw key bytes, a leading 0x01 is part of the key and not a base58 '1'
+  std::copy(value, value + PUBLIC_KEY_LEN, this->key);
 }
 
 PublicKey::PublicKey(const std::vector<uint8_t> &value)
 {
-  auto firstNonOne = std::find_if(value.begin(), value.end(),
-                                  [](uint8_t i)
-                                  { return i != 1; });
-
-  std::copy(firstNonOne, value.end(), this->key);
+  if (value.size() != PUBLIC_KEY_LEN)
+  {
+    SOLANA_THROW(ParsePubkeyError("WrongSize"));
+  }
+  std::copy(value.begin(), value.end(), this->key);
 }
 
 std::string PublicKey::toBase58()
 {
-  std::vector<uint8_t> keyVector(this->key, this->key + PUBLIC_KEY_LEN);
-  // TODO: wrong size check this
-  return Base58::trimEncode(keyVector);
+  return Base58::encode32(this->key);
+}
+
+size_t PublicKey::toBase58(char out[PUBLIC_KEY_MAX_BASE58_LEN + 1]) const
+{
+  return Base58::encode32(this->key, out);
 }
 
 void PublicKey::sanitize() {}
 
 std::optional<PublicKey> PublicKey::fromString(const std::string &s)
 {
-  if (s.length() != PUBLIC_KEY_LEN && s.length() != PUBLIC_KEY_MAX_BASE58_LEN)
+  return valueOrThrow<ParsePubkeyError>(tryFromString(s));
+}
+
+Result<PublicKey> PublicKey::tryFromString(const std::string &s)
+{
+  if (s.length() > PUBLIC_KEY_MAX_BASE58_LEN)
+  {
+    return Error("WrongSize");
+  }
+  PublicKey publicKey;
+  if (!Base58::decode32(s.data(), s.length(), publicKey.key))
   {
-    throw ParsePubkeyError("WrongSize");
+    return Error("Invalid");
   }
-  std::vector<unsigned char> publicKeyVec;
-  try
+  return publicKey;
+}
+
+size_t PublicKey::fromStrings(const std::string *strs, size_t count, PublicKey *out, uint8_t *validBitmap)
+{
+  static_assert(sizeof(PublicKey) == PUBLIC_KEY_LEN, "PublicKey arrays must be contiguous key bytes");
+
+  // Hand the strings to the batch decoder in fixed size chunks so no
+  // pointer/length arrays have to be allocated
+  constexpr size_t CHUNK = 64;
+  const char *chunkStrs[CHUNK];
+  size_t chunkLens[CHUNK];
+  uint8_t chunkBitmap[CHUNK / 8];
+
+  std::fill(validBitmap, validBitmap + (count + 7) / 8, 0);
+  size_t validCount = 0;
+  for (size_t i = 0; i < count; i += CHUNK)
   {
-    std::vector<uint8_t> intVec;
-    if (s.length() == PUBLIC_KEY_MAX_BASE58_LEN)
+    size_t n = std::min(CHUNK, count - i);
+    for (size_t j = 0; j < n; ++j)
     {
-      intVec = Base58::decode(s);
+      chunkStrs[j] = strs[i + j].data();
+      chunkLens[j] = strs[i + j].size();
     }
-    else
+    validCount += Base58::decode32Batch(chunkStrs, chunkLens, n, out[i].key, chunkBitmap);
+    for (size_t j = 0; j < (n + 7) / 8; ++j)
     {
-      intVec = Base58::decode(s);
+      validBitmap[i / 8 + j] = chunkBitmap[j];
     }
-    publicKeyVec = std::vector<unsigned char>(intVec.begin(), intVec.end());
   }
-  catch (...)
+  return validCount;
+}
+
+size_t PublicKey::fromStrings(const std::vector<std::string> &strs, PublicKey *out, uint8_t *validBitmap)
+{
+  return fromStrings(strs.data(), strs.size(), out, validBitmap);
+}
+
+bool PublicKey::isOnCurve() const
+{
+  return ::isOnCurve(this->key);
+}
+
+namespace
+{
+  constexpr char PDA_MARKER[] = "ProgramDerivedAddress";
+
+  bool seedsAreValid(const std::vector<Span<const uint8_t>> &seeds, size_t maxSeeds)
   {
-    throw ParsePubkeyError("Invalid");
+    if (seeds.size() > maxSeeds)
+    {
+      return false;
+    }
+    return std::all_of(seeds.begin(), seeds.end(), [](const Span<const uint8_t> &seed)
+                       { return seed.size() <= MAX_SEED_LEN; });
   }
-  if (publicKeyVec.size() != PUBLIC_KEY_LEN)
+
+  Sha256 hashSeeds(const std::vector<Span<const uint8_t>> &seeds)
   {
-    throw ParsePubkeyError("WrongSize");
+    Sha256 state;
+    for (const auto &seed : seeds)
+    {
+      state.update(seed.data(), seed.size());
+    }
+    return state;
+  }
+
+  // Finish sha256(seeds || tail || programId || marker) from the state
+  // holding the seeds, returns whether the address is off the curve
+  bool deriveAddress(Sha256 state, const uint8_t *tail, size_t tailLen, const PublicKey &programId, PublicKey &address)
+  {
+    state.update(tail, tailLen);
+    state.update(programId.key, PUBLIC_KEY_LEN);
+    state.update(reinterpret_cast<const uint8_t *>(PDA_MARKER), sizeof(PDA_MARKER) - 1);
+    state.finalize(address.key);
+    return !isOnCurve(address.key);
   }
-  return PublicKey(publicKeyVec.data());
+}
+
+PublicKey PublicKey::createProgramAddress(const std::vector<Span<const uint8_t>> &seeds, const PublicKey &programId)
+{
+  return valueOrThrow<PubkeyError>(tryCreateProgramAddress(seeds, programId));
+}
+
+Result<PublicKey> PublicKey::tryCreateProgramAddress(const std::vector<Span<const uint8_t>> &seeds, const PublicKey &programId)
+{
+  if (!seedsAreValid(seeds, MAX_SEEDS))
+  {
+    return Error("MaxSeedLengthExceeded");
+  }
+
+  PublicKey address;
+  if (!deriveAddress(hashSeeds(seeds), nullptr, 0, programId, address))
+  {
+    return Error("InvalidSeeds");
+  }
+  return address;
+}
+
+std::optional<std::pair<PublicKey, uint8_t>> PublicKey::tryFindProgramAddress(const std::vector<Span<const uint8_t>> &seeds, const PublicKey &programId)
+{
+  // The bump is one more seed
+  if (!seedsAreValid(seeds, MAX_SEEDS - 1))
+  {
+    return std::nullopt;
+  }
+
+  const Sha256 seedState = hashSeeds(seeds);
+  PublicKey address;
+  for (int bump = 255; bump >= 0; --bump)
+  {
+    const uint8_t bumpSeed = static_cast<uint8_t>(bump);
+    if (deriveAddress(seedState, &bumpSeed, 1, programId, address))
+    {
+      return std::make_pair(address, bumpSeed);
+    }
+  }
+  return std::nullopt;
+}
+
+std::pair<PublicKey, uint8_t> PublicKey::findProgramAddress(const std::vector<Span<const uint8_t>> &seeds, const PublicKey &programId)
+{
+  auto found = tryFindProgramAddress(seeds, programId);
+  if (!found.has_value())
+  {
+    SOLANA_THROW(PubkeyError("Unable to find a viable program address bump seed"));
+  }
+  return found.value();
+}
+
+std::vector<std::optional<std::pair<PublicKey, uint8_t>>> PublicKey::findProgramAddresses(const std::vector<std::vector<Span<const uint8_t>>> &seedSets, const PublicKey &programId, unsigned threads)
+{
+  std::vector<std::optional<std::pair<PublicKey, uint8_t>>> results(seedSets.size());
+  if (threads == 0)
+  {
+    threads = defaultWorkerCount();
+  }
+  threads = static_cast<unsigned>(std::min<size_t>(threads, std::max<size_t>(1, seedSets.size())));
+
+  // Bump searches vary in length, so workers claim small chunks and steal
+  // the chunks of slower workers
+  WorkStealingRange range(seedSets.size(), threads, 16);
+  auto body = [&](unsigned worker)
+  {
+    size_t begin, end;
+    while (range.claim(worker, begin, end))
+    {
+      for (size_t i = begin; i < end; ++i)
+      {
+        results[i] = tryFindProgramAddress(seedSets[i], programId);
+      }
+    }
+  };
+  runWorkers(threads, body);
+  return results;
 }
 
 // Serialize method
@@ -81,13 +221,5 @@ std::vector<uint8_t> PublicKey::serialize()
 PublicKey PublicKey::deserialize(const std::vector<uint8_t> &data)
 {
   std::string str(data.begin(), data.end());
-  auto publicKeyOpt = PublicKey::fromString(str);
-  if (publicKeyOpt.has_value())
-  {
-    return publicKeyOpt.value();
-  }
-  else
-  {
-    throw ParsePubkeyError("Invalid");
-  }
+  return valueOrThrow<ParsePubkeyError>(PublicKey::tryFromString(str));
 }
\ No newline at end of file
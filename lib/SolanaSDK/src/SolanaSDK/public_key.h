@@ -1,17 +1,29 @@
 #ifndef PUBLIC_KEY_H
 #define PUBLIC_KEY_H
 
+#include <cstdint>
+#include <cstring>
 #include <string>
+#include <array>
 #include <optional>
+#include <utility>
+#include <vector>
 #include <stdexcept>
 #include <iostream>
 #include <sstream>
 #include "base58.h"
+#include "result.h"
 
 const uint8_t PUBLIC_KEY_LEN = 32;
 
 const uint8_t PUBLIC_KEY_MAX_BASE58_LEN = 44;
 
+// Maximum number of seeds of a program derived address
+const size_t MAX_SEEDS = 16;
+
+// Maximum length in bytes of a program derived address seed
+const size_t MAX_SEED_LEN = 32;
+
 class ParsePubkeyError : public std::runtime_error
 {
 public:
@@ -19,27 +31,92 @@ public:
     explicit ParsePubkeyError(const char *arg) : std::runtime_error(arg) {}
 };
 
+class PubkeyError : public std::runtime_error
+{
+public:
+    explicit PubkeyError(const std::string &arg) : std::runtime_error(arg) {}
+    explicit PubkeyError(const char *arg) : std::runtime_error(arg) {}
+};
+
 class PublicKey
 {
 public:
     unsigned char key[PUBLIC_KEY_LEN];
 
     // Default constructor
-    PublicKey();
+    constexpr PublicKey() : key{} {}
+
+    // Construct from raw key bytes, usable in constant expressions
+    constexpr explicit PublicKey(const std::array<uint8_t, PUBLIC_KEY_LEN> &bytes) : key{}
+    {
+        for (size_t i = 0; i < PUBLIC_KEY_LEN; ++i)
+        {
+            key[i] = bytes[i];
+        }
+    }
 
     // Parameterized constructor
     PublicKey(const unsigned char value[PUBLIC_KEY_LEN]);
 
+    // Raw key bytes, throws ParsePubkeyError unless there are exactly
+    // PUBLIC_KEY_LEN
     PublicKey(const std::vector<uint8_t> &value);
 
     // Convert key to base58
     std::string toBase58();
 
+    // Convert key to base58 into a caller provided buffer, returns the length
+    size_t toBase58(char out[PUBLIC_KEY_MAX_BASE58_LEN + 1]) const;
+
     // sanitize
     void sanitize();
 
     static std::optional<PublicKey> fromString(const std::string &s);
 
+    // As fromString, returning the error instead of throwing ParsePubkeyError
+    static Result<PublicKey> tryFromString(const std::string &s);
+
+    // Parse a base58 literal at compile time, invalid literals fail to compile
+    template <size_t N>
+    static constexpr PublicKey fromLiteral(const char (&s)[N])
+    {
+        return PublicKey(Base58::decode32Literal(s));
+    }
+
+    // Decode `count` base58 strings into the contiguous `out` array. Bit i of
+    // `validBitmap`, which holds (count + 7) / 8 bytes, is set when strs[i] is
+    // a valid key; invalid keys are zeroed. Returns the number of valid keys.
+    static size_t fromStrings(const std::string *strs, size_t count, PublicKey *out, uint8_t *validBitmap);
+
+    static size_t fromStrings(const std::vector<std::string> &strs, PublicKey *out, uint8_t *validBitmap);
+
+    // Whether the key is a point on the ed25519 curve. Program derived
+    // addresses are never on the curve, so no private key exists for them.
+    bool isOnCurve() const;
+
+    // Derive the program address of `seeds` for `programId`. Throws
+    // PubkeyError("MaxSeedLengthExceeded") when there are more than
+    // MAX_SEEDS seeds or one is longer than MAX_SEED_LEN, and
+    // PubkeyError("InvalidSeeds") when the derived address is on the curve.
+    static PublicKey createProgramAddress(const std::vector<Span<const uint8_t>> &seeds, const PublicKey &programId);
+
+    // As createProgramAddress, returning the error instead of throwing
+    static Result<PublicKey> tryCreateProgramAddress(const std::vector<Span<const uint8_t>> &seeds, const PublicKey &programId);
+
+    // Find the first valid program address, trying bump seeds from 255 down
+    // to 0. The seeds are hashed once and every bump resumes from that
+    // state. Returns std::nullopt when the seeds are invalid or no bump
+    // yields an address off the curve.
+    static std::optional<std::pair<PublicKey, uint8_t>> tryFindProgramAddress(const std::vector<Span<const uint8_t>> &seeds, const PublicKey &programId);
+
+    // As tryFindProgramAddress, throwing PubkeyError when no address is found
+    static std::pair<PublicKey, uint8_t> findProgramAddress(const std::vector<Span<const uint8_t>> &seeds, const PublicKey &programId);
+
+    // Run tryFindProgramAddress for many seed sets of one program, spread
+    // over `threads` workers (0 uses every core).
+    // Results are in the order of `seedSets`.
+    static std::vector<std::optional<std::pair<PublicKey, uint8_t>>> findProgramAddresses(const std::vector<std::vector<Span<const uint8_t>>> &seedSets, const PublicKey &programId, unsigned threads = 0);
+
     std::vector<uint8_t> serialize();
 
     static PublicKey deserialize(const std::vector<uint8_t> &data);
@@ -88,7 +165,7 @@ public:
     {
         if (index < 0 || index >= PUBLIC_KEY_LEN)
         {
-            throw std::out_of_range("Index out of range");
+            SOLANA_THROW(std::out_of_range("Index out of range"));
         }
         return key[index];
     }
@@ -98,7 +175,7 @@ public:
     {
         if (index < 0 || index >= PUBLIC_KEY_LEN)
         {
-            throw std::out_of_range("Index out of range");
+            SOLANA_THROW(std::out_of_range("Index out of range"));
         }
         return key[index];
     }
@@ -135,4 +212,17 @@ public:
     }
 };
 
+// Hash for unordered containers keyed by PublicKey. Keys are hashes or curve
+// points, and vanity keys only fix their leading bytes, so folding the four
+// 64-bit words together spreads them well enough.
+struct PublicKeyHash
+{
+    size_t operator()(const PublicKey &publicKey) const
+    {
+        uint64_t words[PUBLIC_KEY_LEN / sizeof(uint64_t)];
+        memcpy(words, publicKey.key, PUBLIC_KEY_LEN);
+        return static_cast<size_t>(words[0] ^ words[1] ^ words[2] ^ words[3]);
+    }
+};
+
 #endif // PUBLIC_KEY_H
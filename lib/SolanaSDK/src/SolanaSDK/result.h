@@ -0,0 +1,141 @@
+#ifndef RESULT_H
+#define RESULT_H
+
+#include <cstdio>
+#include <cstdlib>
+#include <optional>
+#include <type_traits>
+#include <utility>
+#include <variant>
+
+// Whether the library is built with C++ exceptions. With -fno-exceptions
+// the throwing APIs abort through solanaFatal instead, the try* APIs
+// returning a Result are the ones to use then.
+#if defined(__cpp_exceptions) || defined(__EXCEPTIONS)
+#define SOLANA_EXCEPTIONS 1
+#else
+#define SOLANA_EXCEPTIONS 0
+#endif
+
+[[noreturn]] inline void solanaFatal(const char *what)
+{
+  fprintf(stderr, "SolanaSDK: %s\n", what);
+  abort();
+}
+
+#if SOLANA_EXCEPTIONS
+#define SOLANA_THROW(exception) throw exception
+#else
+#define SOLANA_THROW(exception) solanaFatal((exception).what())
+#endif
+
+// Error of the non-throwing APIs: a static description, so returning one
+// never allocates
+class Error
+{
+public:
+  constexpr explicit Error(const char *message) : message(message) {}
+
+  const char *what() const
+  {
+    return message;
+  }
+
+private:
+  const char *message;
+};
+
+// Either a T or an E, the return type of the try* APIs. Implicitly
+// constructible from both so that functions can `return value;` and
+// `return Error("...");`.
+template <typename T, typename E = Error>
+class Result
+{
+  static_assert(!std::is_same<T, E>::value, "Result needs distinct value and error types");
+
+public:
+  Result(const T &value) : state(std::in_place_index<0>, value) {}
+  Result(T &&value) : state(std::in_place_index<0>, std::move(value)) {}
+  Result(const E &error) : state(std::in_place_index<1>, error) {}
+
+  bool hasValue() const
+  {
+    return state.index() == 0;
+  }
+
+  explicit operator bool() const
+  {
+    return hasValue();
+  }
+
+  // Only valid when hasValue()
+  T &value()
+  {
+    return *std::get_if<0>(&state);
+  }
+
+  const T &value() const
+  {
+    return *std::get_if<0>(&state);
+  }
+
+  // Only valid when !hasValue()
+  const E &error() const
+  {
+    return *std::get_if<1>(&state);
+  }
+
+private:
+  std::variant<T, E> state;
+};
+
+// Success or an E, default constructed is success
+template <typename E>
+class Result<void, E>
+{
+public:
+  Result() = default;
+  Result(const E &error) : failure(error) {}
+
+  bool hasValue() const
+  {
+    return !failure.has_value();
+  }
+
+  explicit operator bool() const
+  {
+    return hasValue();
+  }
+
+  // Only valid when !hasValue()
+  const E &error() const
+  {
+    return *failure;
+  }
+
+private:
+  std::optional<E> failure;
+};
+
+// Adapter for the throwing APIs: the value of `result`, or an Exception
+// carrying its error message
+template <typename Exception, typename T, typename E>
+T valueOrThrow(Result<T, E> result)
+{
+  if (!result)
+  {
+    SOLANA_THROW(Exception(result.error().what()));
+  }
+  return std::move(result.value());
+}
+
+template <typename Exception, typename E>
+void valueOrThrow(Result<void, E> result)
+{
+  if (!result)
+  {
+    SOLANA_THROW(Exception(result.error().what()));
+  }
+}
+
+#endif // RESULT_H
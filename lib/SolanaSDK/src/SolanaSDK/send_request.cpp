@@ -1,14 +1,20 @@
 #include <WiFi.h>
 #include <HTTPClient.h>
+#include "send_request.h"
 
 bool sendHttpRequest(const char *url, const String &requestData, String &response)
+{
+  return sendHttpRequest(url, reinterpret_cast<const uint8_t *>(requestData.c_str()), requestData.length(), response);
+}
+
+bool sendHttpRequest(const char *url, const uint8_t *requestData, size_t requestLen, String &response)
 {
   if (WiFi.status() == WL_CONNECTED)
   {
     HTTPClient http;
     http.begin(url);
 
-    int httpResponseCode = http.POST(requestData);
+    int httpResponseCode = http.POST(const_cast<uint8_t *>(requestData), requestLen);
 
     if (httpResponseCode > 0)
     {
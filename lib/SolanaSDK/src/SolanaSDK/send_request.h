@@ -6,4 +6,6 @@
 
 bool sendHttpRequest(const char *url, const String &requestData, String &response);
 
+bool sendHttpRequest(const char *url, const uint8_t *requestData, size_t requestLen, String &response);
+
 #endif // SEND_REQUEST_H
\ No newline at end of file
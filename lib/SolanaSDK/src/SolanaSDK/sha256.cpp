@@ -0,0 +1,368 @@
+#include <cstdint>
+#include <cstddef>
+#include <cstring>
+#include "sha256.h"
+
+#ifdef SOLANA_SHA256_MBEDTLS
+
+#include <mbedtls/version.h>
+
+// mbedtls 3 dropped the _ret suffix from the streaming API
+#if MBEDTLS_VERSION_NUMBER >= 0x03000000
+#define SHA256_STARTS mbedtls_sha256_starts
+#define SHA256_UPDATE mbedtls_sha256_update
+#define SHA256_FINISH mbedtls_sha256_finish
+#else
+#define SHA256_STARTS mbedtls_sha256_starts_ret
+#define SHA256_UPDATE mbedtls_sha256_update_ret
+#define SHA256_FINISH mbedtls_sha256_finish_ret
+#endif
+
+Sha256::Sha256()
+{
+  mbedtls_sha256_init(&ctx);
+  SHA256_STARTS(&ctx, 0);
+}
+
+Sha256::Sha256(const Sha256 &other)
+{
+  mbedtls_sha256_init(&ctx);
+  mbedtls_sha256_clone(&ctx, &other.ctx);
+}
+
+Sha256 &Sha256::operator=(const Sha256 &other)
+{
+  if (this != &other)
+  {
+    mbedtls_sha256_clone(&ctx, &other.ctx);
+  }
+  return *this;
+}
+
+Sha256::~Sha256()
+{
+  mbedtls_sha256_free(&ctx);
+}
+
+void Sha256::reset()
+{
+  SHA256_STARTS(&ctx, 0);
+}
+
+void Sha256::update(const uint8_t *data, size_t len)
+{
+  SHA256_UPDATE(&ctx, data, len);
+}
+
+void Sha256::finalize(uint8_t out[DIGEST_LEN])
+{
+  SHA256_FINISH(&ctx, out);
+}
+
+const char *Sha256::backend()
+{
+  return "mbedtls";
+}
+
+#else
+
+#if (defined(__x86_64__) || defined(__i386__)) && (defined(__GNUC__) || defined(__clang__))
+#define SHA256_SHA_NI
+#include <immintrin.h>
+#endif
+
+#if defined(__aarch64__) && (defined(__ARM_FEATURE_SHA2) || defined(__ARM_FEATURE_CRYPTO))
+#define SHA256_ARMV8
+#include <arm_neon.h>
+#endif
+
+namespace
+{
+  constexpr uint32_t INITIAL_STATE[8] = {
+      0x6a09e667, 0xbb67ae85, 0x3c6ef372, 0xa54ff53a,
+      0x510e527f, 0x9b05688c, 0x1f83d9ab, 0x5be0cd19};
+
+  alignas(16) constexpr uint32_t K[64] = {
+      0x428a2f98, 0x71374491, 0xb5c0fbcf, 0xe9b5dba5, 0x3956c25b, 0x59f111f1, 0x923f82a4, 0xab1c5ed5,
+      0xd807aa98, 0x12835b01, 0x243185be, 0x550c7dc3, 0x72be5d74, 0x80deb1fe, 0x9bdc06a7, 0xc19bf174,
+      0xe49b69c1, 0xefbe4786, 0x0fc19dc6, 0x240ca1cc, 0x2de92c6f, 0x4a7484aa, 0x5cb0a9dc, 0x76f988da,
+      0x983e5152, 0xa831c66d, 0xb00327c8, 0xbf597fc7, 0xc6e00bf3, 0xd5a79147, 0x06ca6351, 0x14292967,
+      0x27b70a85, 0x2e1b2138, 0x4d2c6dfc, 0x53380d13, 0x650a7354, 0x766a0abb, 0x81c2c92e, 0x92722c85,
+      0xa2bfe8a1, 0xa81a664b, 0xc24b8b70, 0xc76c51a3, 0xd192e819, 0xd6990624, 0xf40e3585, 0x106aa070,
+      0x19a4c116, 0x1e376c08, 0x2748774c, 0x34b0bcb5, 0x391c0cb3, 0x4ed8aa4a, 0x5b9cca4f, 0x682e6ff3,
+      0x748f82ee, 0x78a5636f, 0x84c87814, 0x8cc70208, 0x90befffa, 0xa4506ceb, 0xbef9a3f7, 0xc67178f2};
+
+  // Absorbs `blocks` consecutive 64 byte blocks into `state`
+  using CompressFn = void (*)(uint32_t state[8], const uint8_t *data, size_t blocks);
+
+  inline uint32_t rotr(uint32_t x, unsigned n)
+  {
+    return (x >> n) | (x << (32 - n));
+  }
+
+  inline uint32_t loadBigEndian(const uint8_t *p)
+  {
+    return (static_cast<uint32_t>(p[0]) << 24) | (static_cast<uint32_t>(p[1]) << 16) |
+           (static_cast<uint32_t>(p[2]) << 8) | static_cast<uint32_t>(p[3]);
+  }
+
+  inline void storeBigEndian(uint8_t *p, uint32_t x)
+  {
+    p[0] = static_cast<uint8_t>(x >> 24);
+    p[1] = static_cast<uint8_t>(x >> 16);
+    p[2] = static_cast<uint8_t>(x >> 8);
+    p[3] = static_cast<uint8_t>(x);
+  }
+
+  void compressPortable(uint32_t state[8], const uint8_t *data, size_t blocks)
+  {
+    uint32_t w[16];
+    for (; blocks > 0; --blocks, data += Sha256::BLOCK_LEN)
+    {
+      uint32_t a = state[0], b = state[1], c = state[2], d = state[3];
+      uint32_t e = state[4], f = state[5], g = state[6], h = state[7];
+
+      // The message schedule is kept as a 16 word ring
+      for (size_t t = 0; t < 64; ++t)
+      {
+        uint32_t wt;
+        if (t < 16)
+        {
+          wt = loadBigEndian(data + t * 4);
+        }
+        else
+        {
+          uint32_t w15 = w[(t - 15) & 15];
+          uint32_t w2 = w[(t - 2) & 15];
+          uint32_t s0 = rotr(w15, 7) ^ rotr(w15, 18) ^ (w15 >> 3);
+          uint32_t s1 = rotr(w2, 17) ^ rotr(w2, 19) ^ (w2 >> 10);
+          wt = w[t & 15] + s0 + w[(t - 7) & 15] + s1;
+        }
+        w[t & 15] = wt;
+
+        uint32_t t1 = h + (rotr(e, 6) ^ rotr(e, 11) ^ rotr(e, 25)) + ((e & f) ^ (~e & g)) + K[t] + wt;
+        uint32_t t2 = (rotr(a, 2) ^ rotr(a, 13) ^ rotr(a, 22)) + ((a & b) ^ (a & c) ^ (b & c));
+        h = g;
+        g = f;
+        f = e;
+        e = d + t1;
+        d = c;
+        c = b;
+        b = a;
+        a = t1 + t2;
+      }
+
+      state[0] += a;
+      state[1] += b;
+      state[2] += c;
+      state[3] += d;
+      state[4] += e;
+      state[5] += f;
+      state[6] += g;
+      state[7] += h;
+    }
+  }
+
+#ifdef SHA256_SHA_NI
+  // The SHA extensions keep the state as ABEF/CDGH halves and run two rounds
+  // per sha256rnds2, so a 4 word message group covers four rounds.
+  __attribute__((target("sha,sse4.1"))) void compressShaNi(uint32_t state[8], const uint8_t *data, size_t blocks)
+  {
+    const __m128i byteSwap = _mm_set_epi64x(0x0c0d0e0f08090a0bULL, 0x0405060700010203ULL);
+
+    __m128i tmp = _mm_shuffle_epi32(_mm_loadu_si128(reinterpret_cast<const __m128i *>(&state[0])), 0xb1);
+    __m128i state1 = _mm_shuffle_epi32(_mm_loadu_si128(reinterpret_cast<const __m128i *>(&state[4])), 0x1b);
+    __m128i state0 = _mm_alignr_epi8(tmp, state1, 8);
+    state1 = _mm_blend_epi16(state1, tmp, 0xf0);
+
+    for (; blocks > 0; --blocks, data += Sha256::BLOCK_LEN)
+    {
+      const __m128i savedState0 = state0;
+      const __m128i savedState1 = state1;
+      __m128i w[4];
+
+      for (size_t i = 0; i < 16; ++i)
+      {
+        if (i < 4)
+        {
+          w[i] = _mm_shuffle_epi8(_mm_loadu_si128(reinterpret_cast<const __m128i *>(data + i * 16)), byteSwap);
+        }
+        else
+        {
+          __m128i next = _mm_sha256msg1_epu32(w[i & 3], w[(i + 1) & 3]);
+          next = _mm_add_epi32(next, _mm_alignr_epi8(w[(i + 3) & 3], w[(i + 2) & 3], 4));
+          w[i & 3] = _mm_sha256msg2_epu32(next, w[(i + 3) & 3]);
+        }
+
+        __m128i msg = _mm_add_epi32(w[i & 3], _mm_load_si128(reinterpret_cast<const __m128i *>(&K[i * 4])));
+        state1 = _mm_sha256rnds2_epu32(state1, state0, msg);
+        msg = _mm_shuffle_epi32(msg, 0x0e);
+        state0 = _mm_sha256rnds2_epu32(state0, state1, msg);
+      }
+
+      state0 = _mm_add_epi32(state0, savedState0);
+      state1 = _mm_add_epi32(state1, savedState1);
+    }
+
+    tmp = _mm_shuffle_epi32(state0, 0x1b);
+    state1 = _mm_shuffle_epi32(state1, 0xb1);
+    state0 = _mm_blend_epi16(tmp, state1, 0xf0);
+    state1 = _mm_alignr_epi8(state1, tmp, 8);
+    _mm_storeu_si128(reinterpret_cast<__m128i *>(&state[0]), state0);
+    _mm_storeu_si128(reinterpret_cast<__m128i *>(&state[4]), state1);
+  }
+#endif
+
+#ifdef SHA256_ARMV8
+  void compressArmv8(uint32_t state[8], const uint8_t *data, size_t blocks)
+  {
+    uint32x4_t state0 = vld1q_u32(&state[0]);
+    uint32x4_t state1 = vld1q_u32(&state[4]);
+
+    for (; blocks > 0; --blocks, data += Sha256::BLOCK_LEN)
+    {
+      const uint32x4_t savedState0 = state0;
+      const uint32x4_t savedState1 = state1;
+      uint32x4_t w[4];
+
+      for (size_t i = 0; i < 16; ++i)
+      {
+        if (i < 4)
+        {
+          w[i] = vreinterpretq_u32_u8(vrev32q_u8(vld1q_u8(data + i * 16)));
+        }
+        else
+        {
+          w[i & 3] = vsha256su1q_u32(vsha256su0q_u32(w[i & 3], w[(i + 1) & 3]), w[(i + 2) & 3], w[(i + 3) & 3]);
+        }
+
+        const uint32x4_t msg = vaddq_u32(w[i & 3], vld1q_u32(&K[i * 4]));
+        const uint32x4_t abcd = state0;
+        state0 = vsha256hq_u32(state0, state1, msg);
+        state1 = vsha256h2q_u32(state1, abcd, msg);
+      }
+
+      state0 = vaddq_u32(state0, savedState0);
+      state1 = vaddq_u32(state1, savedState1);
+    }
+
+    vst1q_u32(&state[0], state0);
+    vst1q_u32(&state[4], state1);
+  }
+#endif
+
+  struct Backend
+  {
+    CompressFn compress;
+    const char *name;
+  };
+
+  Backend selectBackend()
+  {
+#ifdef SHA256_SHA_NI
+    if (__builtin_cpu_supports("sha") && __builtin_cpu_supports("sse4.1"))
+    {
+      return {compressShaNi, "sha-ni"};
+    }
+#endif
+#ifdef SHA256_ARMV8
+    return {compressArmv8, "armv8"};
+#endif
+    return {compressPortable, "portable"};
+  }
+
+  const Backend &backendInstance()
+  {
+    static const Backend backend = selectBackend();
+    return backend;
+  }
+}
+
+Sha256::Sha256()
+{
+  reset();
+}
+
+void Sha256::reset()
+{
+  std::memcpy(state, INITIAL_STATE, sizeof(state));
+  length = 0;
+  buffered = 0;
+}
+
+void Sha256::update(const uint8_t *data, size_t len)
+{
+  if (len == 0)
+  {
+    return;
+  }
+  CompressFn compress = backendInstance().compress;
+  length += len;
+
+  // Top up a partially filled block first
+  if (buffered > 0)
+  {
+    size_t take = BLOCK_LEN - buffered < len ? BLOCK_LEN - buffered : len;
+    std::memcpy(buffer + buffered, data, take);
+    buffered += take;
+    data += take;
+    len -= take;
+    if (buffered < BLOCK_LEN)
+    {
+      return;
+    }
+    compress(state, buffer, 1);
+    buffered = 0;
+  }
+
+  // Whole blocks are absorbed straight from the input
+  size_t blocks = len / BLOCK_LEN;
+  if (blocks > 0)
+  {
+    compress(state, data, blocks);
+    data += blocks * BLOCK_LEN;
+    len -= blocks * BLOCK_LEN;
+  }
+
+  std::memcpy(buffer, data, len);
+  buffered = len;
+}
+
+void Sha256::finalize(uint8_t out[DIGEST_LEN])
+{
+  CompressFn compress = backendInstance().compress;
+  uint64_t bitLength = length * 8;
+
+  buffer[buffered++] = 0x80;
+  if (buffered > BLOCK_LEN - 8)
+  {
+    std::memset(buffer + buffered, 0, BLOCK_LEN - buffered);
+    compress(state, buffer, 1);
+    buffered = 0;
+  }
+  std::memset(buffer + buffered, 0, BLOCK_LEN - 8 - buffered);
+  for (size_t i = 0; i < 8; ++i)
+  {
+    buffer[BLOCK_LEN - 1 - i] = static_cast<uint8_t>(bitLength >> (8 * i));
+  }
+  compress(state, buffer, 1);
+
+  for (size_t i = 0; i < 8; ++i)
+  {
+    storeBigEndian(out + i * 4, state[i]);
+  }
+}
+
+const char *Sha256::backend()
+{
+  return backendInstance().name;
+}
+
+#endif
+
+void Sha256::digest(const uint8_t *data, size_t len, uint8_t out[DIGEST_LEN])
+{
+  Sha256 hasher;
+  hasher.update(data, len);
+  hasher.finalize(out);
+}
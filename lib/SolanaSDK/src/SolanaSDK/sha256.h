@@ -0,0 +1,55 @@
+#ifndef SHA256_H
+#define SHA256_H
+
+#include <cstdint>
+#include <cstddef>
+
+// On the ESP32 hashing goes through mbedtls, which ESP-IDF backs with the SHA
+// peripheral. Define SOLANA_SHA256_PORTABLE to use the software engine instead.
+#if defined(ESP_PLATFORM) && !defined(SOLANA_SHA256_PORTABLE)
+#define SOLANA_SHA256_MBEDTLS
+#include <mbedtls/sha256.h>
+#endif
+
+// Incremental SHA-256. The state is a plain value: copying a Sha256 forks the
+// computation, so a common prefix can be absorbed once and reused.
+class Sha256
+{
+public:
+  static constexpr size_t DIGEST_LEN = 32;
+  static constexpr size_t BLOCK_LEN = 64;
+
+  Sha256();
+#ifdef SOLANA_SHA256_MBEDTLS
+  Sha256(const Sha256 &other);
+  Sha256 &operator=(const Sha256 &other);
+  ~Sha256();
+#endif
+
+  // Start a new computation, discarding any absorbed input
+  void reset();
+
+  void update(const uint8_t *data, size_t len);
+
+  // Write the digest of everything absorbed so far. The hasher must be
+  // reset before it is used again.
+  void finalize(uint8_t out[DIGEST_LEN]);
+
+  // One-shot digest of `len` bytes
+  static void digest(const uint8_t *data, size_t len, uint8_t out[DIGEST_LEN]);
+
+  // Name of the block function in use, e.g. "portable" or "sha-ni"
+  static const char *backend();
+
+private:
+#ifdef SOLANA_SHA256_MBEDTLS
+  mbedtls_sha256_context ctx;
+#else
+  uint32_t state[8];
+  uint64_t length;
+  uint8_t buffer[BLOCK_LEN];
+  size_t buffered;
+#endif
+};
+
+#endif // SHA256_H
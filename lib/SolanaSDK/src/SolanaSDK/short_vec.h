@@ -0,0 +1,59 @@
+#ifndef SHORT_VEC_H
+#define SHORT_VEC_H
+
+#include <cstddef>
+#include <cstdint>
+
+// The compact-u16 length prefix of the wire format: 7 bits per byte, low
+// bits first, with the high bit set on every byte but the last
+class ShortVec
+{
+public:
+  // Longest encoding, of values up to 0xffff
+  static constexpr size_t MAX_ENCODED_LEN = 3;
+
+  static constexpr size_t encodedLen(uint16_t value)
+  {
+    return value < 0x80 ? 1 : value < 0x4000 ? 2 : 3;
+  }
+
+  // Write `value` to `out`, returns the number of bytes written
+  static size_t encode(uint16_t value, uint8_t out[MAX_ENCODED_LEN])
+  {
+    size_t len = 0;
+    uint32_t rest = value;
+    while (rest >= 0x80)
+    {
+      out[len++] = static_cast<uint8_t>(rest | 0x80);
+      rest >>= 7;
+    }
+    out[len++] = static_cast<uint8_t>(rest);
+    return len;
+  }
+
+  // Read a length from the `len` bytes at `data`. Fails on truncated input
+  // and on encodings the runtime rejects: values above 0xffff and aliases
+  // ending in a zero byte. On success `consumed` is the encoded length.
+  static bool decode(const uint8_t *data, size_t len, uint16_t &value, size_t &consumed)
+  {
+    uint32_t result = 0;
+    for (size_t i = 0; i < MAX_ENCODED_LEN && i < len; ++i)
+    {
+      const uint8_t byte = data[i];
+      if ((i > 0 && byte == 0) || (i == MAX_ENCODED_LEN - 1 && byte > 0x03))
+      {
+        return false;
+      }
+      result |= uint32_t(byte & 0x7f) << (7 * i);
+      if ((byte & 0x80) == 0)
+      {
+        value = static_cast<uint16_t>(result);
+        consumed = i + 1;
+        return true;
+      }
+    }
+    return false;
+  }
+};
+
+#endif // SHORT_VEC_H
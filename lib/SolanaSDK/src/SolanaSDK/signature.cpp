@@ -10,6 +10,7 @@
 #include "keypair.h"
 #include "public_key.h"
 #include "signature.h"
+#include "worker_pool.h"
 
 Signature::Signature(const std::vector<uint8_t> &signatureSlice)
 {
@@ -23,7 +24,7 @@ Signature::Signature(const std::vector<uint8_t> &signatureSlice)
     // Check if the size of the trimmed signature is correct
     if (trimmedSlice.size() != SIGNATURE_BYTES)
     {
-        throw std::invalid_argument("Wrong size for signature");
+        SOLANA_THROW(std::invalid_argument("Wrong size for signature"));
     }
 
     // Copy the trimmed signature to the value member
@@ -40,36 +41,77 @@ Signature Signature::newUnique()
     return signature;
 }
 
+// Checks claimed by a worker at a time
+static const size_t VERIFY_GRAIN = 4;
+
+std::vector<bool> Signature::verifyBatch(const std::vector<SignatureCheck> &checks)
+{
+    // One byte per result, the workers cannot share the bits of a
+    // std::vector<bool>
+    std::vector<uint8_t> valid(checks.size(), 0);
+    const unsigned threads = static_cast<unsigned>(std::min<size_t>(defaultWorkerCount(), std::max<size_t>(1, checks.size())));
+    WorkStealingRange range(checks.size(), threads, VERIFY_GRAIN);
+    auto body = [&](unsigned worker)
+    {
+        size_t begin, end;
+        while (range.claim(worker, begin, end))
+        {
+            for (size_t i = begin; i < end; ++i)
+            {
+                const SignatureCheck &check = checks[i];
+                valid[i] = crypto_sign_ed25519_verify_detached(check.signature, check.message, check.messageLen, check.publicKey) == 0;
+            }
+        }
+    };
+    runWorkers(threads, body);
+    return std::vector<bool>(valid.begin(), valid.end());
+}
+
 void Signature::verify(const std::vector<uint8_t> &pubkeyBytes, const std::vector<uint8_t> &messageBytes)
 {
-    this->verifyVerbose(pubkeyBytes, messageBytes);
+    if (pubkeyBytes.size() != PUBLIC_KEY_LEN)
+    {
+        SOLANA_THROW(std::runtime_error("Signature verify failed"));
+    }
+    valueOrThrow<std::runtime_error>(this->tryVerify(pubkeyBytes.data(), messageBytes.data(), messageBytes.size()));
+}
+
+Result<void> Signature::tryVerify(const uint8_t pubkeyBytes[PUBLIC_KEY_LEN], const uint8_t *messageBytes, size_t messageLen) const
+{
+    if (crypto_sign_ed25519_verify_detached(this->value.data(), messageBytes, messageLen, pubkeyBytes) != 0)
+    {
+        return Error("Signature verify failed");
+    }
+    return {};
 }
 
 std::string Signature::toString() const
 {
-    std::vector<uint8_t> result;
-    std::copy(value.begin(), value.end(), std::back_inserter(result));
-    return Base58::trimEncode(result);
+    return Base58::encode64(value.data());
+}
+
+size_t Signature::toString(char out[MAX_BASE58_SIGNATURE_LEN + 1]) const
+{
+    return Base58::encode64(value.data(), out);
 }
 
 Signature Signature::fromString(const std::string &s)
 {
-    std::string s_trimmed = s.substr(s.find_first_not_of('1')); // Skip initial '1's
-    if (s_trimmed.size() > MAX_BASE58_SIGNATURE_LEN)
-    {
-        throw std::invalid_argument("Wrong size for signature");
-    }
-    std::vector<uint8_t> decoded = Base58::decode(s);
-    std::vector<uint8_t> signatureSlice(decoded.begin(), decoded.end());
-    return Signature(signatureSlice);
+    return valueOrThrow<std::invalid_argument>(tryFromString(s));
 }
 
-void Signature::verifyVerbose(const std::vector<uint8_t> &publicKeyBytes, const std::vector<uint8_t> &messageBytes)
+Result<Signature> Signature::tryFromString(const std::string &s)
 {
-    if (crypto_sign_ed25519_verify_detached(this->value.data(), messageBytes.data(), messageBytes.size(), publicKeyBytes.data()) != 0)
+    if (s.size() > MAX_BASE58_SIGNATURE_LEN)
+    {
+        return Error("Wrong size for signature");
+    }
+    Signature signature;
+    if (!Base58::decode64(s.data(), s.size(), signature.value.data()))
     {
-        throw std::runtime_error("Signature verify failed");
+        return Error("Invalid signature string");
     }
+    return signature;
 }
 
 std::vector<uint8_t> Signature::serialize()
@@ -80,11 +122,16 @@ std::vector<uint8_t> Signature::serialize()
 }
 
 Signature Signature::deserialize(const std::vector<uint8_t> &signatureSlice)
+{
+    return valueOrThrow<std::invalid_argument>(tryDeserialize(signatureSlice));
+}
+
+Result<Signature> Signature::tryDeserialize(const std::vector<uint8_t> &signatureSlice)
 {
     Signature signature;
     if (signatureSlice.size() != SIGNATURE_BYTES)
     {
-        throw std::invalid_argument("Invalid size for signature");
+        return Error("Invalid size for signature");
     }
     std::copy(signatureSlice.begin(), signatureSlice.end(), signature.value.begin());
     return signature;
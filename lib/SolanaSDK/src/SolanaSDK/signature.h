@@ -9,6 +9,7 @@
 #include <algorithm>
 #include "keypair.h"
 #include "public_key.h"
+#include "result.h"
 
 // Number of bytes in a signature
 constexpr size_t SIGNATURE_BYTES = 64;
@@ -16,6 +17,15 @@ constexpr size_t SIGNATURE_BYTES = 64;
 // Maximum string length of a base58 encoded signature
 constexpr size_t MAX_BASE58_SIGNATURE_LEN = 88;
 
+// An Ed25519 signature to check, the pointers are borrowed for the call
+struct SignatureCheck
+{
+    const uint8_t *signature;
+    const uint8_t *publicKey;
+    const uint8_t *message;
+    size_t messageLen;
+};
+
 class Signature
 {
 public:
@@ -25,10 +35,21 @@ public:
     Signature(const std::vector<uint8_t> &signatureSlice);
     static Signature newUnique();
     void verify(const std::vector<uint8_t> &pubkeyBytes, const std::vector<uint8_t> &message_bytes);
+
+    // As verify, returning the failure instead of throwing
+    Result<void> tryVerify(const uint8_t pubkeyBytes[PUBLIC_KEY_LEN], const uint8_t *messageBytes, size_t messageLen) const;
     std::string toString() const;
+    size_t toString(char out[MAX_BASE58_SIGNATURE_LEN + 1]) const;
     static Signature fromString(const std::string &s);
+    static Result<Signature> tryFromString(const std::string &s);
+
+    // Verify many signatures at once, result i tells whether checks[i] is
+    // valid, exactly as tryVerify would decide it. The checks are spread
+    // over every core.
+    static std::vector<bool> verifyBatch(const std::vector<SignatureCheck> &checks);
     std::vector<uint8_t> serialize();
     static Signature deserialize(const std::vector<uint8_t> &signatureSlice);
+    static Result<Signature> tryDeserialize(const std::vector<uint8_t> &signatureSlice);
 
     uint8_t operator*() const
     {
@@ -58,9 +79,6 @@ public:
         }
         return *this;
     }
-
-private:
-    void verifyVerbose(const std::vector<uint8_t> &publicKeyBytes, const std::vector<uint8_t> &messageBytes);
 };
 
 std::ostream &operator<<(std::ostream &os, const Signature &signature);
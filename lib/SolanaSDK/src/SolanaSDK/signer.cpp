@@ -1,5 +1,6 @@
 #include <sodium/crypto_sign_ed25519.h>
 #include <string>
+#include <utility>
 #include <vector>
 #include <Arduino.h>
 #include "signer.h"
@@ -8,60 +9,78 @@
 #include "public_key.h"
 #include "signature.h"
 
-Signer::Signer(Keypair kp)
+Signature Signer::signMessage(Span<const uint8_t> message)
 {
-  this->keypair = kp;
+  return valueOrThrow<std::runtime_error>(this->trySignMessage(message));
 }
 
 std::string Signer::sign(const std::string &message)
 {
-  std::vector<uint8_t> signature(crypto_sign_ed25519_BYTES);
-  std::string signature_base58;
-
-  // Sign the message using the private key
-  crypto_sign_ed25519_detached(signature.data(), NULL, reinterpret_cast<const unsigned char *>(message.c_str()), message.size(), keypair.getSecretKey());
-
-  // Convert the signature to base58
-  signature_base58 = Base58::encode(signature);
+  const Signature signature = this->signMessage(Span<const uint8_t>(reinterpret_cast<const uint8_t *>(message.data()), message.size()));
+  return signature.toString();
+}
 
-  return signature_base58;
+KeypairSigner::KeypairSigner(Keypair kp)
+{
+  this->keypair = kp;
 }
 
-PublicKey Signer::publicKey()
+PublicKey KeypairSigner::publicKey() const
 {
   return this->keypair.publicKey;
 }
 
-Signature Signer::signMessage(const std::vector<uint8_t> &message)
+Result<Signature> KeypairSigner::trySignMessage(Span<const uint8_t> message)
 {
-  std::string message_str(message.begin(), message.end());
-  std::string sig = this->sign(message_str);
-  return Signature::fromString(sig);
+  Signature signature;
+  crypto_sign_ed25519_detached(signature.value.data(), NULL, message.data(), message.size(), this->keypair.getSecretKey());
+  return signature;
 }
 
-Signers::Signers(std::vector<Signer> &signers)
+Signers::Signers(std::vector<Signer *> signers) : signers(std::move(signers)) {}
+
+Signers::Signers(std::vector<KeypairSigner> &signers)
 {
-  this->signers = signers;
+  this->signers.reserve(signers.size());
+  for (KeypairSigner &signer : signers)
+  {
+    this->signers.push_back(&signer);
+  }
 }
 
-std::vector<PublicKey> Signers::publicKeys()
+std::vector<PublicKey> Signers::publicKeys() const
 {
   std::vector<PublicKey> keys;
-  for (auto signer : this->signers)
+  keys.reserve(this->signers.size());
+  for (const Signer *signer : this->signers)
   {
-    keys.push_back(signer.publicKey());
+    keys.push_back(signer->publicKey());
   }
   return keys;
 }
 
-std::vector<Signature> Signers::signMessage(const std::vector<uint8_t> &message)
+Result<Signature> Signers::trySignMessage(size_t index, Span<const uint8_t> message)
+{
+  Signer &signer = *this->signers[index];
+  Result<Signature> signature = signer.trySignMessage(message);
+  if (signature && this->verifyAfterSign)
+  {
+    Result<void> verified = signature.value().tryVerify(signer.publicKey().key, message.data(), message.size());
+    if (!verified)
+    {
+      return verified.error();
+    }
+  }
+  return signature;
+}
+
+std::vector<Signature> Signers::signMessage(Span<const uint8_t> message)
 {
   std::vector<Signature> signatures;
-  for (auto signer : this->signers)
+  signatures.reserve(this->signers.size());
+  for (size_t i = 0; i < this->signers.size(); ++i)
   {
-    Signature sig = signer.signMessage(message);
-    sig.verify(signer.publicKey().serialize(), message);
-    signatures.push_back(sig);
+    signatures.push_back(valueOrThrow<std::runtime_error>(this->trySignMessage(i, message)));
   }
   return signatures;
-}
\ No newline at end of file
+}
@@ -8,39 +8,78 @@
 #include "base58.h"
 #include "public_key.h"
 #include "signature.h"
+#include "span.h"
+#include "result.h"
 
+// Holder of a private key that signs messages with it: a Keypair in
+// memory, a secure element, a remote signing service. Backends implement
+// publicKey and trySignMessage, signatures are produced and returned in
+// binary form.
 class Signer
 {
-private:
-    Keypair keypair;
-
 public:
-    Signer(Keypair kp);
+    virtual ~Signer() = default;
+
+    virtual PublicKey publicKey() const = 0;
 
+    // Ed25519 signature of `message`, or why the backend could not sign
+    virtual Result<Signature> trySignMessage(Span<const uint8_t> message) = 0;
+
+    // As trySignMessage, throwing std::runtime_error
+    Signature signMessage(Span<const uint8_t> message);
+
+    // Base58 encoded signature of `message`
     std::string sign(const std::string &message);
 
-    PublicKey publicKey();
+    // TODO: add tryPublicKeys
+};
+
+// Signer over a Keypair held in memory, signing with libsodium straight
+// into the Signature
+class KeypairSigner : public Signer
+{
+private:
+    Keypair keypair;
+
+public:
+    KeypairSigner(Keypair kp);
 
-    Signature signMessage(const std::vector<uint8_t> &message);
+    PublicKey publicKey() const override;
 
-    // TODO: add tryPublicKeys & trySignMessage
+    Result<Signature> trySignMessage(Span<const uint8_t> message) override;
 };
 
-// Convenience trait for working with mixed collections of Signers.
+// Convenience trait for working with mixed collections of Signers. Holds
+// the signers by pointer, they must outlive it.
 class Signers
 {
 public:
-    std::vector<Signer> signers;
+    std::vector<Signer *> signers;
+
+    // Check every signature against its signer's key right after signing,
+    // to catch a faulty backend at the cost of one Ed25519 verification per
+    // signature. Off by default, a transaction's signatures can still be
+    // checked on their own with Transaction::verify.
+    bool verifyAfterSign = false;
 
     Signers() = default;
 
-    Signers(std::vector<Signer> &signers);
+    Signers(std::vector<Signer *> signers);
+
+    // Refers to the elements of `signers`, which must not be resized while
+    // in use
+    Signers(std::vector<KeypairSigner> &signers);
+
+    size_t size() const { return signers.size(); }
 
-    std::vector<PublicKey> publicKeys();
+    std::vector<PublicKey> publicKeys() const;
 
-    std::vector<Signature> signMessage(const std::vector<uint8_t> &message);
+    // Signature of `message` by signer `index`, verified when
+    // verifyAfterSign is set
+    Result<Signature> trySignMessage(size_t index, Span<const uint8_t> message);
 
-    // TODO: add tryPublicKeys & trySignMessage
+    // Signatures of `message` by every signer, in order
+    std::vector<Signature> signMessage(Span<const uint8_t> message);
 };
 
 #endif // SIGNER_H
@@ -0,0 +1,78 @@
+#include <sodium.h>
+#include <cstring>
+#include "signing_key.h"
+
+SigningKey::SigningKey(const Keypair &keypair) : key(keypair.publicKey)
+{
+    // Expand the seed as crypto_sign_ed25519_detached does: the clamped
+    // first half of SHA-512(seed) is the scalar, the second half the nonce
+    // prefix
+    uint8_t digest[64];
+    crypto_hash_sha512(digest, keypair.getSecretKey(), 32);
+    digest[0] &= 248;
+    digest[31] &= 127;
+    digest[31] |= 64;
+    memcpy(this->prefix, digest + 32, 32);
+
+    // Reduced once here, the scalar arithmetic of every signature then
+    // starts from a canonical scalar
+    memset(digest + 32, 0, 32);
+    crypto_core_ed25519_scalar_reduce(this->scalar, digest);
+    sodium_memzero(digest, sizeof(digest));
+}
+
+SigningKey::~SigningKey()
+{
+    sodium_memzero(this->scalar, sizeof(this->scalar));
+    sodium_memzero(this->prefix, sizeof(this->prefix));
+}
+
+PublicKey SigningKey::publicKey() const
+{
+    return this->key;
+}
+
+Result<Signature> SigningKey::trySignMessage(Span<const uint8_t> message)
+{
+    Signature signature;
+    if (!this->signDetached(signature.value.data(), message.data(), message.size()))
+    {
+        return Error("Nonce reduced to zero");
+    }
+    return signature;
+}
+
+bool SigningKey::signDetached(uint8_t *signature, const uint8_t *message, size_t messageLen) const
+{
+    uint8_t digest[64];
+    uint8_t nonce[32];
+    crypto_hash_sha512_state state;
+
+    // r = H(prefix || M) mod L, R = r B
+    crypto_hash_sha512_init(&state);
+    crypto_hash_sha512_update(&state, this->prefix, 32);
+    crypto_hash_sha512_update(&state, message, messageLen);
+    crypto_hash_sha512_final(&state, digest);
+    crypto_core_ed25519_scalar_reduce(nonce, digest);
+    const bool nonceValid = crypto_scalarmult_ed25519_base_noclamp(signature, nonce) == 0;
+
+    if (nonceValid)
+    {
+        // S = r + H(R || A || M) a mod L
+        uint8_t k[32];
+        uint8_t ka[32];
+        crypto_hash_sha512_init(&state);
+        crypto_hash_sha512_update(&state, signature, 32);
+        crypto_hash_sha512_update(&state, this->key.key, PUBLIC_KEY_LEN);
+        crypto_hash_sha512_update(&state, message, messageLen);
+        crypto_hash_sha512_final(&state, digest);
+        crypto_core_ed25519_scalar_reduce(k, digest);
+        crypto_core_ed25519_scalar_mul(ka, k, this->scalar);
+        crypto_core_ed25519_scalar_add(signature + 32, nonce, ka);
+        sodium_memzero(ka, sizeof(ka));
+    }
+
+    sodium_memzero(nonce, sizeof(nonce));
+    sodium_memzero(digest, sizeof(digest));
+    return nonceValid;
+}
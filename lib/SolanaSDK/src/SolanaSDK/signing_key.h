@@ -0,0 +1,46 @@
+#ifndef SIGNING_KEY_H
+#define SIGNING_KEY_H
+
+#include <cstdint>
+#include "keypair.h"
+#include "public_key.h"
+#include "signature.h"
+#include "signer.h"
+#include "span.h"
+#include "result.h"
+
+// Length of the expanded Ed25519 secret: the signing scalar followed by the
+// nonce prefix
+constexpr size_t EXPANDED_SECRET_KEY_LEN = 64;
+
+// Ed25519 signing key with its seed expanded once, for hot wallets that
+// sign many messages with the same key. crypto_sign_ed25519_detached hashes
+// the seed with SHA-512 on every call to derive the signing scalar and the
+// nonce prefix; a SigningKey keeps both, the scalar already reduced, and
+// signs with the two hashes over the message and the base point
+// multiplication only. Signatures are identical to those of the Keypair.
+//
+// The expanded secret is wiped on destruction. It is as sensitive as the
+// seed, keep SigningKeys no longer than the Keypair they come from.
+class SigningKey : public Signer
+{
+private:
+    uint8_t scalar[32];
+    uint8_t prefix[32];
+    PublicKey key;
+
+public:
+    explicit SigningKey(const Keypair &keypair);
+
+    ~SigningKey() override;
+
+    PublicKey publicKey() const override;
+
+    Result<Signature> trySignMessage(Span<const uint8_t> message) override;
+
+    // Sign into `signature`, SIGNATURE_BYTES long, without going through
+    // Result. Fails only for a message hashing to a zero nonce.
+    bool signDetached(uint8_t *signature, const uint8_t *message, size_t messageLen) const;
+};
+
+#endif // SIGNING_KEY_H
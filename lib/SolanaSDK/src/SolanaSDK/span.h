@@ -0,0 +1,57 @@
+#ifndef SPAN_H
+#define SPAN_H
+
+#include <cstddef>
+#include <array>
+#include <vector>
+
+// Non-owning view over a contiguous sequence of T. A minimal stand-in for
+// std::span, which is not available with the C++17 toolchains we target.
+template <typename T>
+class Span
+{
+public:
+  Span() : ptr(nullptr), len(0) {}
+
+  Span(T *data, size_t size) : ptr(data), len(size) {}
+
+  template <size_t N>
+  Span(T (&arr)[N]) : ptr(arr), len(N) {}
+
+  template <typename U, size_t N>
+  Span(std::array<U, N> &arr) : ptr(arr.data()), len(N) {}
+
+  template <typename U, size_t N>
+  Span(const std::array<U, N> &arr) : ptr(arr.data()), len(N) {}
+
+  template <typename U, typename A>
+  Span(std::vector<U, A> &vec) : ptr(vec.data()), len(vec.size()) {}
+
+  template <typename U, typename A>
+  Span(const std::vector<U, A> &vec) : ptr(vec.data()), len(vec.size()) {}
+
+  // Allow Span<U> -> Span<const U>
+  template <typename U>
+  Span(const Span<U> &other) : ptr(other.data()), len(other.size()) {}
+
+  T *data() const { return ptr; }
+  size_t size() const { return len; }
+  bool empty() const { return len == 0; }
+
+  T *begin() const { return ptr; }
+  T *end() const { return ptr + len; }
+
+  T &operator[](size_t index) const { return ptr[index]; }
+
+  Span first(size_t count) const { return Span(ptr, count); }
+
+  Span subspan(size_t offset) const { return Span(ptr + offset, len - offset); }
+
+  Span subspan(size_t offset, size_t count) const { return Span(ptr + offset, count); }
+
+private:
+  T *ptr;
+  size_t len;
+};
+
+#endif // SPAN_H
@@ -0,0 +1,463 @@
+#ifndef STATIC_TRANSACTION_H
+#define STATIC_TRANSACTION_H
+
+#include <sodium/crypto_sign_ed25519.h>
+#include <algorithm>
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include "public_key.h"
+#include "hash.h"
+#include "signature.h"
+#include "keypair.h"
+#include "account_meta.h"
+#include "message.h"
+#include "compiled_keys.h"
+#include "transaction.h"
+#include "transaction_view.h"
+#include "byte_sink.h"
+#include "span.h"
+#include "result.h"
+
+// An instruction over borrowed accounts and data, to describe instructions
+// without allocating
+struct InstructionRef
+{
+  PublicKey programId;
+  Span<const AccountMeta> accounts;
+  Span<const uint8_t> data;
+};
+
+// Number of elements of containers whose size is part of their type, zero
+// for the others
+template <typename T>
+struct StaticCapacity
+{
+  static constexpr size_t value = 0;
+};
+
+template <typename T, size_t N>
+struct StaticCapacity<std::array<T, N>>
+{
+  static constexpr size_t value = N;
+};
+
+template <typename T, size_t N>
+struct StaticCapacity<T[N]>
+{
+  static constexpr size_t value = N;
+};
+
+// A Message stored in inline arrays sized at compile time: the account keys,
+// the compiled instructions, and one pool each for the account indexes and
+// the data of all instructions. Compiling and serializing never allocate,
+// and the serialized bytes are those of Message::newWithBlockhash for the
+// same instructions.
+template <size_t MaxKeys, size_t MaxInstructions, size_t MaxDataBytes, size_t MaxAccountRefs = MaxKeys * MaxInstructions>
+class StaticMessage
+{
+  static_assert(MaxKeys >= 1, "The payer needs an account key");
+  static_assert(MaxKeys * PUBLIC_KEY_LEN <= PACKET_DATA_SIZE, "More account keys than fit in a transaction");
+  static_assert(MaxInstructions >= 1, "A message needs room for an instruction");
+  static_assert(MaxDataBytes <= PACKET_DATA_SIZE, "More instruction data than fits in a transaction");
+  static_assert(MaxAccountRefs <= PACKET_DATA_SIZE, "More account indexes than fit in a transaction");
+
+public:
+  // Serialized length of a message filled to capacity
+  static constexpr size_t MAX_SERIALIZED_SIZE =
+      4 + ShortVec::MAX_ENCODED_LEN + MaxKeys * PUBLIC_KEY_LEN + HASH_BYTES +
+      ShortVec::MAX_ENCODED_LEN + MaxInstructions * (1 + 2 * ShortVec::MAX_ENCODED_LEN) +
+      MaxAccountRefs + MaxDataBytes + 1;
+
+  // Compile `instructions`, any iterable of values with programId, accounts
+  // and data members such as std::vector<Instruction> or
+  // std::array<InstructionRef, N>. Containers of a fixed size are checked
+  // against MaxInstructions at compile time, the other capacities are
+  // checked here and leave the message empty when exceeded.
+  template <typename Instructions>
+  Result<void> tryCompile(const Instructions &instructions, const PublicKey &payer, const Hash &recentBlockhash);
+
+  // As tryCompile, throwing CompileError
+  template <typename Instructions>
+  void compile(const Instructions &instructions, const PublicKey &payer, const Hash &recentBlockhash)
+  {
+    valueOrThrow<CompileError>(this->tryCompile(instructions, payer, recentBlockhash));
+  }
+
+  const MessageHeader &header() const { return messageHeader; }
+
+  size_t numAccountKeys() const { return numKeys; }
+
+  const PublicKey &accountKey(size_t index) const { return keys[index]; }
+
+  const Hash &recentBlockhash() const { return blockhash; }
+
+  void setRecentBlockhash(const Hash &recentBlockhash) { blockhash = recentBlockhash; }
+
+  size_t numInstructions() const { return instructionCount; }
+
+  InstructionView instruction(size_t index) const
+  {
+    const Entry &entry = entries[index];
+    return InstructionView{entry.programIdIndex,
+                           Span<const uint8_t>(accountIndexes + entry.accountsOffset, entry.numAccounts),
+                           Span<const uint8_t>(data + entry.dataOffset, entry.dataLen)};
+  }
+
+  void serialize(ByteSink &sink) const;
+
+  // Exact length of the serialized message
+  size_t serializedSize() const;
+
+  // Serialize into `out`, returns the number of bytes written
+  Result<size_t> serializeInto(Span<uint8_t> out) const
+  {
+    return serializeToSpan(*this, out);
+  }
+
+private:
+  // A compiled instruction, its account indexes and data live in the pools
+  struct Entry
+  {
+    uint8_t programIdIndex;
+    uint16_t accountsOffset;
+    uint16_t numAccounts;
+    uint16_t dataOffset;
+    uint16_t dataLen;
+  };
+
+  void clear()
+  {
+    messageHeader = MessageHeader{0, 0, 0};
+    numKeys = 0;
+    instructionCount = 0;
+  }
+
+  MessageHeader messageHeader = {0, 0, 0};
+  PublicKey keys[MaxKeys];
+  size_t numKeys = 0;
+  Hash blockhash;
+  Entry entries[MaxInstructions];
+  size_t instructionCount = 0;
+  uint8_t accountIndexes[MaxAccountRefs];
+  uint8_t data[MaxDataBytes];
+};
+
+template <size_t MaxKeys, size_t MaxInstructions, size_t MaxDataBytes, size_t MaxAccountRefs>
+template <typename Instructions>
+Result<void> StaticMessage<MaxKeys, MaxInstructions, MaxDataBytes, MaxAccountRefs>::tryCompile(const Instructions &instructions, const PublicKey &payer, const Hash &recentBlockhash)
+{
+  static_assert(StaticCapacity<Instructions>::value <= MaxInstructions, "More instructions than MaxInstructions");
+
+  this->clear();
+
+  // Distinct keys with the rank of their group in the compiled order:
+  // payer, writable signers, readonly signers, writable and then readonly
+  // non-signers
+  struct RankedKey
+  {
+    PublicKey key;
+    bool isSigner;
+    bool isWritable;
+    uint8_t rank;
+  };
+  RankedKey ranked[MaxKeys];
+  size_t count = 1;
+  ranked[0] = RankedKey{payer, true, true, 0};
+
+  auto touch = [&](const PublicKey &key, bool isSigner, bool isWritable) -> bool
+  {
+    for (size_t i = 0; i < count; ++i)
+    {
+      if (ranked[i].key == key)
+      {
+        ranked[i].isSigner |= isSigner;
+        ranked[i].isWritable |= isWritable;
+        return true;
+      }
+    }
+    if (count == MaxKeys)
+    {
+      return false;
+    }
+    ranked[count++] = RankedKey{key, isSigner, isWritable, 0};
+    return true;
+  };
+
+  size_t numInstructions = 0;
+  size_t numAccountRefs = 0;
+  size_t numDataBytes = 0;
+  for (const auto &instruction : instructions)
+  {
+    bool fits = touch(instruction.programId, false, false);
+    for (const AccountMeta &account : instruction.accounts)
+    {
+      fits = fits && touch(account.publicKey, account.isSigner, account.isWritable);
+    }
+    if (!fits)
+    {
+      return Error("More account keys than MaxKeys");
+    }
+    ++numInstructions;
+    numAccountRefs += instruction.accounts.size();
+    numDataBytes += instruction.data.size();
+  }
+  if (numInstructions > MaxInstructions)
+  {
+    return Error("More instructions than MaxInstructions");
+  }
+  if (numAccountRefs > MaxAccountRefs)
+  {
+    return Error("More account indexes than MaxAccountRefs");
+  }
+  if (numDataBytes > MaxDataBytes)
+  {
+    return Error("More instruction data than MaxDataBytes");
+  }
+
+  // Within a group keys are in ascending order, as with CompiledKeys' map
+  for (size_t i = 1; i < count; ++i)
+  {
+    ranked[i].rank = ranked[i].isSigner ? (ranked[i].isWritable ? 1 : 2) : (ranked[i].isWritable ? 3 : 4);
+  }
+  std::sort(ranked + 1, ranked + count, [](const RankedKey &a, const RankedKey &b)
+            { return a.rank != b.rank ? a.rank < b.rank : a.key < b.key; });
+
+  MessageHeader header = {0, 0, 0};
+  for (size_t i = 0; i < count; ++i)
+  {
+    this->keys[i] = ranked[i].key;
+    header.numRequiredSignatures += ranked[i].isSigner;
+    header.numReadonlySignedAccounts += ranked[i].isSigner && !ranked[i].isWritable;
+    header.numReadonlyUnsignedAccounts += !ranked[i].isSigner && !ranked[i].isWritable;
+  }
+
+  auto indexOf = [&](const PublicKey &key)
+  {
+    return static_cast<uint8_t>(std::find(this->keys, this->keys + count, key) - this->keys);
+  };
+
+  size_t accountsOffset = 0;
+  size_t dataOffset = 0;
+  size_t index = 0;
+  for (const auto &instruction : instructions)
+  {
+    Entry &entry = this->entries[index++];
+    entry.programIdIndex = indexOf(instruction.programId);
+    entry.accountsOffset = static_cast<uint16_t>(accountsOffset);
+    entry.numAccounts = static_cast<uint16_t>(instruction.accounts.size());
+    for (const AccountMeta &account : instruction.accounts)
+    {
+      this->accountIndexes[accountsOffset++] = indexOf(account.publicKey);
+    }
+    entry.dataOffset = static_cast<uint16_t>(dataOffset);
+    entry.dataLen = static_cast<uint16_t>(instruction.data.size());
+    std::copy(instruction.data.begin(), instruction.data.end(), this->data + dataOffset);
+    dataOffset += instruction.data.size();
+  }
+
+  this->messageHeader = header;
+  this->numKeys = count;
+  this->instructionCount = numInstructions;
+  this->blockhash = recentBlockhash;
+  return {};
+}
+
+template <size_t MaxKeys, size_t MaxInstructions, size_t MaxDataBytes, size_t MaxAccountRefs>
+void StaticMessage<MaxKeys, MaxInstructions, MaxDataBytes, MaxAccountRefs>::serialize(ByteSink &sink) const
+{
+  // Same layout as Message::serialize
+  sink.write(static_cast<uint8_t>(128));
+  sink.write(this->messageHeader.numRequiredSignatures);
+  sink.write(this->messageHeader.numReadonlySignedAccounts);
+  sink.write(this->messageHeader.numReadonlyUnsignedAccounts);
+
+  sink.writeLength(this->numKeys);
+  for (size_t i = 0; i < this->numKeys; ++i)
+  {
+    sink.write(this->keys[i].key, PUBLIC_KEY_LEN);
+  }
+
+  sink.write(this->blockhash.data.data(), HASH_BYTES);
+
+  sink.writeLength(this->instructionCount);
+  for (size_t i = 0; i < this->instructionCount; ++i)
+  {
+    const Entry &entry = this->entries[i];
+    sink.write(entry.programIdIndex);
+    sink.writeLength(entry.numAccounts);
+    sink.write(this->accountIndexes + entry.accountsOffset, entry.numAccounts);
+    sink.writeLength(entry.dataLen);
+    sink.write(this->data + entry.dataOffset, entry.dataLen);
+  }
+
+  // No address table lookups
+  sink.writeLength(0);
+}
+
+template <size_t MaxKeys, size_t MaxInstructions, size_t MaxDataBytes, size_t MaxAccountRefs>
+size_t StaticMessage<MaxKeys, MaxInstructions, MaxDataBytes, MaxAccountRefs>::serializedSize() const
+{
+  size_t size = 4 + shortVecSize(this->numKeys, PUBLIC_KEY_LEN) + HASH_BYTES + shortVecSize(this->instructionCount, 0);
+  for (size_t i = 0; i < this->instructionCount; ++i)
+  {
+    size += 1 + shortVecSize(this->entries[i].numAccounts, 1) + shortVecSize(this->entries[i].dataLen, 1);
+  }
+  return size + shortVecSize(0, 0);
+}
+
+// A Transaction over a StaticMessage with inline room for MaxSigners
+// signatures. Signing serializes the message into a stack buffer and signs
+// it with the keypairs directly, so a device can build, sign and serialize
+// transactions in a loop without ever touching the heap.
+template <size_t MaxKeys, size_t MaxInstructions, size_t MaxDataBytes, size_t MaxSigners = 1, size_t MaxAccountRefs = MaxKeys * MaxInstructions>
+class StaticTransaction
+{
+  static_assert(MaxSigners >= 1 && MaxSigners <= MaxKeys, "Signers are among the account keys, the payer first");
+
+public:
+  using MessageType = StaticMessage<MaxKeys, MaxInstructions, MaxDataBytes, MaxAccountRefs>;
+
+  // Serialized length of a transaction filled to capacity
+  static constexpr size_t MAX_SERIALIZED_SIZE = ShortVec::MAX_ENCODED_LEN + MaxSigners * SIGNATURE_BYTES + MessageType::MAX_SERIALIZED_SIZE;
+
+  // Compile the message as StaticMessage::tryCompile and clear the
+  // signatures. Fails when it needs more than MaxSigners signatures.
+  template <typename Instructions>
+  Result<void> tryCompile(const Instructions &instructions, const PublicKey &payer, const Hash &recentBlockhash)
+  {
+    Result<void> compiled = this->staticMessage.tryCompile(instructions, payer, recentBlockhash);
+    if (!compiled)
+    {
+      this->numSignatures = 0;
+      return compiled;
+    }
+    if (this->staticMessage.header().numRequiredSignatures > MaxSigners)
+    {
+      this->numSignatures = 0;
+      return Error("More signers than MaxSigners");
+    }
+    this->numSignatures = this->staticMessage.header().numRequiredSignatures;
+    this->clearSignatures();
+    return {};
+  }
+
+  // As tryCompile, throwing CompileError
+  template <typename Instructions>
+  void compile(const Instructions &instructions, const PublicKey &payer, const Hash &recentBlockhash)
+  {
+    valueOrThrow<CompileError>(this->tryCompile(instructions, payer, recentBlockhash));
+  }
+
+  const MessageType &message() const { return staticMessage; }
+
+  size_t signatureCount() const { return numSignatures; }
+
+  const Signature &signature(size_t index) const { return signatures[index]; }
+
+  // Sign with `keypairs`, which must all be signers of the message, and
+  // require every signature to be present afterwards
+  Result<void> trySign(Span<Keypair> keypairs, const Hash &recentBlockhash)
+  {
+    Result<void> signResult = this->tryPartialSign(keypairs, recentBlockhash);
+    if (!signResult)
+    {
+      return signResult;
+    }
+    for (size_t i = 0; i < this->numSignatures; ++i)
+    {
+      if (!(this->signatures[i] != Signature()))
+      {
+        return Error("Not enough signers");
+      }
+    }
+    return {};
+  }
+
+  // Sign with a subset of the signers. A new blockhash drops the
+  // signatures made over the old one.
+  Result<void> tryPartialSign(Span<Keypair> keypairs, const Hash &recentBlockhash)
+  {
+    size_t positions[MaxSigners];
+    if (keypairs.size() > MaxSigners)
+    {
+      return Error("More keypairs than MaxSigners");
+    }
+    for (size_t k = 0; k < keypairs.size(); ++k)
+    {
+      const PublicKey *first = &this->staticMessage.accountKey(0);
+      const PublicKey *signer = std::find(first, first + this->numSignatures, keypairs[k].publicKey);
+      if (signer == first + this->numSignatures)
+      {
+        return Error("Keypair public key mismatch");
+      }
+      positions[k] = signer - first;
+    }
+
+    if (recentBlockhash != this->staticMessage.recentBlockhash())
+    {
+      this->staticMessage.setRecentBlockhash(recentBlockhash);
+      this->clearSignatures();
+    }
+
+    uint8_t messageBytes[MessageType::MAX_SERIALIZED_SIZE];
+    SpanSink sink(messageBytes);
+    this->staticMessage.serialize(sink);
+    for (size_t k = 0; k < keypairs.size(); ++k)
+    {
+      crypto_sign_ed25519_detached(this->signatures[positions[k]].value.data(), nullptr, messageBytes, sink.size(), keypairs[k].getSecretKey());
+    }
+    return {};
+  }
+
+  // Check every signature against its signer
+  Result<void> tryVerify() const
+  {
+    uint8_t messageBytes[MessageType::MAX_SERIALIZED_SIZE];
+    SpanSink sink(messageBytes);
+    this->staticMessage.serialize(sink);
+    for (size_t i = 0; i < this->numSignatures; ++i)
+    {
+      Result<void> verified = this->signatures[i].tryVerify(this->staticMessage.accountKey(i).key, messageBytes, sink.size());
+      if (!verified)
+      {
+        return verified;
+      }
+    }
+    return {};
+  }
+
+  void serialize(ByteSink &sink) const
+  {
+    sink.writeLength(this->numSignatures);
+    for (size_t i = 0; i < this->numSignatures; ++i)
+    {
+      sink.write(this->signatures[i].value.data(), SIGNATURE_BYTES);
+    }
+    this->staticMessage.serialize(sink);
+  }
+
+  // Exact length of the serialized transaction
+  size_t serializedSize() const
+  {
+    return shortVecSize(this->numSignatures, SIGNATURE_BYTES) + this->staticMessage.serializedSize();
+  }
+
+  // Serialize into `out`, returns the number of bytes written
+  Result<size_t> serializeInto(Span<uint8_t> out) const
+  {
+    return serializeToSpan(*this, out);
+  }
+
+private:
+  void clearSignatures()
+  {
+    std::fill(this->signatures, this->signatures + MaxSigners, Signature());
+  }
+
+  MessageType staticMessage;
+  Signature signatures[MaxSigners];
+  size_t numSignatures = 0;
+};
+
+#endif // STATIC_TRANSACTION_H
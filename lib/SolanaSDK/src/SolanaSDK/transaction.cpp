@@ -10,22 +10,32 @@
 #include "instruction.h"
 #include "compiled_keys.h"
 #include "signer.h"
+#include "byte_sink.h"
+#include "transaction_view.h"
+#include "worker_pool.h"
 
 // Create an unsigned transaction from a Message.
 Transaction::Transaction(Message message)
-    : message(message), signatures(message.header.numRequiredSignatures, Signature()) {}
+    : signatures(message.header.numRequiredSignatures, Signature(), message.accountKeys.get_allocator()),
+      message(std::move(message)),
+      messageBytes(this->message.accountKeys.get_allocator()) {}
 
 void Transaction::sanitize()
+{
+  valueOrThrow<std::out_of_range>(this->trySanitize());
+}
+
+Result<void> Transaction::trySanitize()
 {
   if (this->message.header.numRequiredSignatures > this->signatures.size())
   {
-    throw std::out_of_range("Number of required signatures exceeds the number of signatures");
+    return Error("Number of required signatures exceeds the number of signatures");
   }
   if (this->signatures.size() > this->message.accountKeys.size())
   {
-    throw std::out_of_range("Number of signatures exceeds the number of account keys");
+    return Error("Number of signatures exceeds the number of account keys");
   }
-  this->message.sanitize();
+  return this->message.trySanitize();
 }
 
 // Create an unsigned transaction from a Message.
@@ -35,7 +45,7 @@ Transaction Transaction::newUnsigned(Message message)
 }
 
 // Create a fully-signed transaction from a Message
-Transaction Transaction::create(std::vector<Signer> &fromKeypairs, Message message, Hash recent_blockhash)
+Transaction Transaction::create(std::vector<KeypairSigner> &fromKeypairs, Message message, Hash recent_blockhash)
 {
   Transaction tx = this->newUnsigned(message);
   // TODO: add sign
@@ -50,14 +60,14 @@ Transaction Transaction::newWithPayer(std::vector<Instruction> &instructions, st
 }
 
 // Create a fully-signed transaction from a list of Instructions
-Transaction Transaction::createSignedWithPayer(std::vector<Instruction> &instructions, std::optional<PublicKey> &payer, std::vector<Signer> &signingKeypairs, Hash recentBlockhash)
+Transaction Transaction::createSignedWithPayer(std::vector<Instruction> &instructions, std::optional<PublicKey> &payer, std::vector<KeypairSigner> &signingKeypairs, Hash recentBlockhash)
 {
   Message message = Message(instructions, payer);
   return this->create(signingKeypairs, message, recentBlockhash);
 }
 
 // Create a fully-signed transaction from pre-compiled instructions.
-Transaction Transaction::createWithCompiledInstructions(std::vector<Signer> &fromKeypairs, std::vector<PublicKey> &keys, Hash recentBlockhash, std::vector<PublicKey> programIds, std::vector<CompiledInstruction> instructions)
+Transaction Transaction::createWithCompiledInstructions(std::vector<KeypairSigner> &fromKeypairs, std::vector<PublicKey> &keys, Hash recentBlockhash, std::vector<PublicKey> programIds, std::vector<CompiledInstruction> instructions)
 {
   std::vector<PublicKey> accountKeys;
 
@@ -84,12 +94,13 @@ Transaction Transaction::createWithCompiledInstructions(std::vector<Signer> &fro
 // Get the data for an instruction at the given index.
 std::vector<uint8_t> Transaction::data(size_t instructionIndex)
 {
-  return this->message.instructions[instructionIndex].data;
+  const ArenaVector<uint8_t> &data = this->message.instructions[instructionIndex].data;
+  return std::vector<uint8_t>(data.begin(), data.end());
 }
 
 std::optional<size_t> Transaction::keyIndex(size_t instructionIndex, size_t accountsIndex)
 {
-  CompiledInstruction ix = this->message.instructions.at(instructionIndex);
+  const CompiledInstruction &ix = this->message.instructions.at(instructionIndex);
   size_t accountKeysIndex = ix.accounts.at(accountsIndex);
   return accountKeysIndex;
 }
@@ -122,27 +133,32 @@ std::optional<PublicKey> Transaction::signerKey(size_t instructionIndex, size_t
 }
 
 // Return the message containing all data that should be signed.
-Message Transaction::getMessage()
+const Message &Transaction::getMessage() const
 {
   return this->message;
 }
 
 // Return the serialized message data to sign.
-std::vector<uint8_t> Transaction::messageData()
+const ArenaVector<uint8_t> &Transaction::messageData() const
 {
-  return this->getMessage().serialize();
+  if (!this->messageBytesValid)
+  {
+    this->messageBytes.clear();
+    this->messageBytes.reserve(this->message.serializedSize());
+    VectorSink sink(this->messageBytes);
+    this->message.serialize(sink);
+    this->messageBytesValid = true;
+  }
+  return this->messageBytes;
 }
 
 // Sign the transaction.
 Transaction Transaction::sign(Signers &keypairs, Hash recentBlockhash)
 {
-  try
-  {
-    this->trySign(keypairs, recentBlockhash);
-  }
-  catch (std::exception &e)
+  Result<void> signResult = this->trySign(keypairs, recentBlockhash);
+  if (!signResult)
   {
-    throw std::runtime_error("Transaction::sign failed with error " + std::string(e.what()));
+    SOLANA_THROW(std::runtime_error("Transaction::sign failed with error " + std::string(signResult.error().what())));
   }
   return *this;
 }
@@ -150,65 +166,94 @@ Transaction Transaction::sign(Signers &keypairs, Hash recentBlockhash)
 // Sign the transaction with a subset of required keys.
 void Transaction::partialSign(Signers &keypairs, Hash recentBlockhash)
 {
-  try
-  {
-    this->tryPartialSign(keypairs, recentBlockhash);
-  }
-  catch (std::exception &e)
+  Result<void> signResult = this->tryPartialSign(keypairs, recentBlockhash);
+  if (!signResult)
   {
-    throw std::runtime_error("Transaction::partialSign failed with error " + std::string(e.what()));
+    SOLANA_THROW(std::runtime_error("Transaction::partialSign failed with error " + std::string(signResult.error().what())));
   }
 }
 
 // Sign the transaction, returning any errors.
-void Transaction::trySign(Signers &keypairs, Hash recentBlockhash)
+Result<void> Transaction::trySign(Signers &keypairs, Hash recentBlockhash)
 {
-  this->tryPartialSign(keypairs, recentBlockhash);
+  Result<void> signResult = this->tryPartialSign(keypairs, recentBlockhash);
+  if (!signResult)
+  {
+    return signResult;
+  }
 
   if (!this->isSigned())
   {
-    throw std::runtime_error("Not enough signers");
+    return Error("Not enough signers");
   }
+  return {};
 }
 
 // Sign the transaction with a subset of required keys, returning any errors.
-void Transaction::tryPartialSign(Signers &keypairs, Hash recentBlockhash)
+Result<void> Transaction::tryPartialSign(Signers &keypairs, Hash recentBlockhash)
 {
-  std::vector<PublicKey> keys = keypairs.publicKeys();
-  std::vector<std::optional<size_t>> positions = this->getSigningKeypairPositions(keys);
-  std::vector<size_t> positionsVec;
-  for (auto pos : positions)
+  if (this->message.accountKeys.size() < this->message.header.numRequiredSignatures)
   {
-    if (!pos.has_value())
+    return Error("Invalid account index");
+  }
+
+  // Check every signer before signing, so a mismatch leaves the
+  // signatures untouched
+  for (size_t i = 0; i < keypairs.size(); ++i)
+  {
+    if (!this->signerPosition(keypairs.signers[i]->publicKey()).has_value())
+    {
+      return Error("Keypair public key mismatch");
+    }
+  }
+
+  this->resetSignaturesOnNewBlockhash(recentBlockhash);
+  const ArenaVector<uint8_t> &messageBytes = this->messageData();
+  for (size_t i = 0; i < keypairs.size(); ++i)
+  {
+    Result<Signature> signature = keypairs.trySignMessage(i, messageBytes);
+    if (!signature)
     {
-      throw std::runtime_error("Keypair public key mismatch");
+      return signature.error();
     }
-    positionsVec.push_back(pos.value());
+    this->signatures[this->signerPosition(keypairs.signers[i]->publicKey()).value()] = signature.value();
   }
-  this->tryPartialSignUnchecked(keypairs, positionsVec, recentBlockhash);
+  return {};
 }
 
 // Sign the transaction with a subset of required keys, returning any
 // errors.
 void Transaction::tryPartialSignUnchecked(Signers &keypairs, std::vector<size_t> positions, Hash recentBlockhash)
+{
+  this->resetSignaturesOnNewBlockhash(recentBlockhash);
+  const ArenaVector<uint8_t> &messageBytes = this->messageData();
+  for (size_t i = 0; i < positions.size(); i++)
+  {
+    this->signatures[positions[i]] = valueOrThrow<std::runtime_error>(keypairs.trySignMessage(i, messageBytes));
+  }
+}
+
+void Transaction::resetSignaturesOnNewBlockhash(const Hash &recentBlockhash)
 {
   //  if you change the blockhash, you're re-signing...
   if (recentBlockhash != this->message.recentBlockhash)
   {
     this->message.recentBlockhash = recentBlockhash;
+    this->messageBytesValid = false;
 
     for (auto &signature : this->signatures)
     {
       signature = Signature();
     }
   }
+}
 
-  std::vector<Signature> signatures = keypairs.signMessage(this->messageData());
-
-  for (int i = 0; i < positions.size(); i++)
-  {
-    this->signatures[positions[i]] = signatures[i];
-  }
+std::optional<size_t> Transaction::signerPosition(const PublicKey &publicKey) const
+{
+  const auto first = this->message.accountKeys.begin();
+  const auto last = first + this->message.header.numRequiredSignatures;
+  const auto it = std::find(first, last, publicKey);
+  return it != last ? std::optional<size_t>(it - first) : std::nullopt;
 }
 
 // Get the positions of the public keys in accountKeys associated with signing keypairs.
@@ -216,7 +261,7 @@ std::vector<std::optional<size_t>> Transaction::getSigningKeypairPositions(std::
 {
   if (this->message.accountKeys.size() < this->message.header.numRequiredSignatures)
   {
-    throw std::runtime_error("Invalid account index");
+    SOLANA_THROW(std::runtime_error("Invalid account index"));
   }
 
   std::vector<PublicKey> signedKeys(this->message.accountKeys.begin(), this->message.accountKeys.begin() + this->message.header.numRequiredSignatures);
@@ -251,110 +296,218 @@ Signature Transaction::getInvalidSignature()
 }
 
 // Verifies that all signers have signed the message.
-void Transaction::verify()
+void Transaction::verify() const
 {
-  std::vector<uint8_t> messageBytes = this->messageData();
-  std::vector<bool> verifyResults = this->_verifyWithResults(messageBytes);
-  for (auto verifyResult : verifyResults)
+  valueOrThrow<std::runtime_error>(this->tryVerify());
+}
+
+Result<void> Transaction::tryVerify() const
+{
+  Result<std::vector<bool>> verifyResults = this->_verifyWithResults(this->messageData());
+  if (!verifyResults)
+  {
+    return verifyResults.error();
+  }
+  for (auto verifyResult : verifyResults.value())
   {
     if (!verifyResult)
     {
-      throw std::runtime_error("Signature failure");
+      return Error("Signature failure");
     }
   }
+  return {};
 }
 
 // Verify the transaction and hash its message.
-Hash Transaction::verifyAndHashMessage()
+Hash Transaction::verifyAndHashMessage() const
 {
-  std::vector<uint8_t> messageData = this->messageData();
-  std::vector<bool> verifyResults = this->_verifyWithResults(messageData);
+  return valueOrThrow<std::runtime_error>(this->tryVerifyAndHashMessage());
+}
 
-  if (std::all_of(verifyResults.begin(), verifyResults.end(), [](bool v)
+Result<Hash> Transaction::tryVerifyAndHashMessage() const
+{
+  const ArenaVector<uint8_t> &messageData = this->messageData();
+  Result<std::vector<bool>> verifyResults = this->_verifyWithResults(messageData);
+  if (!verifyResults)
+  {
+    return verifyResults.error();
+  }
+
+  if (std::all_of(verifyResults.value().begin(), verifyResults.value().end(), [](bool v)
                   { return v; }))
   {
-    return Message::hashRawMessage(messageData);
+    return hashBytes(messageData.data(), messageData.size());
   }
   else
   {
-    throw std::runtime_error("Signature failure");
+    return Error("Signature failure");
   }
 }
 
 // Verifies that all signers have signed the message.
-std::vector<bool> Transaction::verifyWithResults()
+std::vector<bool> Transaction::verifyWithResults() const
+{
+  return valueOrThrow<std::runtime_error>(this->tryVerifyWithResults());
+}
+
+Result<std::vector<bool>> Transaction::tryVerifyWithResults() const
 {
   return this->_verifyWithResults(this->messageData());
 }
 
-std::vector<bool> Transaction::_verifyWithResults(const std::vector<uint8_t> &messageBytes)
+Result<std::vector<bool>> Transaction::_verifyWithResults(Span<const uint8_t> messageBytes) const
 {
-  std::vector<PublicKey> publicKeys = this->message.accountKeys;
-  if (this->signatures.size() != publicKeys.size())
+  std::vector<SignatureCheck> checks;
+  Result<void> appended = this->appendSignatureChecks(messageBytes, checks);
+  if (!appended)
   {
-    throw std::runtime_error("Mismatch between signatures and public keys");
+    return appended.error();
   }
+  return Signature::verifyBatch(checks);
+}
 
-  std::vector<bool> results;
-  for (size_t i = 0; i < this->signatures.size(); ++i)
+// Verifies the signatures of many transactions.
+std::vector<std::vector<bool>> Transaction::verifyManyWithResults(const std::vector<Transaction> &transactions)
+{
+  // A transaction whose signatures do not match its signers has none of
+  // them verified, it does not fail the others
+  std::vector<SignatureCheck> checks;
+  std::vector<bool> checked(transactions.size());
+  for (size_t i = 0; i < transactions.size(); ++i)
   {
-    try
-    {
-      std::vector<uint8_t> pubkeyBytes(publicKeys[i].key, publicKeys[i].key + PUBLIC_KEY_LEN);
-      this->signatures[i].verify(pubkeyBytes, messageBytes);
-      results.push_back(true);
-    }
-    catch (const std::runtime_error &e)
+    checked[i] = static_cast<bool>(transactions[i].appendSignatureChecks(transactions[i].messageData(), checks));
+  }
+
+  std::vector<bool> flat = Signature::verifyBatch(checks);
+  std::vector<std::vector<bool>> results;
+  results.reserve(transactions.size());
+  auto it = flat.begin();
+  for (size_t i = 0; i < transactions.size(); ++i)
+  {
+    const size_t numSignatures = transactions[i].signatures.size();
+    if (!checked[i])
     {
-      results.push_back(false);
+      results.emplace_back(numSignatures, false);
+      continue;
     }
+    results.emplace_back(it, it + numSignatures);
+    it += numSignatures;
   }
   return results;
 }
 
-// Serialize method
-std::vector<uint8_t> Transaction::serialize()
+std::vector<Result<void>> Transaction::signMany(Span<Transaction> transactions, Span<Signers> signers, Hash recentBlockhash, unsigned threads)
 {
-  std::vector<uint8_t> serializedTransaction;
+  return signBatch(transactions, signers.data(), signers.size(), 1, recentBlockhash, threads);
+}
 
-  // Serialize signatures length
-  uint8_t numSignatures = static_cast<uint8_t>(this->signatures.size());
-  serializedTransaction.push_back(numSignatures);
+std::vector<Result<void>> Transaction::signMany(Span<Transaction> transactions, Signers &signers, Hash recentBlockhash, unsigned threads)
+{
+  return signBatch(transactions, &signers, 1, 0, recentBlockhash, threads);
+}
+
+std::vector<Result<void>> Transaction::signBatch(Span<Transaction> transactions, Signers *signers, size_t numSigners, size_t stride, const Hash &recentBlockhash, unsigned threads)
+{
+  std::vector<Result<void>> results(transactions.size());
 
-  // Serialize each signature
-  for (auto signature : this->signatures)
+  // Every allocation happens here, on the calling thread: trySign then
+  // finds the blockhash set and the message bytes cached
+  for (auto &transaction : transactions)
   {
-    std::vector<uint8_t> serializedSignature = signature.serialize();
-    serializedTransaction.insert(serializedTransaction.end(), serializedSignature.begin(), serializedSignature.end());
+    transaction.resetSignaturesOnNewBlockhash(recentBlockhash);
+    transaction.messageData();
   }
 
-  // Serialize message
-  std::vector<uint8_t> serializedMessage = this->message.serialize();
-  serializedTransaction.insert(serializedTransaction.end(), serializedMessage.begin(), serializedMessage.end());
+  if (threads == 0)
+  {
+    threads = defaultWorkerCount();
+  }
+  threads = static_cast<unsigned>(std::min<size_t>(threads, std::max<size_t>(1, transactions.size())));
 
-  return serializedTransaction;
+  WorkStealingRange range(transactions.size(), threads);
+  auto body = [&](unsigned worker)
+  {
+    size_t begin, end;
+    while (range.claim(worker, begin, end))
+    {
+      for (size_t i = begin; i < end; ++i)
+      {
+        if (i * stride >= numSigners)
+        {
+          results[i] = Error("No signers for transaction");
+          continue;
+        }
+        results[i] = transactions[i].trySign(signers[i * stride], recentBlockhash);
+      }
+    }
+  };
+  runWorkers(threads, body);
+  return results;
 }
 
-// Deserialize method
-Transaction Transaction::deserialize(const std::vector<uint8_t> &data)
+Result<void> Transaction::appendSignatureChecks(Span<const uint8_t> messageBytes, std::vector<SignatureCheck> &checks) const
 {
-  size_t index = 0;
+  // The first numRequiredSignatures account keys are the signers, in
+  // signature order; the other accounts sign nothing
+  const ArenaVector<PublicKey> &publicKeys = this->message.accountKeys;
+  const size_t numSigners = this->message.header.numRequiredSignatures;
+  if (this->signatures.size() != numSigners || publicKeys.size() < numSigners)
+  {
+    return Error("Mismatch between signatures and public keys");
+  }
+
+  checks.reserve(checks.size() + numSigners);
+  for (size_t i = 0; i < numSigners; ++i)
+  {
+    checks.push_back({this->signatures[i].value.data(), publicKeys[i].key, messageBytes.data(), messageBytes.size()});
+  }
+  return {};
+}
 
-  // Deserialize message
-  Message message = Message::deserialize(data);
+// Serialize method
+std::vector<uint8_t> Transaction::serialize() const
+{
+  std::vector<uint8_t> serializedTransaction;
+  serializedTransaction.reserve(this->serializedSize());
+  VectorSink sink(serializedTransaction);
+  this->serialize(sink);
+  return serializedTransaction;
+}
 
-  // Deserialize signatures length
-  uint8_t numSignatures = data[index++];
+void Transaction::serialize(ByteSink &sink) const
+{
+  // Serialize signatures
+  sink.writeLength(this->signatures.size());
+  for (const auto &signature : this->signatures)
+  {
+    sink.write(signature.value.data(), SIGNATURE_BYTES);
+  }
 
-  // Deserialize signatures
-  std::vector<Signature> signatures;
-  for (int i = 0; i < numSignatures; ++i)
+  // Serialize message, from the cache when it holds the bytes, without
+  // filling it otherwise
+  if (this->messageBytesValid)
   {
-    Signature signature = Signature::deserialize(data);
-    signatures.push_back(signature);
+    sink.write(this->messageBytes.data(), this->messageBytes.size());
   }
+  else
+  {
+    this->message.serialize(sink);
+  }
+}
 
-  // TODO: Add Signatures Constructor
+size_t Transaction::serializedSize() const
+{
+  const size_t messageSize = this->messageBytesValid ? this->messageBytes.size() : this->message.serializedSize();
+  return shortVecSize(this->signatures.size(), SIGNATURE_BYTES) + messageSize;
+}
 
-  return Transaction(message);
+Result<size_t> Transaction::serializeInto(Span<uint8_t> out) const
+{
+  return serializeToSpan(*this, out);
+}
+
+// Deserialize method
+Transaction Transaction::deserialize(const std::vector<uint8_t> &data)
+{
+  return valueOrThrow<std::invalid_argument>(TransactionView::parse(data)).toTransaction();
 }
@@ -12,6 +12,11 @@
 #include "instruction.h"
 #include "compiled_keys.h"
 #include "signer.h"
+#include "result.h"
+#include "arena.h"
+
+// Maximum over-the-wire size of a Transaction
+constexpr size_t PACKET_DATA_SIZE = 1232;
 
 class Transaction
 {
@@ -19,23 +24,24 @@ public:
   // A set of signatures of a serialized Message, signed by the first
   // keys of the Message's accountKeys, where the number of signatures
   // is equal to numRequiredSignatures of the Message's MessageHeader
-  std::vector<Signature> signatures;
-
-  // the message to sign
-  Message message;
+  ArenaVector<Signature> signatures;
 
+  // The signatures and the cached message bytes allocate from the resource
+  // of the message's accountKeys, so moving a message compiled in an arena
+  // keeps the whole transaction there
   Transaction(Message message);
   void sanitize();
+  Result<void> trySanitize();
 
   static Transaction newUnsigned(Message message);
 
-  Transaction create(std::vector<Signer> &fromKeypairs, Message message, Hash recent_blockhash);
+  Transaction create(std::vector<KeypairSigner> &fromKeypairs, Message message, Hash recent_blockhash);
 
   Transaction newWithPayer(std::vector<Instruction> &instructions, std::optional<PublicKey> &payer);
 
-  Transaction createSignedWithPayer(std::vector<Instruction> &instructions, std::optional<PublicKey> &payer, std::vector<Signer> &signingKeypairs, Hash recentBlockhash);
+  Transaction createSignedWithPayer(std::vector<Instruction> &instructions, std::optional<PublicKey> &payer, std::vector<KeypairSigner> &signingKeypairs, Hash recentBlockhash);
 
-  Transaction createWithCompiledInstructions(std::vector<Signer> &fromKeypairs, std::vector<PublicKey> &keys, Hash recentBlockhash, std::vector<PublicKey> programIds, std::vector<CompiledInstruction> instructions);
+  Transaction createWithCompiledInstructions(std::vector<KeypairSigner> &fromKeypairs, std::vector<PublicKey> &keys, Hash recentBlockhash, std::vector<PublicKey> programIds, std::vector<CompiledInstruction> instructions);
 
   std::vector<uint8_t> data(size_t instructionIndex);
 
@@ -45,17 +51,31 @@ public:
 
   std::optional<PublicKey> signerKey(size_t instructionIndex, size_t accountsIndex);
 
-  Message getMessage();
+  // Return the message containing all data that should be signed.
+  const Message &getMessage() const;
+
+  // Change the message through edit(Message &), then drop the cached
+  // message bytes. The message is only reachable for writing inside the
+  // call, so the cache cannot go stale behind it.
+  template <typename Edit>
+  void modifyMessage(Edit &&edit)
+  {
+    edit(this->message);
+    this->messageBytesValid = false;
+  }
 
-  std::vector<uint8_t> messageData();
+  // The serialized message, cached until the message changes. The cache is
+  // not synchronized, share a Transaction across threads only as const
+  // after a first call.
+  const ArenaVector<uint8_t> &messageData() const;
 
   Transaction sign(Signers &keypairs, Hash recentBlockhash);
 
   void partialSign(Signers &keypairs, Hash recentBlockhash);
 
-  void trySign(Signers &keypairs, Hash recentBlockhash);
+  Result<void> trySign(Signers &keypairs, Hash recentBlockhash);
 
-  void tryPartialSign(Signers &keypairs, Hash recentBlockhash);
+  Result<void> tryPartialSign(Signers &keypairs, Hash recentBlockhash);
 
   void tryPartialSignUnchecked(Signers &keypairs, std::vector<size_t> positions, Hash recentBlockhash);
 
@@ -65,18 +85,79 @@ public:
 
   Signature getInvalidSignature();
 
-  void verify();
+  void verify() const;
+
+  Hash verifyAndHashMessage() const;
+
+  std::vector<bool> verifyWithResults() const;
+
+  // Non-throwing counterparts of verify, verifyAndHashMessage and
+  // verifyWithResults
+  Result<void> tryVerify() const;
+
+  Result<Hash> tryVerifyAndHashMessage() const;
+
+  Result<std::vector<bool>> tryVerifyWithResults() const;
+
+  // verifyWithResults for many transactions, batching the signatures of
+  // all of them together. A transaction whose signature count does not
+  // match its header gets all false rather than failing the call.
+  static std::vector<std::vector<bool>> verifyManyWithResults(const std::vector<Transaction> &transactions);
+
+  // trySign for many transactions, transactions[i] with signers[i], spread
+  // over `threads` workers (0 uses every core) that steal work from each
+  // other. The results are in the order of the transactions, and a failure
+  // only fails its own transaction. Messages are serialized on the calling
+  // thread first, so transactions may share an arena; the workers only hash
+  // and sign.
+  static std::vector<Result<void>> signMany(Span<Transaction> transactions, Span<Signers> signers, Hash recentBlockhash, unsigned threads = 0);
 
-  Hash verifyAndHashMessage();
+  // As above with the same signers for every transaction, such as a single
+  // fee payer. Their backends are called concurrently, which the Keypair
+  // based signers support.
+  static std::vector<Result<void>> signMany(Span<Transaction> transactions, Signers &signers, Hash recentBlockhash, unsigned threads = 0);
 
-  std::vector<bool> verifyWithResults();
+  // Serialize with a single allocation of serializedSize() bytes. The
+  // cached message bytes are copied when present, the message is written
+  // directly otherwise.
+  std::vector<uint8_t> serialize() const;
 
-  std::vector<uint8_t> serialize();
+  void serialize(ByteSink &sink) const;
+
+  // Exact length of the serialized transaction
+  size_t serializedSize() const;
+
+  // Serialize into `out` without allocating, returns the number of bytes
+  // written
+  Result<size_t> serializeInto(Span<uint8_t> out) const;
 
   static Transaction deserialize(const std::vector<uint8_t> &data);
 
 private:
-  std::vector<bool> _verifyWithResults(const std::vector<uint8_t> &messageBytes);
+  // Seeds the message bytes cache from the parsed bytes
+  friend class TransactionView;
+
+  // the message to sign
+  Message message;
+
+  // Serialized message, valid while messageBytesValid is set
+  mutable ArenaVector<uint8_t> messageBytes;
+  mutable bool messageBytesValid = false;
+
+  // Clear the signatures when `recentBlockhash` replaces the message's
+  void resetSignaturesOnNewBlockhash(const Hash &recentBlockhash);
+
+  // Index of the signature of `publicKey`, if it is a required signer
+  std::optional<size_t> signerPosition(const PublicKey &publicKey) const;
+
+  // signMany with signers[i * stride], a stride of 0 shares signers[0]
+  static std::vector<Result<void>> signBatch(Span<Transaction> transactions, Signers *signers, size_t numSigners, size_t stride, const Hash &recentBlockhash, unsigned threads);
+
+  Result<std::vector<bool>> _verifyWithResults(Span<const uint8_t> messageBytes) const;
+
+  // Append a check of every signature against `messageBytes`, which must
+  // outlive the checks
+  Result<void> appendSignatureChecks(Span<const uint8_t> messageBytes, std::vector<SignatureCheck> &checks) const;
 
   // TODO: get_nonce_pubkey_from_instruction, uses_durable_nonce,
   // replace_signatures, verify_precompiles,
@@ -0,0 +1,217 @@
+#include <algorithm>
+#include <cstring>
+#include "transaction_decoder.h"
+#include "short_vec.h"
+
+Result<size_t> TransactionDecoder::tryConsume(Span<const uint8_t> chunk)
+{
+  if (this->failure != nullptr)
+  {
+    return Error(this->failure);
+  }
+  this->current.reset();
+  if (this->stage == Stage::Complete)
+  {
+    this->len = 0;
+    this->stage = Stage::NumSignatures;
+  }
+
+  // A transaction that starts the chunk and ends inside it is parsed in
+  // place. When it does not parse, the framing below tells a transaction
+  // cut off by the end of the chunk from a malformed one.
+  if (this->len == 0)
+  {
+    size_t consumed = 0;
+    Result<TransactionView> view = TransactionView::parsePrefix(chunk, consumed);
+    if (view && consumed <= PACKET_DATA_SIZE)
+    {
+      this->current = view.value();
+      return consumed;
+    }
+  }
+
+  size_t pos = 0;
+  while (true)
+  {
+    if (this->pending > 0)
+    {
+      const size_t count = std::min(this->pending, chunk.size() - pos);
+      memcpy(this->buffer + this->len, chunk.data() + pos, count);
+      this->len += count;
+      this->pending -= count;
+      pos += count;
+      if (this->pending > 0)
+      {
+        return pos;
+      }
+    }
+
+    if (this->stage == Stage::NextInstruction)
+    {
+      if (this->instructionsLeft == 0)
+      {
+        this->stage = this->versioned ? Stage::NumLookups : Stage::Complete;
+      }
+      else
+      {
+        --this->instructionsLeft;
+        this->stage = Stage::ProgramIdIndex;
+      }
+      continue;
+    }
+    if (this->stage == Stage::NextLookup)
+    {
+      if (this->lookupsLeft == 0)
+      {
+        this->stage = Stage::Complete;
+        continue;
+      }
+      --this->lookupsLeft;
+      Result<void> skipped = this->skip(PUBLIC_KEY_LEN, Stage::NumWritable);
+      if (!skipped)
+      {
+        return skipped.error();
+      }
+      continue;
+    }
+    if (this->stage == Stage::Complete)
+    {
+      // Framing only found the end, parsing validates the rest
+      Result<TransactionView> view = TransactionView::parse(Span<const uint8_t>(this->buffer, this->len));
+      if (!view)
+      {
+        return this->fail(view.error());
+      }
+      this->current = view.value();
+      return pos;
+    }
+
+    if (pos == chunk.size())
+    {
+      return pos;
+    }
+    Result<void> consumed = this->consumeByte(chunk[pos++]);
+    if (!consumed)
+    {
+      return consumed.error();
+    }
+  }
+}
+
+Result<void> TransactionDecoder::consumeByte(uint8_t byte)
+{
+  if (this->len == PACKET_DATA_SIZE)
+  {
+    return this->fail(Error("Transaction larger than PACKET_DATA_SIZE"));
+  }
+  this->buffer[this->len++] = byte;
+
+  if (this->stage == Stage::MessagePrefix)
+  {
+    // The version prefix, or numRequiredSignatures of a legacy message
+    this->versioned = (byte & 0x80) != 0;
+    if (this->versioned && byte != 0x80)
+    {
+      return this->fail(Error("Unsupported message version"));
+    }
+    return this->skip(this->versioned ? 3 : 2, Stage::NumKeys);
+  }
+  if (this->stage == Stage::ProgramIdIndex)
+  {
+    this->stage = Stage::NumAccounts;
+    return {};
+  }
+
+  bool done = false;
+  Result<void> read = this->readLength(byte, done);
+  if (!read || !done)
+  {
+    return read;
+  }
+  switch (this->stage)
+  {
+  case Stage::NumSignatures:
+    return this->skip(this->length * SIGNATURE_BYTES, Stage::MessagePrefix);
+  case Stage::NumKeys:
+    return this->skip(this->length * PUBLIC_KEY_LEN + HASH_BYTES, Stage::NumInstructions);
+  case Stage::NumInstructions:
+    this->instructionsLeft = this->length;
+    this->stage = Stage::NextInstruction;
+    return {};
+  case Stage::NumAccounts:
+    return this->skip(this->length, Stage::DataLen);
+  case Stage::DataLen:
+    return this->skip(this->length, Stage::NextInstruction);
+  case Stage::NumLookups:
+    this->lookupsLeft = this->length;
+    this->stage = Stage::NextLookup;
+    return {};
+  case Stage::NumWritable:
+    return this->skip(this->length, Stage::NumReadonly);
+  case Stage::NumReadonly:
+    return this->skip(this->length, Stage::NextLookup);
+  default:
+    return this->fail(Error("Invalid decoder state"));
+  }
+}
+
+Result<void> TransactionDecoder::readLength(uint8_t byte, bool &done)
+{
+  // Same rules as ShortVec::decode
+  if ((this->lengthBytes > 0 && byte == 0) || (this->lengthBytes == ShortVec::MAX_ENCODED_LEN - 1 && byte > 0x03))
+  {
+    return this->fail(Error("Invalid length"));
+  }
+  if (this->lengthBytes == 0)
+  {
+    this->length = 0;
+  }
+  this->length |= uint32_t(byte & 0x7f) << (7 * this->lengthBytes);
+  ++this->lengthBytes;
+  done = (byte & 0x80) == 0;
+  if (done)
+  {
+    this->lengthBytes = 0;
+  }
+  return {};
+}
+
+Result<void> TransactionDecoder::skip(size_t count, Stage next)
+{
+  if (count > PACKET_DATA_SIZE - this->len)
+  {
+    return this->fail(Error("Transaction larger than PACKET_DATA_SIZE"));
+  }
+  this->pending = count;
+  this->stage = next;
+  return {};
+}
+
+Error TransactionDecoder::fail(Error error)
+{
+  this->failure = error.what();
+  return error;
+}
+
+Result<void> TransactionDecoder::finish() const
+{
+  if (this->failure != nullptr)
+  {
+    return Error(this->failure);
+  }
+  if (this->stage != Stage::Complete && this->len > 0)
+  {
+    return Error("Truncated transaction");
+  }
+  return {};
+}
+
+void TransactionDecoder::reset()
+{
+  this->len = 0;
+  this->stage = Stage::NumSignatures;
+  this->pending = 0;
+  this->lengthBytes = 0;
+  this->current.reset();
+  this->failure = nullptr;
+}
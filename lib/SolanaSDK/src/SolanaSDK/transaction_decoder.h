@@ -0,0 +1,116 @@
+#ifndef TRANSACTION_DECODER_H
+#define TRANSACTION_DECODER_H
+
+#include <cstddef>
+#include <cstdint>
+#include <optional>
+#include "transaction.h"
+#include "transaction_view.h"
+#include "span.h"
+#include "result.h"
+
+// Incremental decoder of serialized transactions stored back to back, as in
+// a dump file or an HTTP body read in chunks of any size. It tracks where
+// the current transaction ends across chunk boundaries, byte by byte
+// through the length prefixes and in bulk through keys, signatures and
+// data, and hands out each transaction as a TransactionView as soon as its
+// last byte arrives.
+//
+// Memory is bounded by one PACKET_DATA_SIZE buffer, used only for a
+// transaction split across chunks; those wholly inside a chunk are parsed
+// in place. Larger transactions are rejected. After an error the stream
+// cannot be resynchronized, the decoder keeps failing until reset.
+class TransactionDecoder
+{
+public:
+  // Decode the transactions in `chunk`, calling
+  // onTransaction(const TransactionView &) for each. The view points into
+  // `chunk` or the decoder and is only valid during the call. Returns the
+  // number of transactions decoded.
+  template <typename OnTransaction>
+  Result<size_t> feed(Span<const uint8_t> chunk, OnTransaction &&onTransaction)
+  {
+    size_t count = 0;
+    while (!chunk.empty())
+    {
+      Result<size_t> consumed = this->tryConsume(chunk);
+      if (!consumed)
+      {
+        return consumed.error();
+      }
+      chunk = chunk.subspan(consumed.value());
+      if (this->current)
+      {
+        onTransaction(*this->current);
+        ++count;
+      }
+    }
+    return count;
+  }
+
+  // Consume the bytes of `chunk` up to the end of the next transaction,
+  // returns how many were consumed. When that completes a transaction,
+  // transaction() views it until the next call.
+  Result<size_t> tryConsume(Span<const uint8_t> chunk);
+
+  // The transaction completed by the last tryConsume, if any
+  const std::optional<TransactionView> &transaction() const { return current; }
+
+  // Check that the input ended on a transaction boundary
+  Result<void> finish() const;
+
+  // Drop the buffered bytes and any error, to decode a new stream
+  void reset();
+
+  // Bytes of the incomplete transaction received so far
+  size_t bufferedBytes() const { return stage == Stage::Complete ? 0 : len; }
+
+private:
+  // The field expected next. Length prefixes and single bytes are read as
+  // they arrive, the bytes they announce are then copied in bulk.
+  enum class Stage : uint8_t
+  {
+    NumSignatures,
+    MessagePrefix,
+    NumKeys,
+    NumInstructions,
+    NextInstruction,
+    ProgramIdIndex,
+    NumAccounts,
+    DataLen,
+    NumLookups,
+    NextLookup,
+    NumWritable,
+    NumReadonly,
+    Complete,
+  };
+
+  // Copy the next `count` bytes, then continue at `next`
+  Result<void> skip(size_t count, Stage next);
+
+  // Handle one byte of the current stage
+  Result<void> consumeByte(uint8_t byte);
+
+  // Accumulate one byte of a compact-u16, sets `done` with the value in
+  // `length` once its last byte is read
+  Result<void> readLength(uint8_t byte, bool &done);
+
+  // Record `error`, which every later call returns until reset
+  Error fail(Error error);
+
+  uint8_t buffer[PACKET_DATA_SIZE];
+  size_t len = 0;
+
+  Stage stage = Stage::NumSignatures;
+  size_t pending = 0;
+  uint32_t length = 0;
+  unsigned lengthBytes = 0;
+  bool versioned = false;
+  size_t instructionsLeft = 0;
+  size_t lookupsLeft = 0;
+
+  std::optional<TransactionView> current;
+  const char *failure = nullptr;
+};
+
+#endif // TRANSACTION_DECODER_H
@@ -0,0 +1,185 @@
+#include <cstddef>
+#include <vector>
+#include "transaction_size.h"
+#include "short_vec.h"
+#include "signature.h"
+
+namespace
+{
+  // Index into Counts::byKind
+  size_t kindOf(bool isSigner, bool isWritable)
+  {
+    return (isSigner ? 2 : 0) + (isWritable ? 1 : 0);
+  }
+
+  // Compiled length of an instruction: program index, then the account
+  // indexes and the data, each behind a compact-u16 length
+  size_t compiledSize(const Instruction &instruction)
+  {
+    return 1 + shortVecSize(instruction.accounts.size(), 1) + shortVecSize(instruction.data.size(), 1);
+  }
+}
+
+TransactionSizeEstimator::TransactionSizeEstimator(const PublicKey &payer) : payer(payer)
+{
+  this->clear();
+}
+
+void TransactionSizeEstimator::clear()
+{
+  this->keys.clear();
+  this->keys[this->payer] = KeyFlags{true, true};
+  this->counts = Counts{{0, 0, 0, 1}, 1};
+  this->instructionCount = 0;
+  this->instructionsSize = 0;
+}
+
+TransactionSizeEstimator::Counts TransactionSizeEstimator::stage(const Instruction &instruction) const
+{
+  this->staged.clear();
+  auto touch = [this](const PublicKey &key, bool isSigner, bool isWritable)
+  {
+    // Instructions name few accounts, a linear search dedups them
+    for (StagedKey &entry : this->staged)
+    {
+      if (*entry.key == key)
+      {
+        entry.after.isSigner |= isSigner;
+        entry.after.isWritable |= isWritable;
+        return;
+      }
+    }
+    StagedKey entry{&key, true, KeyFlags{false, false}, KeyFlags{isSigner, isWritable}};
+    auto existing = this->keys.find(key);
+    if (existing != this->keys.end())
+    {
+      entry.isNew = false;
+      entry.before = existing->second;
+      entry.after.isSigner |= existing->second.isSigner;
+      entry.after.isWritable |= existing->second.isWritable;
+    }
+    this->staged.push_back(entry);
+  };
+
+  touch(instruction.programId, false, false);
+  for (const AccountMeta &account : instruction.accounts)
+  {
+    touch(account.publicKey, account.isSigner, account.isWritable);
+  }
+
+  Counts next = this->counts;
+  for (const StagedKey &entry : this->staged)
+  {
+    if (entry.isNew)
+    {
+      ++next.numKeys;
+    }
+    else
+    {
+      --next.byKind[kindOf(entry.before.isSigner, entry.before.isWritable)];
+    }
+    ++next.byKind[kindOf(entry.after.isSigner, entry.after.isWritable)];
+  }
+  return next;
+}
+
+void TransactionSizeEstimator::commit(const Instruction &instruction, const Counts &next)
+{
+  for (const StagedKey &entry : this->staged)
+  {
+    this->keys[*entry.key] = entry.after;
+  }
+  this->counts = next;
+  ++this->instructionCount;
+  this->instructionsSize += compiledSize(instruction);
+}
+
+size_t TransactionSizeEstimator::sizeOf(const Counts &counts, size_t numInstructions, size_t instructionsSize)
+{
+  const size_t numSigners = counts.byKind[kindOf(true, false)] + counts.byKind[kindOf(true, true)];
+  // Signatures, then the message as Message::serialize writes it: version
+  // prefix, header, keys, blockhash, instructions and no table lookups
+  return shortVecSize(numSigners, SIGNATURE_BYTES) +
+         4 +
+         shortVecSize(counts.numKeys, PUBLIC_KEY_LEN) +
+         HASH_BYTES +
+         shortVecSize(numInstructions, 0) + instructionsSize +
+         shortVecSize(0, 0);
+}
+
+size_t TransactionSizeEstimator::size() const
+{
+  return sizeOf(this->counts, this->instructionCount, this->instructionsSize);
+}
+
+size_t TransactionSizeEstimator::sizeWith(const Instruction &instruction) const
+{
+  return sizeOf(this->stage(instruction), this->instructionCount + 1, this->instructionsSize + compiledSize(instruction));
+}
+
+bool TransactionSizeEstimator::fitsStaged(const Instruction &instruction, const Counts &next, size_t limit) const
+{
+  // Accounts are referenced by a one byte index
+  return next.numKeys <= 256 &&
+         sizeOf(next, this->instructionCount + 1, this->instructionsSize + compiledSize(instruction)) <= limit;
+}
+
+bool TransactionSizeEstimator::fits(const Instruction &instruction, size_t limit) const
+{
+  return this->fitsStaged(instruction, this->stage(instruction), limit);
+}
+
+void TransactionSizeEstimator::add(const Instruction &instruction)
+{
+  this->commit(instruction, this->stage(instruction));
+}
+
+bool TransactionSizeEstimator::tryAdd(const Instruction &instruction, size_t limit)
+{
+  const Counts next = this->stage(instruction);
+  if (!this->fitsStaged(instruction, next, limit))
+  {
+    return false;
+  }
+  this->commit(instruction, next);
+  return true;
+}
+
+MessageHeader TransactionSizeEstimator::header() const
+{
+  MessageHeader header;
+  header.numRequiredSignatures = static_cast<uint8_t>(this->counts.byKind[kindOf(true, false)] + this->counts.byKind[kindOf(true, true)]);
+  header.numReadonlySignedAccounts = static_cast<uint8_t>(this->counts.byKind[kindOf(true, false)]);
+  header.numReadonlyUnsignedAccounts = static_cast<uint8_t>(this->counts.byKind[kindOf(false, false)]);
+  return header;
+}
+
+Result<std::vector<Span<const Instruction>>> packInstructions(const std::vector<Instruction> &instructions, const PublicKey &payer, size_t limit)
+{
+  std::vector<Span<const Instruction>> batches;
+  TransactionSizeEstimator estimator(payer);
+  size_t batchStart = 0;
+  for (size_t i = 0; i < instructions.size(); ++i)
+  {
+    if (estimator.tryAdd(instructions[i], limit))
+    {
+      continue;
+    }
+    if (estimator.numInstructions() == 0)
+    {
+      return Error("Instruction does not fit in a transaction");
+    }
+    batches.emplace_back(instructions.data() + batchStart, i - batchStart);
+    batchStart = i;
+    estimator.clear();
+    if (!estimator.tryAdd(instructions[i], limit))
+    {
+      return Error("Instruction does not fit in a transaction");
+    }
+  }
+  if (batchStart < instructions.size())
+  {
+    batches.emplace_back(instructions.data() + batchStart, instructions.size() - batchStart);
+  }
+  return batches;
+}
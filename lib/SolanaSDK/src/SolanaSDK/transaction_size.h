@@ -0,0 +1,100 @@
+#ifndef TRANSACTION_SIZE_H
+#define TRANSACTION_SIZE_H
+
+#include <cstddef>
+#include <unordered_map>
+#include <vector>
+#include "public_key.h"
+#include "instruction.h"
+#include "message.h"
+#include "transaction.h"
+#include "span.h"
+#include "result.h"
+
+// Running serialized size of the signed transaction that Message(instructions,
+// payer) would compile to, without compiling it. Adding an instruction costs
+// one hash lookup per account it references, and the size is exact, not an
+// upper bound.
+class TransactionSizeEstimator
+{
+public:
+  explicit TransactionSizeEstimator(const PublicKey &payer);
+
+  // Serialized length of the transaction with its signatures
+  size_t size() const;
+
+  // What size() would be after add(instruction)
+  size_t sizeWith(const Instruction &instruction) const;
+
+  // Whether add(instruction) keeps the transaction within `limit` bytes and
+  // its accounts addressable by a one byte index
+  bool fits(const Instruction &instruction, size_t limit = PACKET_DATA_SIZE) const;
+
+  void add(const Instruction &instruction);
+
+  // add(instruction) if it fits, returns whether it was added
+  bool tryAdd(const Instruction &instruction, size_t limit = PACKET_DATA_SIZE);
+
+  // Drop every instruction, keeping only the payer. The key table keeps its
+  // buckets so one estimator can be reused for many transactions.
+  void clear();
+
+  // Header the compiled message would have
+  MessageHeader header() const;
+
+  size_t numAccountKeys() const { return keys.size(); }
+
+  size_t numInstructions() const { return instructionCount; }
+
+private:
+  struct KeyFlags
+  {
+    bool isSigner;
+    bool isWritable;
+  };
+
+  // Keys per header category, indexed by isSigner * 2 + isWritable
+  struct Counts
+  {
+    size_t byKind[4];
+    size_t numKeys;
+  };
+
+  // A key referenced by the instruction being staged
+  struct StagedKey
+  {
+    const PublicKey *key;
+    bool isNew;
+    KeyFlags before;
+    KeyFlags after;
+  };
+
+  // Counts after adding `instruction`, its distinct keys are left in
+  // `staged` for commit
+  Counts stage(const Instruction &instruction) const;
+
+  bool fitsStaged(const Instruction &instruction, const Counts &next, size_t limit) const;
+
+  void commit(const Instruction &instruction, const Counts &next);
+
+  static size_t sizeOf(const Counts &counts, size_t numInstructions, size_t instructionsSize);
+
+  PublicKey payer;
+  std::unordered_map<PublicKey, KeyFlags, PublicKeyHash> keys;
+  Counts counts;
+  size_t instructionCount;
+  size_t instructionsSize;
+
+  // Scratch space of stage, kept to avoid reallocating it per instruction
+  mutable std::vector<StagedKey> staged;
+};
+
+// Split `instructions` into the fewest consecutive batches whose signed
+// transactions, paid by `payer`, each fit within `limit` bytes. Instructions
+// keep their order, so dependent instructions can be packed too; a batch can
+// only grow by taking the next instruction, which makes filling each batch
+// before starting the next optimal. The batches point into `instructions`.
+// Fails when an instruction does not fit in a transaction on its own.
+Result<std::vector<Span<const Instruction>>> packInstructions(const std::vector<Instruction> &instructions, const PublicKey &payer, size_t limit = PACKET_DATA_SIZE);
+
+#endif // TRANSACTION_SIZE_H
@@ -0,0 +1,201 @@
+#include <algorithm>
+#include <cstring>
+#include <stdexcept>
+#include "transaction_template.h"
+#include "signature.h"
+#include "byte_sink.h"
+#include "short_vec.h"
+
+TransactionTemplate::TransactionTemplate(const Message &message, MemoryResource *resource)
+    : bytes(resource), instructionData(resource), fields(resource), pinnedKeys(resource)
+{
+  this->numSignatures = message.header.numRequiredSignatures;
+  this->numKeys = message.accountKeys.size();
+  this->messageOffset = shortVecSize(this->numSignatures, SIGNATURE_BYTES);
+
+  this->bytes.reserve(this->messageOffset + message.serializedSize());
+  this->bytes.assign(this->messageOffset, 0);
+  ShortVec::encode(static_cast<uint16_t>(this->numSignatures), this->bytes.data());
+  VectorSink sink(this->bytes);
+  message.serialize(sink);
+
+  // Walk the layout of Message::serialize: version prefix and header, the
+  // keys, the blockhash, then the instructions
+  this->keysOffset = this->messageOffset + (message.versioned ? 4 : 3) + ShortVec::encodedLen(static_cast<uint16_t>(this->numKeys));
+  this->blockhashOffset = this->keysOffset + this->numKeys * PUBLIC_KEY_LEN;
+
+  size_t offset = this->blockhashOffset + HASH_BYTES + ShortVec::encodedLen(static_cast<uint16_t>(message.instructions.size()));
+  this->instructionData.reserve(message.instructions.size());
+  this->pinnedKeys.assign(this->numKeys, false);
+  std::fill(this->pinnedKeys.begin(), this->pinnedKeys.begin() + std::min(this->numSignatures, this->numKeys), true);
+  for (const CompiledInstruction &instruction : message.instructions)
+  {
+    if (instruction.programIdIndex < this->numKeys)
+    {
+      this->pinnedKeys[instruction.programIdIndex] = true;
+    }
+    offset += 1 + shortVecSize(instruction.accounts.size(), 1) + ShortVec::encodedLen(static_cast<uint16_t>(instruction.data.size()));
+    this->instructionData.push_back(Field{static_cast<uint32_t>(offset), static_cast<uint32_t>(instruction.data.size())});
+    offset += instruction.data.size();
+  }
+}
+
+Result<size_t> TransactionTemplate::tryMarkData(size_t instructionIndex, size_t offset, size_t len)
+{
+  if (instructionIndex >= this->instructionData.size())
+  {
+    return Error("Instruction index out of range");
+  }
+  const Field &data = this->instructionData[instructionIndex];
+  if (offset > data.len || len > data.len - offset)
+  {
+    return Error("Field out of the instruction data");
+  }
+  this->fields.push_back(Field{static_cast<uint32_t>(data.offset + offset), static_cast<uint32_t>(len)});
+  return this->fields.size() - 1;
+}
+
+size_t TransactionTemplate::markData(size_t instructionIndex, size_t offset, size_t len)
+{
+  return valueOrThrow<std::out_of_range>(this->tryMarkData(instructionIndex, offset, len));
+}
+
+void TransactionTemplate::setRecentBlockhash(const Hash &recentBlockhash)
+{
+  memcpy(this->bytes.data() + this->blockhashOffset, recentBlockhash.data.data(), HASH_BYTES);
+  this->clearSignatures();
+}
+
+Result<void> TransactionTemplate::trySetData(size_t field, Span<const uint8_t> value)
+{
+  if (field >= this->fields.size())
+  {
+    return Error("Unknown field");
+  }
+  if (value.size() != this->fields[field].len)
+  {
+    return Error("Field length mismatch");
+  }
+  memcpy(this->bytes.data() + this->fields[field].offset, value.data(), value.size());
+  this->clearSignatures();
+  return {};
+}
+
+void TransactionTemplate::setData(size_t field, Span<const uint8_t> value)
+{
+  valueOrThrow<std::out_of_range>(this->trySetData(field, value));
+}
+
+Result<void> TransactionTemplate::trySetU64(size_t field, uint64_t value)
+{
+  uint8_t encoded[8];
+  for (size_t i = 0; i < sizeof(encoded); ++i)
+  {
+    encoded[i] = static_cast<uint8_t>(value >> (8 * i));
+  }
+  return this->trySetData(field, Span<const uint8_t>(encoded, sizeof(encoded)));
+}
+
+Result<void> TransactionTemplate::trySetAccountKey(size_t keyIndex, const PublicKey &key)
+{
+  if (keyIndex >= this->numKeys)
+  {
+    return Error("Account index out of range");
+  }
+  if (this->pinnedKeys[keyIndex])
+  {
+    return Error("Signer and program keys cannot be replaced");
+  }
+  uint8_t *keys = this->bytes.data() + this->keysOffset;
+  for (size_t i = 0; i < this->numKeys; ++i)
+  {
+    if (i != keyIndex && memcmp(keys + i * PUBLIC_KEY_LEN, key.key, PUBLIC_KEY_LEN) == 0)
+    {
+      return Error("Account key already in the message");
+    }
+  }
+  memcpy(keys + keyIndex * PUBLIC_KEY_LEN, key.key, PUBLIC_KEY_LEN);
+  this->clearSignatures();
+  return {};
+}
+
+Result<void> TransactionTemplate::trySign(Signers &keypairs)
+{
+  Result<void> signResult = this->tryPartialSign(keypairs);
+  if (!signResult)
+  {
+    return signResult;
+  }
+  if (!this->isSigned())
+  {
+    return Error("Not enough signers");
+  }
+  return {};
+}
+
+void TransactionTemplate::sign(Signers &keypairs)
+{
+  Result<void> signResult = this->trySign(keypairs);
+  if (!signResult)
+  {
+    SOLANA_THROW(std::runtime_error("TransactionTemplate::sign failed with error " + std::string(signResult.error().what())));
+  }
+}
+
+Result<void> TransactionTemplate::tryPartialSign(Signers &keypairs)
+{
+  const uint8_t *keys = this->bytes.data() + this->keysOffset;
+  const size_t numSigners = std::min(this->numSignatures, this->numKeys);
+  auto positionOf = [&](const PublicKey &key)
+  {
+    size_t i = 0;
+    while (i < numSigners && memcmp(keys + i * PUBLIC_KEY_LEN, key.key, PUBLIC_KEY_LEN) != 0)
+    {
+      ++i;
+    }
+    return i;
+  };
+
+  // Check every keypair before signing, so a mismatch leaves the
+  // signatures untouched
+  for (const Signer *signer : keypairs.signers)
+  {
+    if (positionOf(signer->publicKey()) == numSigners)
+    {
+      return Error("Keypair public key mismatch");
+    }
+  }
+
+  const size_t signaturesOffset = this->messageOffset - this->numSignatures * SIGNATURE_BYTES;
+  for (size_t i = 0; i < keypairs.size(); ++i)
+  {
+    Result<Signature> signature = keypairs.trySignMessage(i, this->messageData());
+    if (!signature)
+    {
+      return signature.error();
+    }
+    memcpy(this->bytes.data() + signaturesOffset + positionOf(keypairs.signers[i]->publicKey()) * SIGNATURE_BYTES, signature.value().value.data(), SIGNATURE_BYTES);
+  }
+  return {};
+}
+
+bool TransactionTemplate::isSigned() const
+{
+  const uint8_t *signatures = this->bytes.data() + this->messageOffset - this->numSignatures * SIGNATURE_BYTES;
+  for (size_t i = 0; i < this->numSignatures; ++i)
+  {
+    const uint8_t *signature = signatures + i * SIGNATURE_BYTES;
+    if (std::all_of(signature, signature + SIGNATURE_BYTES, [](uint8_t b)
+                    { return b == 0; }))
+    {
+      return false;
+    }
+  }
+  return true;
+}
+
+void TransactionTemplate::clearSignatures()
+{
+  std::fill(this->bytes.begin() + (this->messageOffset - this->numSignatures * SIGNATURE_BYTES),
+            this->bytes.begin() + this->messageOffset, 0);
+}
@@ -0,0 +1,108 @@
+#ifndef TRANSACTION_TEMPLATE_H
+#define TRANSACTION_TEMPLATE_H
+
+#include <cstddef>
+#include <cstdint>
+#include <stdexcept>
+#include "public_key.h"
+#include "hash.h"
+#include "message.h"
+#include "signer.h"
+#include "span.h"
+#include "result.h"
+#include "arena.h"
+
+// A transaction serialized once, for sending the same shape of transaction
+// over and over with a new blockhash, amount or account each time. The
+// message is compiled and serialized when the template is created; later
+// sends patch the blockhash, the marked instruction data fields and account
+// keys in place in the wire bytes and re-sign the patched message, without
+// going through CompiledKeys, compileInstructions or Message::serialize.
+//
+// Patching clears the signatures, which are stale from then on.
+class TransactionTemplate
+{
+public:
+  // Serialize `message` with empty signatures. Its wire bytes, and all the
+  // template allocates later, come from `resource`.
+  explicit TransactionTemplate(const Message &message, MemoryResource *resource = heapResource());
+
+  // Mark `len` bytes at `offset` of the data of instruction
+  // `instructionIndex` as a field to patch, returns the field's handle
+  Result<size_t> tryMarkData(size_t instructionIndex, size_t offset, size_t len);
+
+  // As tryMarkData, throwing std::out_of_range
+  size_t markData(size_t instructionIndex, size_t offset, size_t len);
+
+  void setRecentBlockhash(const Hash &recentBlockhash);
+
+  // Overwrite a marked field, `value` must be as long as the field
+  Result<void> trySetData(size_t field, Span<const uint8_t> value);
+
+  // As trySetData, throwing std::out_of_range
+  void setData(size_t field, Span<const uint8_t> value);
+
+  // Overwrite a marked field of 8 bytes with a little endian u64, the
+  // encoding of lamport and token amounts
+  Result<void> trySetU64(size_t field, uint64_t value);
+
+  // Replace the account key at `keyIndex` of the message. Signer keys and
+  // keys invoked as programs keep their place, so are rejected, as is a key
+  // already in the message.
+  Result<void> trySetAccountKey(size_t keyIndex, const PublicKey &key);
+
+  // Sign the patched message with `keypairs`, which must all be signers of
+  // the message, and require every signature to be present afterwards
+  Result<void> trySign(Signers &keypairs);
+
+  // As trySign, throwing std::runtime_error
+  void sign(Signers &keypairs);
+
+  // Sign with a subset of the signers
+  Result<void> tryPartialSign(Signers &keypairs);
+
+  bool isSigned() const;
+
+  // The serialized transaction, ready to send once signed
+  Span<const uint8_t> data() const { return Span<const uint8_t>(bytes.data(), bytes.size()); }
+
+  // The serialized message, the part of data() that is signed
+  Span<const uint8_t> messageData() const
+  {
+    return Span<const uint8_t>(bytes.data() + messageOffset, bytes.size() - messageOffset);
+  }
+
+  size_t serializedSize() const { return bytes.size(); }
+
+  PublicKey accountKey(size_t index) const { return PublicKey(bytes.data() + keysOffset + index * PUBLIC_KEY_LEN); }
+
+  size_t numAccountKeys() const { return numKeys; }
+
+private:
+  // Span of the wire bytes
+  struct Field
+  {
+    uint32_t offset;
+    uint32_t len;
+  };
+
+  void clearSignatures();
+
+  // Wire bytes: signatures, then the message
+  ArenaVector<uint8_t> bytes;
+
+  // Data of every instruction, then the marked fields
+  ArenaVector<Field> instructionData;
+  ArenaVector<Field> fields;
+
+  // Keys that trySetAccountKey may not replace
+  ArenaVector<bool> pinnedKeys;
+
+  size_t numSignatures;
+  size_t messageOffset;
+  size_t keysOffset;
+  size_t numKeys;
+  size_t blockhashOffset;
+};
+
+#endif // TRANSACTION_TEMPLATE_H
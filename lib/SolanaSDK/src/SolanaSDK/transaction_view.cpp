@@ -0,0 +1,307 @@
+#include <cassert>
+#include <cstdint>
+#include <vector>
+#include "transaction_view.h"
+#include "transaction.h"
+#include "short_vec.h"
+
+namespace
+{
+  // Bounds-checked cursor over the bytes being validated
+  class Reader
+  {
+  public:
+    Reader(Span<const uint8_t> bytes) : start(bytes.data()), pos(bytes.data()), end(bytes.data() + bytes.size()) {}
+
+    size_t offset() const { return pos - start; }
+
+    size_t remaining() const { return end - pos; }
+
+    bool readByte(uint8_t &value)
+    {
+      if (pos == end)
+      {
+        return false;
+      }
+      value = *pos++;
+      return true;
+    }
+
+    bool readLength(size_t &value)
+    {
+      uint16_t length;
+      size_t consumed;
+      if (!ShortVec::decode(pos, remaining(), length, consumed))
+      {
+        return false;
+      }
+      pos += consumed;
+      value = length;
+      return true;
+    }
+
+    // Skip `count` items of `itemLen` bytes
+    bool skip(size_t count, size_t itemLen)
+    {
+      if (count > remaining() / itemLen)
+      {
+        return false;
+      }
+      pos += count * itemLen;
+      return true;
+    }
+
+    // Skip a compact-u16 length followed by that many bytes
+    bool skipBytes()
+    {
+      size_t length;
+      return readLength(length) && skip(length, 1);
+    }
+
+  private:
+    const uint8_t *start;
+    const uint8_t *pos;
+    const uint8_t *end;
+  };
+
+  // Lengths of entries that already passed validation
+  size_t readLengthUnchecked(const uint8_t *&pos)
+  {
+    uint16_t length = 0;
+    size_t consumed = 0;
+    const bool decoded = ShortVec::decode(pos, ShortVec::MAX_ENCODED_LEN, length, consumed);
+    assert(decoded);
+    (void)decoded;
+    pos += consumed;
+    return length;
+  }
+
+  Span<const uint8_t> readBytesUnchecked(const uint8_t *&pos)
+  {
+    const size_t length = readLengthUnchecked(pos);
+    Span<const uint8_t> bytes(pos, length);
+    pos += length;
+    return bytes;
+  }
+}
+
+template <>
+InstructionView readEntry<InstructionView>(const uint8_t *&pos)
+{
+  InstructionView instruction;
+  instruction.programIdIndex = *pos++;
+  instruction.accounts = readBytesUnchecked(pos);
+  instruction.data = readBytesUnchecked(pos);
+  return instruction;
+}
+
+Result<InstructionView> InstructionView::parsePrefix(Span<const uint8_t> bytes, size_t &consumed)
+{
+  Reader reader(bytes);
+  uint8_t programIdIndex;
+  if (!reader.readByte(programIdIndex) || !reader.skipBytes() || !reader.skipBytes())
+  {
+    return Error("Instruction out of bounds");
+  }
+  consumed = reader.offset();
+  const uint8_t *pos = bytes.data();
+  return readEntry<InstructionView>(pos);
+}
+
+template <>
+AddressTableLookupView readEntry<AddressTableLookupView>(const uint8_t *&pos)
+{
+  AddressTableLookupView lookup;
+  lookup.accountKey = pos;
+  pos += PUBLIC_KEY_LEN;
+  lookup.writableIndexes = readBytesUnchecked(pos);
+  lookup.readonlyIndexes = readBytesUnchecked(pos);
+  return lookup;
+}
+
+Result<MessageView> MessageView::parse(Span<const uint8_t> bytes)
+{
+  size_t consumed = 0;
+  Result<MessageView> view = parsePrefix(bytes, consumed);
+  if (view && consumed != bytes.size())
+  {
+    return Error("Trailing bytes after message");
+  }
+  return view;
+}
+
+Result<MessageView> MessageView::parsePrefix(Span<const uint8_t> bytes, size_t &consumed)
+{
+  MessageView view;
+  Reader reader(bytes);
+
+  // A set high bit in the first byte marks a versioned message, legacy
+  // messages start with numRequiredSignatures which is below 128
+  uint8_t first;
+  if (!reader.readByte(first))
+  {
+    return Error("Message too short");
+  }
+  if (first & 0x80)
+  {
+    if ((first & 0x7f) != 0)
+    {
+      return Error("Unsupported message version");
+    }
+    view.versioned = true;
+    if (!reader.readByte(view.messageHeader.numRequiredSignatures))
+    {
+      return Error("Message too short");
+    }
+  }
+  else
+  {
+    view.messageHeader.numRequiredSignatures = first;
+  }
+  if (!reader.readByte(view.messageHeader.numReadonlySignedAccounts) ||
+      !reader.readByte(view.messageHeader.numReadonlyUnsignedAccounts))
+  {
+    return Error("Message too short");
+  }
+
+  if (!reader.readLength(view.numKeys))
+  {
+    return Error("Invalid account keys length");
+  }
+  view.keysOffset = reader.offset();
+  if (!reader.skip(view.numKeys, PUBLIC_KEY_LEN) || !reader.skip(1, HASH_BYTES))
+  {
+    return Error("Account keys out of bounds");
+  }
+
+  if (!reader.readLength(view.numInstructions))
+  {
+    return Error("Invalid instructions length");
+  }
+  view.instructionsOffset = reader.offset();
+  for (size_t i = 0; i < view.numInstructions; ++i)
+  {
+    size_t instructionLen = 0;
+    Result<InstructionView> instruction = InstructionView::parsePrefix(bytes.subspan(reader.offset()), instructionLen);
+    if (!instruction)
+    {
+      return instruction.error();
+    }
+    reader.skip(instructionLen, 1);
+  }
+
+  if (view.versioned)
+  {
+    if (!reader.readLength(view.numLookups))
+    {
+      return Error("Invalid address table lookups length");
+    }
+    view.lookupsOffset = reader.offset();
+    for (size_t i = 0; i < view.numLookups; ++i)
+    {
+      if (!reader.skip(1, PUBLIC_KEY_LEN) || !reader.skipBytes() || !reader.skipBytes())
+      {
+        return Error("Address table lookup out of bounds");
+      }
+    }
+  }
+  else
+  {
+    view.lookupsOffset = reader.offset();
+  }
+
+  consumed = reader.offset();
+  view.raw = bytes.first(consumed);
+  return view;
+}
+
+Message MessageView::toMessage(MemoryResource *resource) const
+{
+  Message message(resource);
+  message.versioned = this->versioned;
+  message.header = this->messageHeader;
+
+  message.accountKeys.resize(this->numKeys);
+  for (size_t i = 0; i < this->numKeys; ++i)
+  {
+    std::copy(this->accountKey(i), this->accountKey(i) + PUBLIC_KEY_LEN, message.accountKeys[i].key);
+  }
+
+  std::copy(this->recentBlockhash(), this->recentBlockhash() + HASH_BYTES, message.recentBlockhash.data.begin());
+
+  message.instructions.reserve(this->numInstructions);
+  for (const InstructionView &instruction : this->instructions())
+  {
+    message.instructions.emplace_back(instruction.programIdIndex, instruction.data, instruction.accounts, resource);
+  }
+
+  message.addressTableLookups.reserve(this->numLookups);
+  for (const AddressTableLookupView &lookup : this->addressTableLookups())
+  {
+    AddressLookupTable table;
+    std::copy(lookup.accountKey, lookup.accountKey + PUBLIC_KEY_LEN, table.accountKey.key);
+    table.writableIndexes.assign(lookup.writableIndexes.begin(), lookup.writableIndexes.end());
+    table.readonlyIndexes.assign(lookup.readonlyIndexes.begin(), lookup.readonlyIndexes.end());
+    message.addressTableLookups.push_back(table);
+  }
+
+  return message;
+}
+
+Result<TransactionView> TransactionView::parse(Span<const uint8_t> bytes)
+{
+  size_t consumed = 0;
+  Result<TransactionView> view = parsePrefix(bytes, consumed);
+  if (view && consumed != bytes.size())
+  {
+    return Error("Trailing bytes after transaction");
+  }
+  return view;
+}
+
+Result<TransactionView> TransactionView::parsePrefix(Span<const uint8_t> bytes, size_t &consumed)
+{
+  Reader reader(bytes);
+  size_t numSignatures;
+  if (!reader.readLength(numSignatures))
+  {
+    return Error("Invalid signatures length");
+  }
+  const size_t signaturesOffset = reader.offset();
+  if (!reader.skip(numSignatures, SIGNATURE_BYTES))
+  {
+    return Error("Signatures out of bounds");
+  }
+
+  size_t messageLen = 0;
+  Result<MessageView> message = MessageView::parsePrefix(bytes.subspan(reader.offset()), messageLen);
+  if (!message)
+  {
+    return message.error();
+  }
+  if (message.value().header().numRequiredSignatures != numSignatures)
+  {
+    return Error("Number of signatures does not match the message header");
+  }
+
+  consumed = reader.offset() + messageLen;
+
+  return TransactionView(bytes.subspan(signaturesOffset, numSignatures * SIGNATURE_BYTES), message.value());
+}
+
+Transaction TransactionView::toTransaction(MemoryResource *resource) const
+{
+  Transaction transaction(this->messageView.toMessage(resource));
+  transaction.signatures.resize(this->numSignatures());
+  for (size_t i = 0; i < this->numSignatures(); ++i)
+  {
+    std::copy(this->signature(i), this->signature(i) + SIGNATURE_BYTES, transaction.signatures[i].value.begin());
+  }
+
+  // The signatures are over the message as received, keep those bytes
+  // rather than serializing the copy again
+  const Span<const uint8_t> messageBytes = this->messageView.bytes();
+  transaction.messageBytes.assign(messageBytes.begin(), messageBytes.end());
+  transaction.messageBytesValid = true;
+  return transaction;
+}
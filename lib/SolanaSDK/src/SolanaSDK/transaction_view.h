@@ -0,0 +1,179 @@
+#ifndef TRANSACTION_VIEW_H
+#define TRANSACTION_VIEW_H
+
+#include <cstddef>
+#include <cstdint>
+#include "span.h"
+#include "result.h"
+#include "public_key.h"
+#include "hash.h"
+#include "message.h"
+#include "signature.h"
+
+class Transaction;
+
+// One compiled instruction of a MessageView
+struct InstructionView
+{
+  uint8_t programIdIndex;
+  Span<const uint8_t> accounts;
+  Span<const uint8_t> data;
+
+  // Parse the instruction at the start of `bytes`: the program id index,
+  // then the account indexes and the data, each behind a compact-u16
+  // length. `consumed` is its length.
+  static Result<InstructionView> parsePrefix(Span<const uint8_t> bytes, size_t &consumed);
+};
+
+// One address table lookup of a v0 MessageView
+struct AddressTableLookupView
+{
+  // PUBLIC_KEY_LEN bytes
+  const uint8_t *accountKey;
+  Span<const uint8_t> writableIndexes;
+  Span<const uint8_t> readonlyIndexes;
+};
+
+// Decode the entry at `pos` of a validated message and advance `pos` past it
+template <typename T>
+T readEntry(const uint8_t *&pos);
+
+template <>
+InstructionView readEntry<InstructionView>(const uint8_t *&pos);
+
+template <>
+AddressTableLookupView readEntry<AddressTableLookupView>(const uint8_t *&pos);
+
+// Forward iteration over variable length entries, which are decoded again
+// on every visit rather than stored
+template <typename T>
+class EntryIterator
+{
+public:
+  EntryIterator(const uint8_t *pos, size_t remaining) : pos(pos), remaining(remaining) {}
+
+  T operator*() const
+  {
+    const uint8_t *entry = pos;
+    return readEntry<T>(entry);
+  }
+
+  EntryIterator &operator++()
+  {
+    readEntry<T>(pos);
+    --remaining;
+    return *this;
+  }
+
+  bool operator!=(const EntryIterator &other) const
+  {
+    return remaining != other.remaining;
+  }
+
+private:
+  const uint8_t *pos;
+  size_t remaining;
+};
+
+template <typename T>
+class EntryRange
+{
+public:
+  EntryRange(const uint8_t *first, size_t count) : first(first), count(count) {}
+
+  EntryIterator<T> begin() const { return EntryIterator<T>(first, count); }
+  EntryIterator<T> end() const { return EntryIterator<T>(first, 0); }
+  size_t size() const { return count; }
+  bool empty() const { return count == 0; }
+
+private:
+  const uint8_t *first;
+  size_t count;
+};
+
+// Read-only view of a serialized legacy or v0 message. parse validates the
+// whole layout in one bounds-checked pass and records offsets only, every
+// accessor then points into the original bytes, which must outlive the view.
+class MessageView
+{
+public:
+  static Result<MessageView> parse(Span<const uint8_t> bytes);
+
+  // Parse the message at the start of `bytes`, `consumed` is its length.
+  // Trailing bytes are left to the caller.
+  static Result<MessageView> parsePrefix(Span<const uint8_t> bytes, size_t &consumed);
+
+  // Whether the message has a version prefix, only v0 is accepted
+  bool isVersioned() const { return versioned; }
+
+  const MessageHeader &header() const { return messageHeader; }
+
+  size_t numAccountKeys() const { return numKeys; }
+
+  // PUBLIC_KEY_LEN bytes of static account key `index`
+  const uint8_t *accountKey(size_t index) const { return raw.data() + keysOffset + index * PUBLIC_KEY_LEN; }
+
+  // All static account keys back to back
+  Span<const uint8_t> accountKeyBytes() const { return raw.subspan(keysOffset, numKeys * PUBLIC_KEY_LEN); }
+
+  // HASH_BYTES bytes
+  const uint8_t *recentBlockhash() const { return raw.data() + keysOffset + numKeys * PUBLIC_KEY_LEN; }
+
+  EntryRange<InstructionView> instructions() const { return EntryRange<InstructionView>(raw.data() + instructionsOffset, numInstructions); }
+
+  // Empty for legacy messages
+  EntryRange<AddressTableLookupView> addressTableLookups() const { return EntryRange<AddressTableLookupView>(raw.data() + lookupsOffset, numLookups); }
+
+  // The serialized message, as signed
+  Span<const uint8_t> bytes() const { return raw; }
+
+  // Copy into an owning Message allocating from `resource`
+  Message toMessage(MemoryResource *resource = heapResource()) const;
+
+private:
+  MessageView() = default;
+
+  Span<const uint8_t> raw;
+  bool versioned = false;
+  MessageHeader messageHeader = {};
+  size_t keysOffset = 0;
+  size_t numKeys = 0;
+  size_t instructionsOffset = 0;
+  size_t numInstructions = 0;
+  size_t lookupsOffset = 0;
+  size_t numLookups = 0;
+};
+
+// Read-only view of a serialized transaction: the signatures followed by a
+// MessageView. The number of signatures must match the message header.
+class TransactionView
+{
+public:
+  static Result<TransactionView> parse(Span<const uint8_t> bytes);
+
+  // Parse the transaction at the start of `bytes`, `consumed` is its
+  // length. Trailing bytes are left to the caller.
+  static Result<TransactionView> parsePrefix(Span<const uint8_t> bytes, size_t &consumed);
+
+  size_t numSignatures() const { return signatures.size() / SIGNATURE_BYTES; }
+
+  // SIGNATURE_BYTES bytes of signature `index`
+  const uint8_t *signature(size_t index) const { return signatures.data() + index * SIGNATURE_BYTES; }
+
+  // All signatures back to back
+  Span<const uint8_t> signatureBytes() const { return signatures; }
+
+  const MessageView &message() const { return messageView; }
+
+  // Copy into an owning Transaction allocating from `resource`
+  Transaction toTransaction(MemoryResource *resource = heapResource()) const;
+
+private:
+  TransactionView(Span<const uint8_t> signatures, const MessageView &messageView)
+      : signatures(signatures), messageView(messageView) {}
+
+  Span<const uint8_t> signatures;
+  MessageView messageView;
+};
+
+#endif // TRANSACTION_VIEW_H
@@ -0,0 +1,126 @@
+#include <algorithm>
+#include "worker_pool.h"
+
+#if defined(ESP_PLATFORM)
+#include <freertos/FreeRTOS.h>
+#include <freertos/task.h>
+#include <freertos/semphr.h>
+#else
+#include <thread>
+#endif
+
+#if defined(ESP_PLATFORM)
+
+namespace
+{
+  struct WorkerTask
+  {
+    void (*body)(unsigned, void *);
+    void *context;
+    unsigned worker;
+    SemaphoreHandle_t done;
+  };
+
+  void workerTaskEntry(void *argument)
+  {
+    WorkerTask *task = static_cast<WorkerTask *>(argument);
+    task->body(task->worker, task->context);
+    xSemaphoreGive(task->done);
+    vTaskDelete(nullptr);
+  }
+}
+
+unsigned defaultWorkerCount()
+{
+  return portNUM_PROCESSORS;
+}
+
+void runWorkers(unsigned workers, void (*body)(unsigned, void *), void *context)
+{
+  workers = std::max(1u, std::min<unsigned>(workers, portNUM_PROCESSORS));
+  SemaphoreHandle_t done = workers > 1 ? xSemaphoreCreateCounting(workers - 1, 0) : nullptr;
+
+  // One task per other core, at the caller's priority
+  WorkerTask tasks[portNUM_PROCESSORS];
+  unsigned started = 0;
+  const BaseType_t core = xPortGetCoreID();
+  for (unsigned worker = 1; done != nullptr && worker < workers; ++worker)
+  {
+    tasks[worker] = WorkerTask{body, context, worker, done};
+    if (xTaskCreatePinnedToCore(workerTaskEntry, "solana-worker", SOLANA_WORKER_STACK_SIZE, &tasks[worker],
+                                uxTaskPriorityGet(nullptr), nullptr, (core + worker) % portNUM_PROCESSORS) == pdPASS)
+    {
+      ++started;
+    }
+  }
+
+  body(0, context);
+
+  for (unsigned i = 0; i < started; ++i)
+  {
+    xSemaphoreTake(done, portMAX_DELAY);
+  }
+  if (done != nullptr)
+  {
+    vSemaphoreDelete(done);
+  }
+}
+
+#else
+
+unsigned defaultWorkerCount()
+{
+  return std::max(1u, std::thread::hardware_concurrency());
+}
+
+void runWorkers(unsigned workers, void (*body)(unsigned, void *), void *context)
+{
+  std::vector<std::thread> threads;
+  threads.reserve(workers > 1 ? workers - 1 : 0);
+  for (unsigned worker = 1; worker < workers; ++worker)
+  {
+    threads.emplace_back(body, worker, context);
+  }
+  body(0, context);
+  for (auto &thread : threads)
+  {
+    thread.join();
+  }
+}
+
+#endif
+
+WorkStealingRange::WorkStealingRange(size_t count, unsigned workers, size_t grain)
+    : slices(std::max(1u, workers)), grain(std::max<size_t>(1, grain))
+{
+  const size_t numSlices = this->slices.size();
+  for (size_t i = 0; i < numSlices; ++i)
+  {
+    this->slices[i].next.store(count * i / numSlices, std::memory_order_relaxed);
+    this->slices[i].end = count * (i + 1) / numSlices;
+  }
+}
+
+bool WorkStealingRange::claim(unsigned worker, size_t &begin, size_t &end)
+{
+  // The own slice first, then the others in turn. Owner and thieves all
+  // advance a slice's cursor with fetch_add, so every index is claimed
+  // exactly once.
+  const size_t numSlices = this->slices.size();
+  for (size_t k = 0; k < numSlices; ++k)
+  {
+    Slice &slice = this->slices[(worker + k) % numSlices];
+    if (slice.next.load(std::memory_order_relaxed) >= slice.end)
+    {
+      continue;
+    }
+    const size_t start = slice.next.fetch_add(this->grain, std::memory_order_relaxed);
+    if (start < slice.end)
+    {
+      begin = start;
+      end = std::min(start + this->grain, slice.end);
+      return true;
+    }
+  }
+  return false;
+}
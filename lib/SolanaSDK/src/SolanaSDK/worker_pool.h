@@ -0,0 +1,62 @@
+#ifndef WORKER_POOL_H
+#define WORKER_POOL_H
+
+#include <atomic>
+#include <cstddef>
+#include <vector>
+
+// Stack of each worker task on the ESP32, in bytes. Signing and hashing
+// need a few KB, raise it for heavier work.
+#ifndef SOLANA_WORKER_STACK_SIZE
+#define SOLANA_WORKER_STACK_SIZE 8192
+#endif
+
+// Workers used when a caller asks for 0: the hardware concurrency on hosts,
+// the number of cores on the ESP32
+unsigned defaultWorkerCount();
+
+// Run body(worker, context) once for each worker in [0, workers) and
+// return when all are done. Worker 0 runs on the calling thread, the others
+// on std::threads on hosts and on FreeRTOS tasks pinned one per core on the
+// ESP32. A worker that cannot be started is skipped, so bodies should share
+// their work through a WorkStealingRange rather than rely on every worker
+// running.
+void runWorkers(unsigned workers, void (*body)(unsigned worker, void *context), void *context);
+
+// As runWorkers, calling body(worker) on any callable
+template <typename Body>
+void runWorkers(unsigned workers, Body &body)
+{
+  runWorkers(
+      workers,
+      [](unsigned worker, void *context)
+      { (*static_cast<Body *>(context))(worker); },
+      &body);
+}
+
+// The indexes [0, count) split into one contiguous slice per worker.
+// Workers claim batches from their own slice first and then steal from the
+// others', so work of uneven cost, and workers that start late or never,
+// still balance out. Claims are lock free.
+class WorkStealingRange
+{
+public:
+  WorkStealingRange(size_t count, unsigned workers, size_t grain = 1);
+
+  // Claim up to `grain` indexes [begin, end) for `worker`, false once every
+  // index is claimed
+  bool claim(unsigned worker, size_t &begin, size_t &end);
+
+private:
+  // On its own cache line, so owners do not contend with each other
+  struct alignas(64) Slice
+  {
+    std::atomic<size_t> next{0};
+    size_t end = 0;
+  };
+
+  std::vector<Slice> slices;
+  size_t grain;
+};
+
+#endif // WORKER_POOL_H
@@ -0,0 +1,193 @@
+// Check the fixed width and batch Base58 codecs against encodings produced
+// by a reference big integer implementation, including well known Solana
+// addresses and leading zero bytes.
+
+#include <Arduino.h>
+#include <unity.h>
+#include <cstring>
+#include <string>
+#include <vector>
+#include "SolanaSDK/base58.h"
+
+namespace
+{
+  struct Vector32
+  {
+    const char *encoded;
+    uint8_t bytes[32];
+  };
+
+  const Vector32 VECTORS_32[] = {
+      {"11111111111111111111111111111111", {}},
+      {"SysvarRent111111111111111111111111111111111",
+       {0x06, 0xa7, 0xd5, 0x17, 0x19, 0x2c, 0x5c, 0x51, 0x21, 0x8c, 0xc9, 0x4c, 0x3d, 0x4a, 0xf1, 0x7f,
+        0x58, 0xda, 0xee, 0x08, 0x9b, 0xa1, 0xfd, 0x44, 0xe3, 0xdb, 0xd9, 0x8a, 0x00, 0x00, 0x00, 0x00}},
+      {"4wBqpZM9xaSheZzJSMawUKKwhdpChKbZ5eu5ky4Vigw",
+       {0x01, 0x02, 0x03, 0x04, 0x05, 0x06, 0x07, 0x08, 0x09, 0x0a, 0x0b, 0x0c, 0x0d, 0x0e, 0x0f, 0x10,
+        0x11, 0x12, 0x13, 0x14, 0x15, 0x16, 0x17, 0x18, 0x19, 0x1a, 0x1b, 0x1c, 0x1d, 0x1e, 0x1f, 0x20}},
+      {"11CiMQsCUhqABwwLyCFeX2iPnBZX3s28dUUCBrirhs",
+       {0x00, 0x00, 0x01, 0x02, 0x03, 0x04, 0x05, 0x06, 0x07, 0x08, 0x09, 0x0a, 0x0b, 0x0c, 0x0d, 0x0e,
+        0x0f, 0x10, 0x11, 0x12, 0x13, 0x14, 0x15, 0x16, 0x17, 0x18, 0x19, 0x1a, 0x1b, 0x1c, 0x1d, 0x1e}},
+      {"JEKNVnkbo3jma5nREBBJCDoXFVeKkD56V3xKrvRmWxFG",
+       {0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff,
+        0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff}},
+  };
+
+  // Bytes 0..63 and 64 bytes of 0xff
+  const char *const ASCENDING_64 = "1GMkH3brNXiNNs1tiFZHu4yZSRrzJwxi5wB9bHFtMinfCXNnR1adh8Vo8NTheK4evneedH4qmvjeqcBBNAefgS";
+  const char *const ONES_64 = "67rpwLCuS5DGA8KGZXKsVQ7dnPb9goRLoKfgGbLfQg9WoLUgNY77E2jT11fem3coV9nAkguBACzrU1iyZM4B8roQ";
+
+  // Strings that are not the encoding of exactly 32 bytes: 31 zero bytes,
+  // a value past 2^256, and characters outside the alphabet
+  const char *const INVALID_32[] = {
+      "1111111111111111111111111111111",
+      "JEKNVnkbo3jma5nREBBJCDoXFVeKkD56V3xKrvRmWxFH",
+      "SysvarRent11111111111111111111111111111111O",
+      "0000000000000000000000000000000",
+      "",
+  };
+}
+
+void setUp() {}
+
+void tearDown() {}
+
+void test_encode32()
+{
+  for (const Vector32 &vector : VECTORS_32)
+  {
+    char out[BASE58_ENCODED_32_MAX_LEN + 1];
+    size_t len = Base58::encode32(vector.bytes, out);
+    TEST_ASSERT_EQUAL(strlen(vector.encoded), len);
+    TEST_ASSERT_EQUAL_STRING(vector.encoded, out);
+    TEST_ASSERT_EQUAL_STRING(vector.encoded, Base58::encode32(vector.bytes).c_str());
+  }
+}
+
+void test_decode32()
+{
+  for (const Vector32 &vector : VECTORS_32)
+  {
+    uint8_t out[32];
+    TEST_ASSERT_TRUE(Base58::decode32(vector.encoded, strlen(vector.encoded), out));
+    TEST_ASSERT_EQUAL_UINT8_ARRAY(vector.bytes, out, 32);
+  }
+  for (const char *invalid : INVALID_32)
+  {
+    uint8_t out[32];
+    TEST_ASSERT_FALSE(Base58::decode32(invalid, strlen(invalid), out));
+  }
+}
+
+void test_decode32_literal()
+{
+  constexpr std::array<uint8_t, 32> rent = Base58::decode32Literal("SysvarRent111111111111111111111111111111111");
+  TEST_ASSERT_EQUAL_UINT8_ARRAY(VECTORS_32[1].bytes, rent.data(), 32);
+}
+
+void test_codec64()
+{
+  uint8_t ascending[64];
+  uint8_t ones[64];
+  for (size_t i = 0; i < 64; ++i)
+  {
+    ascending[i] = static_cast<uint8_t>(i);
+    ones[i] = 0xff;
+  }
+
+  char out[BASE58_ENCODED_64_MAX_LEN + 1];
+  TEST_ASSERT_EQUAL(strlen(ASCENDING_64), Base58::encode64(ascending, out));
+  TEST_ASSERT_EQUAL_STRING(ASCENDING_64, out);
+  TEST_ASSERT_EQUAL(strlen(ONES_64), Base58::encode64(ones, out));
+  TEST_ASSERT_EQUAL_STRING(ONES_64, out);
+
+  uint8_t decoded[64];
+  TEST_ASSERT_TRUE(Base58::decode64(ASCENDING_64, strlen(ASCENDING_64), decoded));
+  TEST_ASSERT_EQUAL_UINT8_ARRAY(ascending, decoded, 64);
+  TEST_ASSERT_TRUE(Base58::decode64(ONES_64, strlen(ONES_64), decoded));
+  TEST_ASSERT_EQUAL_UINT8_ARRAY(ones, decoded, 64);
+
+  // A 32 byte value is not a 64 byte one
+  TEST_ASSERT_FALSE(Base58::decode64(VECTORS_32[4].encoded, strlen(VECTORS_32[4].encoded), decoded));
+}
+
+void test_variable_length()
+{
+  const std::vector<uint8_t> bytes = {0x00, 0xeb, 0x15, 0x23, 0x1d, 0xfc, 0xeb, 0x60, 0x92, 0x58, 0x86, 0xb6, 0x7d,
+                                      0x06, 0x52, 0x99, 0x92, 0x59, 0x15, 0xae, 0xb1, 0x72, 0xc0, 0x66, 0x47};
+  const char *encoded = "1NS17iag9jJgTHD1VXjvLCEnZuQ3rJDE9L";
+
+  char out[64];
+  size_t outLen = 0;
+  TEST_ASSERT_TRUE(Base58::encode(bytes.data(), bytes.size(), Span<char>(out, sizeof(out)), outLen) == Base58Status::Ok);
+  TEST_ASSERT_EQUAL(strlen(encoded), outLen);
+  TEST_ASSERT_EQUAL_STRING(encoded, out);
+
+  uint8_t decoded[32];
+  TEST_ASSERT_TRUE(Base58::decode(encoded, strlen(encoded), Span<uint8_t>(decoded, sizeof(decoded)), outLen) == Base58Status::Ok);
+  TEST_ASSERT_EQUAL(bytes.size(), outLen);
+  TEST_ASSERT_EQUAL_UINT8_ARRAY(bytes.data(), decoded, bytes.size());
+
+  TEST_ASSERT_TRUE(Base58::encode(bytes.data(), bytes.size(), Span<char>(out, 8), outLen) == Base58Status::BufferTooSmall);
+  TEST_ASSERT_TRUE(Base58::decode("2g0", 3, Span<uint8_t>(decoded, sizeof(decoded)), outLen) == Base58Status::InvalidCharacter);
+}
+
+void test_decode32_batch()
+{
+  // Every vector, then every invalid string, interleaved so that valid and
+  // invalid entries share the lanes decoded in lock step
+  std::vector<const char *> strs;
+  std::vector<size_t> lens;
+  std::vector<bool> valid;
+  const size_t numVectors = sizeof(VECTORS_32) / sizeof(VECTORS_32[0]);
+  const size_t numInvalid = sizeof(INVALID_32) / sizeof(INVALID_32[0]);
+  for (size_t i = 0; i < numVectors || i < numInvalid; ++i)
+  {
+    if (i < numVectors)
+    {
+      strs.push_back(VECTORS_32[i].encoded);
+      valid.push_back(true);
+    }
+    if (i < numInvalid)
+    {
+      strs.push_back(INVALID_32[i]);
+      valid.push_back(false);
+    }
+  }
+  for (const char *str : strs)
+  {
+    lens.push_back(strlen(str));
+  }
+
+  const size_t count = strs.size();
+  std::vector<uint8_t> out(count * 32, 0xaa);
+  std::vector<uint8_t> bitmap((count + 7) / 8, 0xaa);
+  TEST_ASSERT_EQUAL(numVectors, Base58::decode32Batch(strs.data(), lens.data(), count, out.data(), bitmap.data()));
+
+  const uint8_t zero[32] = {};
+  size_t vector = 0;
+  for (size_t i = 0; i < count; ++i)
+  {
+    const bool bit = (bitmap[i / 8] >> (i % 8)) & 1;
+    TEST_ASSERT_EQUAL(valid[i], bit);
+    const uint8_t *expected = valid[i] ? VECTORS_32[vector++].bytes : zero;
+    TEST_ASSERT_EQUAL_UINT8_ARRAY(expected, out.data() + i * 32, 32);
+  }
+}
+
+void setup()
+{
+  // Wait for the serial monitor
+  delay(2000);
+
+  UNITY_BEGIN();
+  RUN_TEST(test_encode32);
+  RUN_TEST(test_decode32);
+  RUN_TEST(test_decode32_literal);
+  RUN_TEST(test_codec64);
+  RUN_TEST(test_variable_length);
+  RUN_TEST(test_decode32_batch);
+  UNITY_END();
+}
+
+void loop() {}
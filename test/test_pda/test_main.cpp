@@ -0,0 +1,155 @@
+// Check the on-curve test and program address derivation against the
+// vectors of the Solana SDKs, all derived for the BPF loader program.
+
+#include <Arduino.h>
+#include <unity.h>
+#include <cstring>
+#include <vector>
+#include "SolanaSDK/public_key.h"
+
+namespace
+{
+  constexpr PublicKey BPF_LOADER = PublicKey::fromLiteral("BPFLoader1111111111111111111111111111111111");
+
+  Span<const uint8_t> seed(const char *str)
+  {
+    return Span<const uint8_t>(reinterpret_cast<const uint8_t *>(str), strlen(str));
+  }
+
+  void checkCreate(const std::vector<Span<const uint8_t>> &seeds, const PublicKey &expected)
+  {
+    Result<PublicKey> address = PublicKey::tryCreateProgramAddress(seeds, BPF_LOADER);
+    TEST_ASSERT_TRUE(static_cast<bool>(address));
+    TEST_ASSERT_TRUE(address.value() == expected);
+    TEST_ASSERT_FALSE(address.value().isOnCurve());
+  }
+}
+
+void setUp() {}
+
+void tearDown() {}
+
+void test_is_on_curve()
+{
+  // The base point, the identity, the point with y = 0 (the system
+  // program's all zero key), an ed25519 public key, and y = p + 1, which
+  // is reduced to the identity
+  const uint8_t basePoint[PUBLIC_KEY_LEN] = {
+      0x58, 0x66, 0x66, 0x66, 0x66, 0x66, 0x66, 0x66, 0x66, 0x66, 0x66, 0x66, 0x66, 0x66, 0x66, 0x66,
+      0x66, 0x66, 0x66, 0x66, 0x66, 0x66, 0x66, 0x66, 0x66, 0x66, 0x66, 0x66, 0x66, 0x66, 0x66, 0x66};
+  const uint8_t identity[PUBLIC_KEY_LEN] = {1};
+  const uint8_t nonCanonicalIdentity[PUBLIC_KEY_LEN] = {
+      0xee, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff,
+      0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0x7f};
+  TEST_ASSERT_TRUE(PublicKey(basePoint).isOnCurve());
+  TEST_ASSERT_TRUE(PublicKey(identity).isOnCurve());
+  TEST_ASSERT_TRUE(PublicKey().isOnCurve());
+  TEST_ASSERT_TRUE(PublicKey::fromLiteral("9C6hybhQ6Aycep9jaUnP6uL9ZYvDjUp1aSkFWPUFJtpj").isOnCurve());
+  TEST_ASSERT_TRUE(PublicKey(nonCanonicalIdentity).isOnCurve());
+
+  // No x exists for y = 2
+  const uint8_t offCurve[PUBLIC_KEY_LEN] = {2};
+  TEST_ASSERT_FALSE(PublicKey(offCurve).isOnCurve());
+}
+
+void test_create_program_address()
+{
+  const uint8_t one[] = {1};
+  const PublicKey seedKey = PublicKey::fromLiteral("SeedPubey1111111111111111111111111111111111");
+
+  checkCreate({seed(""), Span<const uint8_t>(one)}, PublicKey::fromLiteral("3gF2KMe9KiC6FNVBmfg9i267aMPvK37FewCip4eGBFcT"));
+  checkCreate({seed("\xe2\x98\x89")}, PublicKey::fromLiteral("7ytmC1nT1xY4RfxCV2ZgyA7UakC93do5ZdyhdF3EtPj7"));
+  checkCreate({seed("Talking"), seed("Squirrels")}, PublicKey::fromLiteral("HwRVBufQ4haG5XSgpspwKtNd3PC9GM9m1196uJW36vds"));
+  checkCreate({Span<const uint8_t>(seedKey.key, PUBLIC_KEY_LEN)}, PublicKey::fromLiteral("GUs5qLUfsEHkcMB9T38vjr18ypEhRuNWiePW2LoK4E3K"));
+
+  // Different seeds give different addresses
+  Result<PublicKey> talking = PublicKey::tryCreateProgramAddress({seed("Talking")}, BPF_LOADER);
+  Result<PublicKey> talkingSquirrels = PublicKey::tryCreateProgramAddress({seed("Talking"), seed("Squirrels")}, BPF_LOADER);
+  TEST_ASSERT_TRUE(static_cast<bool>(talking) && static_cast<bool>(talkingSquirrels));
+  TEST_ASSERT_FALSE(talking.value() == talkingSquirrels.value());
+}
+
+void test_create_program_address_errors()
+{
+  const uint8_t longSeed[MAX_SEED_LEN + 1] = {};
+  Result<PublicKey> tooLong = PublicKey::tryCreateProgramAddress({Span<const uint8_t>(longSeed)}, BPF_LOADER);
+  TEST_ASSERT_FALSE(static_cast<bool>(tooLong));
+  TEST_ASSERT_EQUAL_STRING("MaxSeedLengthExceeded", tooLong.error().what());
+
+  std::vector<Span<const uint8_t>> tooMany(MAX_SEEDS + 1, seed("a"));
+  Result<PublicKey> manySeeds = PublicKey::tryCreateProgramAddress(tooMany, BPF_LOADER);
+  TEST_ASSERT_FALSE(static_cast<bool>(manySeeds));
+  TEST_ASSERT_EQUAL_STRING("MaxSeedLengthExceeded", manySeeds.error().what());
+
+  // Bump 255 of these seeds hashes to a point on the curve
+  const uint8_t bump[] = {255};
+  Result<PublicKey> onCurve = PublicKey::tryCreateProgramAddress({seed("Lil'"), seed("Bits"), Span<const uint8_t>(bump)}, BPF_LOADER);
+  TEST_ASSERT_FALSE(static_cast<bool>(onCurve));
+  TEST_ASSERT_EQUAL_STRING("InvalidSeeds", onCurve.error().what());
+}
+
+void test_find_program_address()
+{
+  std::optional<std::pair<PublicKey, uint8_t>> empty = PublicKey::tryFindProgramAddress({seed("")}, BPF_LOADER);
+  TEST_ASSERT_TRUE(empty.has_value());
+  TEST_ASSERT_TRUE(empty->first == PublicKey::fromLiteral("EXWkUCz3YJU9TDVk39ogA4TwoVsUi75ZDhH6yT7acPgQ"));
+  TEST_ASSERT_EQUAL(255, empty->second);
+
+  // The first bump is on the curve, so the search goes on to 254
+  std::optional<std::pair<PublicKey, uint8_t>> bits = PublicKey::tryFindProgramAddress({seed("Lil'"), seed("Bits")}, BPF_LOADER);
+  TEST_ASSERT_TRUE(bits.has_value());
+  TEST_ASSERT_TRUE(bits->first == PublicKey::fromLiteral("4aTjbsz52PNDhsj7mvsKmSKJebAtt5nNxyiNZTkfJZgh"));
+  TEST_ASSERT_EQUAL(254, bits->second);
+
+  const uint8_t bump[] = {bits->second};
+  Result<PublicKey> created = PublicKey::tryCreateProgramAddress({seed("Lil'"), seed("Bits"), Span<const uint8_t>(bump)}, BPF_LOADER);
+  TEST_ASSERT_TRUE(static_cast<bool>(created));
+  TEST_ASSERT_TRUE(created.value() == bits->first);
+
+  const uint8_t longSeed[MAX_SEED_LEN + 1] = {};
+  TEST_ASSERT_FALSE(PublicKey::tryFindProgramAddress({Span<const uint8_t>(longSeed)}, BPF_LOADER).has_value());
+}
+
+void test_find_program_addresses()
+{
+  // The parallel search gives the sequential results, in order
+  std::vector<uint8_t> indexes(64);
+  std::vector<std::vector<Span<const uint8_t>>> seedSets;
+  for (size_t i = 0; i < indexes.size(); ++i)
+  {
+    indexes[i] = static_cast<uint8_t>(i);
+    seedSets.push_back({seed("vault"), Span<const uint8_t>(&indexes[i], 1)});
+  }
+  const uint8_t longSeed[MAX_SEED_LEN + 1] = {};
+  seedSets.push_back({Span<const uint8_t>(longSeed)});
+
+  std::vector<std::optional<std::pair<PublicKey, uint8_t>>> found = PublicKey::findProgramAddresses(seedSets, BPF_LOADER);
+  TEST_ASSERT_EQUAL(seedSets.size(), found.size());
+  for (size_t i = 0; i < seedSets.size(); ++i)
+  {
+    std::optional<std::pair<PublicKey, uint8_t>> expected = PublicKey::tryFindProgramAddress(seedSets[i], BPF_LOADER);
+    TEST_ASSERT_EQUAL(expected.has_value(), found[i].has_value());
+    if (expected)
+    {
+      TEST_ASSERT_TRUE(expected->first == found[i]->first);
+      TEST_ASSERT_EQUAL(expected->second, found[i]->second);
+    }
+  }
+  TEST_ASSERT_FALSE(found.back().has_value());
+}
+
+void setup()
+{
+  // Wait for the serial monitor
+  delay(2000);
+
+  UNITY_BEGIN();
+  RUN_TEST(test_is_on_curve);
+  RUN_TEST(test_create_program_address);
+  RUN_TEST(test_create_program_address_errors);
+  RUN_TEST(test_find_program_address);
+  RUN_TEST(test_find_program_addresses);
+  UNITY_END();
+}
+
+void loop() {}
@@ -0,0 +1,135 @@
+// Check Sha256, whichever backend it selected (mbedtls and the SHA
+// peripheral on the ESP32, SHA-NI or the ARMv8 extensions elsewhere),
+// against the FIPS 180-2 vectors and libsodium's portable SHA-256.
+
+#include <Arduino.h>
+#include <unity.h>
+#include <sodium.h>
+#include <cstring>
+#include <vector>
+#include "SolanaSDK/sha256.h"
+
+namespace
+{
+  struct Vector
+  {
+    const char *message;
+    uint8_t digest[Sha256::DIGEST_LEN];
+  };
+
+  const Vector VECTORS[] = {
+      {"",
+       {0xe3, 0xb0, 0xc4, 0x42, 0x98, 0xfc, 0x1c, 0x14, 0x9a, 0xfb, 0xf4, 0xc8, 0x99, 0x6f, 0xb9, 0x24,
+        0x27, 0xae, 0x41, 0xe4, 0x64, 0x9b, 0x93, 0x4c, 0xa4, 0x95, 0x99, 0x1b, 0x78, 0x52, 0xb8, 0x55}},
+      {"abc",
+       {0xba, 0x78, 0x16, 0xbf, 0x8f, 0x01, 0xcf, 0xea, 0x41, 0x41, 0x40, 0xde, 0x5d, 0xae, 0x22, 0x23,
+        0xb0, 0x03, 0x61, 0xa3, 0x96, 0x17, 0x7a, 0x9c, 0xb4, 0x10, 0xff, 0x61, 0xf2, 0x00, 0x15, 0xad}},
+      {"abcdbcdecdefdefgefghfghighijhijkijkljklmklmnlmnomnopnopq",
+       {0x24, 0x8d, 0x6a, 0x61, 0xd2, 0x06, 0x38, 0xb8, 0xe5, 0xc0, 0x26, 0x93, 0x0c, 0x3e, 0x60, 0x39,
+        0xa3, 0x3c, 0xe4, 0x59, 0x64, 0xff, 0x21, 0x67, 0xf6, 0xec, 0xed, 0xd4, 0x19, 0xdb, 0x06, 0xc1}},
+  };
+
+  // SHA-256 of one million 'a'
+  const uint8_t MILLION_A[Sha256::DIGEST_LEN] = {
+      0xcd, 0xc7, 0x6e, 0x5c, 0x99, 0x14, 0xfb, 0x92, 0x81, 0xa1, 0xc7, 0xe2, 0x84, 0xd7, 0x3e, 0x67,
+      0xf1, 0x80, 0x9a, 0x48, 0xa4, 0x97, 0x20, 0x0e, 0x04, 0x6d, 0x39, 0xcc, 0xc7, 0x11, 0x2c, 0xd0};
+}
+
+void setUp() {}
+
+void tearDown() {}
+
+void test_fips_vectors()
+{
+  TEST_MESSAGE(Sha256::backend());
+  for (const Vector &vector : VECTORS)
+  {
+    uint8_t digest[Sha256::DIGEST_LEN];
+    Sha256::digest(reinterpret_cast<const uint8_t *>(vector.message), strlen(vector.message), digest);
+    TEST_ASSERT_EQUAL_UINT8_ARRAY(vector.digest, digest, Sha256::DIGEST_LEN);
+  }
+
+  // Many whole blocks through a single update, then in 1000 byte pieces
+  std::vector<uint8_t> message(1000000, 'a');
+  uint8_t digest[Sha256::DIGEST_LEN];
+  Sha256::digest(message.data(), message.size(), digest);
+  TEST_ASSERT_EQUAL_UINT8_ARRAY(MILLION_A, digest, Sha256::DIGEST_LEN);
+
+  Sha256 hasher;
+  for (size_t offset = 0; offset < message.size(); offset += 1000)
+  {
+    hasher.update(message.data() + offset, 1000);
+  }
+  hasher.finalize(digest);
+  TEST_ASSERT_EQUAL_UINT8_ARRAY(MILLION_A, digest, Sha256::DIGEST_LEN);
+}
+
+void test_matches_portable()
+{
+  // Every length up to four blocks, so each padding case and partially
+  // filled buffer is met, hashed in one go and in uneven pieces
+  uint8_t message[4 * Sha256::BLOCK_LEN + 1];
+  for (size_t i = 0; i < sizeof(message); ++i)
+  {
+    message[i] = static_cast<uint8_t>(i * 131 + 7);
+  }
+
+  for (size_t len = 0; len <= sizeof(message); ++len)
+  {
+    uint8_t expected[Sha256::DIGEST_LEN];
+    crypto_hash_sha256(expected, message, len);
+
+    uint8_t digest[Sha256::DIGEST_LEN];
+    Sha256::digest(message, len, digest);
+    TEST_ASSERT_EQUAL_UINT8_ARRAY(expected, digest, Sha256::DIGEST_LEN);
+
+    Sha256 hasher;
+    size_t piece = 1;
+    for (size_t offset = 0; offset < len; offset += piece, piece = piece * 2 + 1)
+    {
+      hasher.update(message + offset, piece < len - offset ? piece : len - offset);
+    }
+    hasher.finalize(digest);
+    TEST_ASSERT_EQUAL_UINT8_ARRAY(expected, digest, Sha256::DIGEST_LEN);
+  }
+}
+
+void test_copy_forks()
+{
+  // A copy resumes from the prefix absorbed so far, as the program derived
+  // address search does for every bump seed
+  const uint8_t prefix[] = "a prefix longer than one sixty four byte block of SHA-256 input..";
+  const uint8_t suffix[] = "suffix";
+
+  Sha256 common;
+  common.update(prefix, sizeof(prefix) - 1);
+  Sha256 fork = common;
+  fork.update(suffix, sizeof(suffix) - 1);
+
+  uint8_t forked[Sha256::DIGEST_LEN];
+  uint8_t prefixOnly[Sha256::DIGEST_LEN];
+  fork.finalize(forked);
+  common.finalize(prefixOnly);
+
+  std::vector<uint8_t> whole(prefix, prefix + sizeof(prefix) - 1);
+  whole.insert(whole.end(), suffix, suffix + sizeof(suffix) - 1);
+  uint8_t expected[Sha256::DIGEST_LEN];
+  crypto_hash_sha256(expected, whole.data(), whole.size());
+  TEST_ASSERT_EQUAL_UINT8_ARRAY(expected, forked, Sha256::DIGEST_LEN);
+  crypto_hash_sha256(expected, prefix, sizeof(prefix) - 1);
+  TEST_ASSERT_EQUAL_UINT8_ARRAY(expected, prefixOnly, Sha256::DIGEST_LEN);
+}
+
+void setup()
+{
+  // Wait for the serial monitor
+  delay(2000);
+
+  UNITY_BEGIN();
+  RUN_TEST(test_fips_vectors);
+  RUN_TEST(test_matches_portable);
+  RUN_TEST(test_copy_forks);
+  UNITY_END();
+}
+
+void loop() {}
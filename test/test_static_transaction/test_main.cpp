@@ -0,0 +1,169 @@
+// Build, sign and serialize the same instructions as a StaticTransaction
+// and as a Transaction, and check the bytes are identical. Ed25519
+// signatures are deterministic, so that covers the signatures too.
+
+#include <Arduino.h>
+#include <unity.h>
+#include <array>
+#include <vector>
+#include "SolanaSDK/static_transaction.h"
+
+namespace
+{
+  using SmallTransaction = StaticTransaction<8, 3, 64, 2>;
+
+  Keypair keypair(uint8_t fill)
+  {
+    return Keypair(std::vector<unsigned char>(SECRET_KEY_LEN, fill));
+  }
+
+  PublicKey key(uint8_t fill)
+  {
+    return PublicKey(std::vector<uint8_t>(PUBLIC_KEY_LEN, fill));
+  }
+
+  const Keypair PAYER = keypair(1);
+  const Keypair CO_SIGNER = keypair(2);
+  const PublicKey PROGRAM = key(0x30);
+  const PublicKey OTHER_PROGRAM = key(0x31);
+  const PublicKey RECIPIENT = key(0x40);
+  const PublicKey ORACLE = key(0x50);
+
+  const AccountMeta TRANSFER_ACCOUNTS[] = {
+      AccountMeta::newWritable(PAYER.publicKey, true),
+      AccountMeta::newWritable(RECIPIENT, false),
+  };
+  const AccountMeta APPROVE_ACCOUNTS[] = {
+      AccountMeta::newReadonly(ORACLE, false),
+      AccountMeta::newReadonly(CO_SIGNER.publicKey, true),
+      AccountMeta::newWritable(RECIPIENT, false),
+  };
+  const uint8_t TRANSFER_DATA[] = {2, 0, 0, 0, 0x40, 0x42, 0x0f, 0, 0, 0, 0, 0};
+  const uint8_t APPROVE_DATA[] = {7};
+
+  std::vector<Instruction> instructions()
+  {
+    std::vector<Instruction> result;
+    result.emplace_back(PROGRAM, Span<const AccountMeta>(TRANSFER_ACCOUNTS), Span<const uint8_t>(TRANSFER_DATA));
+    result.emplace_back(OTHER_PROGRAM, Span<const AccountMeta>(APPROVE_ACCOUNTS), Span<const uint8_t>(APPROVE_DATA));
+    result.emplace_back(PROGRAM, Span<const AccountMeta>(), Span<const uint8_t>());
+    return result;
+  }
+
+  Hash blockhash(uint8_t fill)
+  {
+    return Hash(std::vector<uint8_t>(HASH_BYTES, fill));
+  }
+
+  std::vector<uint8_t> signedTransaction(const Hash &recentBlockhash)
+  {
+    Transaction transaction(Message::newWithBlockhash(instructions(), PAYER.publicKey, recentBlockhash));
+    std::vector<KeypairSigner> keypairs = {KeypairSigner(PAYER), KeypairSigner(CO_SIGNER)};
+    Signers signers(keypairs);
+    TEST_ASSERT_TRUE(static_cast<bool>(transaction.trySign(signers, recentBlockhash)));
+    return transaction.serialize();
+  }
+
+  void checkSameBytes(const SmallTransaction &staticTransaction, const std::vector<uint8_t> &expected)
+  {
+    uint8_t bytes[SmallTransaction::MAX_SERIALIZED_SIZE];
+    Result<size_t> written = staticTransaction.serializeInto(Span<uint8_t>(bytes));
+    TEST_ASSERT_TRUE(static_cast<bool>(written));
+    TEST_ASSERT_EQUAL(expected.size(), written.value());
+    TEST_ASSERT_EQUAL(expected.size(), staticTransaction.serializedSize());
+    TEST_ASSERT_EQUAL_UINT8_ARRAY(expected.data(), bytes, expected.size());
+  }
+}
+
+void setUp() {}
+
+void tearDown() {}
+
+void test_same_bytes_as_transaction()
+{
+  const Hash recentBlockhash = blockhash(0xb1);
+  Keypair keypairs[] = {CO_SIGNER, PAYER};
+
+  SmallTransaction staticTransaction;
+  TEST_ASSERT_TRUE(static_cast<bool>(staticTransaction.tryCompile(instructions(), PAYER.publicKey, recentBlockhash)));
+  TEST_ASSERT_EQUAL(2, staticTransaction.signatureCount());
+  TEST_ASSERT_TRUE(static_cast<bool>(staticTransaction.trySign(Span<Keypair>(keypairs), recentBlockhash)));
+  TEST_ASSERT_TRUE(static_cast<bool>(staticTransaction.tryVerify()));
+  checkSameBytes(staticTransaction, signedTransaction(recentBlockhash));
+}
+
+void test_instruction_refs()
+{
+  // Borrowed instructions in a fixed size array compile to the same bytes
+  const std::array<InstructionRef, 3> refs = {
+      InstructionRef{PROGRAM, Span<const AccountMeta>(TRANSFER_ACCOUNTS), Span<const uint8_t>(TRANSFER_DATA)},
+      InstructionRef{OTHER_PROGRAM, Span<const AccountMeta>(APPROVE_ACCOUNTS), Span<const uint8_t>(APPROVE_DATA)},
+      InstructionRef{PROGRAM, Span<const AccountMeta>(), Span<const uint8_t>()},
+  };
+  const Hash recentBlockhash = blockhash(0xb2);
+  Keypair keypairs[] = {PAYER, CO_SIGNER};
+
+  SmallTransaction staticTransaction;
+  staticTransaction.compile(refs, PAYER.publicKey, recentBlockhash);
+  TEST_ASSERT_TRUE(static_cast<bool>(staticTransaction.trySign(Span<Keypair>(keypairs), recentBlockhash)));
+  checkSameBytes(staticTransaction, signedTransaction(recentBlockhash));
+}
+
+void test_new_blockhash_resigns()
+{
+  Keypair payerOnly[] = {PAYER};
+  Keypair coSignerOnly[] = {CO_SIGNER};
+  SmallTransaction staticTransaction;
+  staticTransaction.compile(instructions(), PAYER.publicKey, blockhash(0xb1));
+  TEST_ASSERT_TRUE(static_cast<bool>(staticTransaction.tryPartialSign(Span<Keypair>(payerOnly), blockhash(0xb1))));
+
+  // The co-signer signs over a new blockhash, which drops the payer's
+  // signature over the old one
+  Result<void> incomplete = staticTransaction.trySign(Span<Keypair>(coSignerOnly), blockhash(0xb3));
+  TEST_ASSERT_FALSE(static_cast<bool>(incomplete));
+  TEST_ASSERT_EQUAL_STRING("Not enough signers", incomplete.error().what());
+
+  TEST_ASSERT_TRUE(static_cast<bool>(staticTransaction.trySign(Span<Keypair>(payerOnly), blockhash(0xb3))));
+  checkSameBytes(staticTransaction, signedTransaction(blockhash(0xb3)));
+}
+
+void test_capacity_errors()
+{
+  StaticTransaction<4, 3, 64, 2> fewKeys;
+  Result<void> compiled = fewKeys.tryCompile(instructions(), PAYER.publicKey, blockhash(0xb1));
+  TEST_ASSERT_FALSE(static_cast<bool>(compiled));
+  TEST_ASSERT_EQUAL_STRING("More account keys than MaxKeys", compiled.error().what());
+  TEST_ASSERT_EQUAL(0, fewKeys.signatureCount());
+
+  StaticTransaction<8, 3, 8, 2> littleData;
+  compiled = littleData.tryCompile(instructions(), PAYER.publicKey, blockhash(0xb1));
+  TEST_ASSERT_FALSE(static_cast<bool>(compiled));
+  TEST_ASSERT_EQUAL_STRING("More instruction data than MaxDataBytes", compiled.error().what());
+
+  StaticTransaction<8, 3, 64, 1> oneSigner;
+  compiled = oneSigner.tryCompile(instructions(), PAYER.publicKey, blockhash(0xb1));
+  TEST_ASSERT_FALSE(static_cast<bool>(compiled));
+  TEST_ASSERT_EQUAL_STRING("More signers than MaxSigners", compiled.error().what());
+
+  Keypair stranger[] = {keypair(9)};
+  SmallTransaction staticTransaction;
+  staticTransaction.compile(instructions(), PAYER.publicKey, blockhash(0xb1));
+  Result<void> signResult = staticTransaction.trySign(Span<Keypair>(stranger), blockhash(0xb1));
+  TEST_ASSERT_FALSE(static_cast<bool>(signResult));
+  TEST_ASSERT_EQUAL_STRING("Keypair public key mismatch", signResult.error().what());
+}
+
+void setup()
+{
+  // Wait for the serial monitor
+  delay(2000);
+
+  UNITY_BEGIN();
+  RUN_TEST(test_same_bytes_as_transaction);
+  RUN_TEST(test_instruction_refs);
+  RUN_TEST(test_new_blockhash_resigns);
+  RUN_TEST(test_capacity_errors);
+  UNITY_END();
+}
+
+void loop() {}
@@ -0,0 +1,119 @@
+// Deserialize and verify signed transactions as a node sends them. Both
+// are a transfer of 0.001 SOL from the one signer, so most of their
+// accounts sign nothing: the legacy one lists the recipient and the system
+// program, the v0 one the system program and loads the recipient from an
+// address lookup table.
+
+#include <Arduino.h>
+#include <unity.h>
+#include <vector>
+#include "SolanaSDK/transaction.h"
+
+namespace
+{
+  const uint8_t LEGACY_TRANSFER[] = {
+      0x01, 0xef, 0x5e, 0x86, 0x1d, 0xdb, 0x0b, 0x08, 0xfc, 0xc0, 0xe4, 0x68, 0x5d, 0xf8, 0xa3, 0xd7,
+      0xab, 0xa7, 0xfd, 0xd5, 0x9b, 0x1e, 0xbd, 0xa7, 0xa0, 0xa6, 0xe4, 0x2e, 0xed, 0x54, 0xd5, 0xb5,
+      0x10, 0x73, 0x9e, 0x55, 0xdb, 0xaa, 0xe1, 0x15, 0xe5, 0xf0, 0x92, 0xed, 0x26, 0x7f, 0x2c, 0x49,
+      0x07, 0x97, 0x49, 0x75, 0xa8, 0x94, 0xb1, 0x18, 0x7f, 0xb6, 0xe8, 0xb3, 0x96, 0x8d, 0x09, 0x09,
+      0x00, 0x01, 0x00, 0x01, 0x03, 0x79, 0xb5, 0x56, 0x2e, 0x8f, 0xe6, 0x54, 0xf9, 0x40, 0x78, 0xb1,
+      0x12, 0xe8, 0xa9, 0x8b, 0xa7, 0x90, 0x1f, 0x85, 0x3a, 0xe6, 0x95, 0xbe, 0xd7, 0xe0, 0xe3, 0x91,
+      0x0b, 0xad, 0x04, 0x96, 0x64, 0xa0, 0xa1, 0xa2, 0xa3, 0xa4, 0xa5, 0xa6, 0xa7, 0xa8, 0xa9, 0xaa,
+      0xab, 0xac, 0xad, 0xae, 0xaf, 0xa1, 0xa2, 0xa3, 0xa4, 0xa5, 0xa6, 0xa7, 0xa8, 0xa9, 0xaa, 0xab,
+      0xac, 0xad, 0xae, 0xaf, 0xb0, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+      0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+      0x00, 0x00, 0x00, 0x00, 0x00, 0x0b, 0x30, 0x55, 0x7a, 0x9f, 0xc4, 0xe9, 0x0e, 0x33, 0x58, 0x7d,
+      0xa2, 0xc7, 0xec, 0x11, 0x36, 0x5b, 0x80, 0xa5, 0xca, 0xef, 0x14, 0x39, 0x5e, 0x83, 0xa8, 0xcd,
+      0xf2, 0x17, 0x3c, 0x61, 0x86, 0x01, 0x02, 0x02, 0x00, 0x01, 0x0c, 0x02, 0x00, 0x00, 0x00, 0x40,
+      0x42, 0x0f, 0x00, 0x00, 0x00, 0x00, 0x00,};
+  const uint8_t V0_TRANSFER[] = {
+      0x01, 0x38, 0xf4, 0xec, 0x68, 0xf1, 0xfe, 0x70, 0xb0, 0xea, 0xc0, 0x42, 0x13, 0xa5, 0x87, 0x65,
+      0x3b, 0x9d, 0xe9, 0x07, 0xce, 0x31, 0xc0, 0x53, 0xda, 0x55, 0xb9, 0xf2, 0x04, 0x32, 0x28, 0x80,
+      0x51, 0xe9, 0x3d, 0x53, 0xb0, 0xee, 0xd5, 0xa9, 0x54, 0xe1, 0xf1, 0x12, 0xfc, 0x54, 0xce, 0x64,
+      0xa8, 0xf7, 0x32, 0x8a, 0xed, 0x68, 0x43, 0x0e, 0x08, 0x5d, 0xfa, 0xdb, 0xe9, 0x8a, 0xc3, 0xa8,
+      0x07, 0x80, 0x01, 0x00, 0x01, 0x02, 0x79, 0xb5, 0x56, 0x2e, 0x8f, 0xe6, 0x54, 0xf9, 0x40, 0x78,
+      0xb1, 0x12, 0xe8, 0xa9, 0x8b, 0xa7, 0x90, 0x1f, 0x85, 0x3a, 0xe6, 0x95, 0xbe, 0xd7, 0xe0, 0xe3,
+      0x91, 0x0b, 0xad, 0x04, 0x96, 0x64, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+      0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+      0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x0b, 0x30, 0x55, 0x7a, 0x9f, 0xc4, 0xe9, 0x0e, 0x33, 0x58,
+      0x7d, 0xa2, 0xc7, 0xec, 0x11, 0x36, 0x5b, 0x80, 0xa5, 0xca, 0xef, 0x14, 0x39, 0x5e, 0x83, 0xa8,
+      0xcd, 0xf2, 0x17, 0x3c, 0x61, 0x86, 0x01, 0x01, 0x02, 0x00, 0x02, 0x0c, 0x02, 0x00, 0x00, 0x00,
+      0x40, 0x42, 0x0f, 0x00, 0x00, 0x00, 0x00, 0x00, 0x01, 0x30, 0x33, 0x36, 0x39, 0x3c, 0x3f, 0x42,
+      0x45, 0x48, 0x4b, 0x4e, 0x51, 0x54, 0x57, 0x5a, 0x5d, 0x60, 0x63, 0x66, 0x69, 0x6c, 0x6f, 0x72,
+      0x75, 0x78, 0x7b, 0x7e, 0x81, 0x84, 0x87, 0x8a, 0x8d, 0x01, 0x05, 0x00,};
+
+  Transaction deserialize(const uint8_t *bytes, size_t len)
+  {
+    return Transaction::deserialize(std::vector<uint8_t>(bytes, bytes + len));
+  }
+
+  void checkVerifies(const uint8_t *bytes, size_t len, bool versioned)
+  {
+    Transaction transaction = deserialize(bytes, len);
+    TEST_ASSERT_EQUAL(versioned, transaction.getMessage().versioned);
+    TEST_ASSERT_EQUAL(1, transaction.signatures.size());
+    TEST_ASSERT_TRUE(transaction.getMessage().accountKeys.size() > transaction.signatures.size());
+
+    TEST_ASSERT_TRUE(static_cast<bool>(transaction.tryVerify()));
+    std::vector<bool> results = transaction.verifyWithResults();
+    TEST_ASSERT_EQUAL(1, results.size());
+    TEST_ASSERT_TRUE(results[0]);
+
+    // The bytes signed are the bytes received
+    std::vector<uint8_t> serialized = transaction.serialize();
+    TEST_ASSERT_EQUAL(len, serialized.size());
+    TEST_ASSERT_EQUAL_UINT8_ARRAY(bytes, serialized.data(), len);
+  }
+}
+
+void setUp() {}
+
+void tearDown() {}
+
+void test_legacy_transaction_verifies()
+{
+  checkVerifies(LEGACY_TRANSFER, sizeof(LEGACY_TRANSFER), false);
+}
+
+void test_v0_transaction_verifies()
+{
+  checkVerifies(V0_TRANSFER, sizeof(V0_TRANSFER), true);
+}
+
+void test_changed_message_fails_verification()
+{
+  Transaction transaction = deserialize(LEGACY_TRANSFER, sizeof(LEGACY_TRANSFER));
+  transaction.modifyMessage([](Message &message)
+                            { message.instructions[0].data[4] ^= 1; });
+  TEST_ASSERT_FALSE(static_cast<bool>(transaction.tryVerify()));
+}
+
+void test_verify_many()
+{
+  std::vector<Transaction> transactions;
+  transactions.push_back(deserialize(LEGACY_TRANSFER, sizeof(LEGACY_TRANSFER)));
+  transactions.push_back(deserialize(V0_TRANSFER, sizeof(V0_TRANSFER)));
+  transactions.push_back(deserialize(V0_TRANSFER, sizeof(V0_TRANSFER)));
+  transactions[2].signatures[0].value[0] ^= 1;
+
+  std::vector<std::vector<bool>> results = Transaction::verifyManyWithResults(transactions);
+  TEST_ASSERT_EQUAL(3, results.size());
+  TEST_ASSERT_TRUE(results[0][0]);
+  TEST_ASSERT_TRUE(results[1][0]);
+  TEST_ASSERT_FALSE(results[2][0]);
+}
+
+void setup()
+{
+  // Wait for the serial monitor
+  delay(2000);
+
+  UNITY_BEGIN();
+  RUN_TEST(test_legacy_transaction_verifies);
+  RUN_TEST(test_v0_transaction_verifies);
+  RUN_TEST(test_changed_message_fails_verification);
+  RUN_TEST(test_verify_many);
+  UNITY_END();
+}
+
+void loop() {}
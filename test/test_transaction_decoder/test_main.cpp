@@ -0,0 +1,225 @@
+// Feed TransactionDecoder a stream of transactions in chunks of every size,
+// then truncated, oversize and malformed input.
+
+#include <Arduino.h>
+#include <unity.h>
+#include <algorithm>
+#include <vector>
+#include "SolanaSDK/transaction_decoder.h"
+
+namespace
+{
+  Keypair keypair(uint8_t fill)
+  {
+    return Keypair(std::vector<unsigned char>(SECRET_KEY_LEN, fill));
+  }
+
+  PublicKey key(uint8_t fill)
+  {
+    return PublicKey(std::vector<uint8_t>(PUBLIC_KEY_LEN, fill));
+  }
+
+  const Keypair PAYER = keypair(1);
+  const Hash BLOCKHASH(std::vector<uint8_t>(HASH_BYTES, 0xbb));
+
+  // A signed transaction with `dataLen` bytes of instruction data, in the
+  // v0 layout with a lookup table or in the legacy layout
+  std::vector<uint8_t> signedTransaction(size_t dataLen, bool versioned)
+  {
+    const AccountMeta accounts[] = {
+        AccountMeta::newWritable(PAYER.publicKey, true),
+        AccountMeta::newWritable(key(0x40), false),
+        AccountMeta::newWritable(key(0x41), false),
+        AccountMeta::newReadonly(key(0x50), false),
+    };
+    std::vector<uint8_t> data(dataLen, 0x5a);
+    std::vector<Instruction> instructions;
+    instructions.emplace_back(key(0x30), Span<const AccountMeta>(accounts), Span<const uint8_t>(data));
+
+    std::vector<AddressLookupTableAccount> tables;
+    if (versioned)
+    {
+      tables.push_back({key(0xa0), {key(0x50), key(0x41), key(0x40)}});
+    }
+    Message message = Message::compileV0(instructions, PAYER.publicKey, tables, BLOCKHASH);
+    message.versioned = versioned;
+
+    Transaction transaction(std::move(message));
+    std::vector<KeypairSigner> keypairs = {KeypairSigner(PAYER)};
+    Signers signers(keypairs);
+    transaction.sign(signers, BLOCKHASH);
+    return transaction.serialize();
+  }
+
+  struct Stream
+  {
+    std::vector<uint8_t> bytes;
+    std::vector<std::vector<uint8_t>> transactions;
+
+    void append(const std::vector<uint8_t> &transaction)
+    {
+      bytes.insert(bytes.end(), transaction.begin(), transaction.end());
+      transactions.push_back(transaction);
+    }
+  };
+
+  // Transactions of both layouts, with data lengths on either side of the
+  // one byte compact-u16 limit
+  Stream stream()
+  {
+    Stream result;
+    result.append(signedTransaction(12, false));
+    result.append(signedTransaction(200, true));
+    result.append(signedTransaction(127, true));
+    result.append(signedTransaction(128, false));
+    return result;
+  }
+
+  // Feed `bytes` in chunks of `chunkSize`, collecting the decoded
+  // transactions, and return the first error if any
+  Result<void> feedAll(TransactionDecoder &decoder, Span<const uint8_t> bytes, size_t chunkSize, std::vector<std::vector<uint8_t>> &decoded)
+  {
+    for (size_t offset = 0; offset < bytes.size(); offset += chunkSize)
+    {
+      const size_t len = std::min(chunkSize, bytes.size() - offset);
+      Result<size_t> fed = decoder.feed(bytes.subspan(offset, len), [&](const TransactionView &view)
+                                        { decoded.push_back(view.toTransaction().serialize()); });
+      if (!fed)
+      {
+        return fed.error();
+      }
+    }
+    return {};
+  }
+
+  void checkFails(Span<const uint8_t> bytes, size_t chunkSize, const char *expected)
+  {
+    TransactionDecoder decoder;
+    std::vector<std::vector<uint8_t>> decoded;
+    Result<void> fed = feedAll(decoder, bytes, chunkSize, decoded);
+    TEST_ASSERT_FALSE(static_cast<bool>(fed));
+    TEST_ASSERT_EQUAL_STRING(expected, fed.error().what());
+    TEST_ASSERT_EQUAL(0, decoded.size());
+  }
+}
+
+void setUp() {}
+
+void tearDown() {}
+
+void test_every_chunk_size()
+{
+  const Stream input = stream();
+  for (size_t chunkSize = 1; chunkSize <= input.bytes.size(); ++chunkSize)
+  {
+    TransactionDecoder decoder;
+    std::vector<std::vector<uint8_t>> decoded;
+    TEST_ASSERT_TRUE(static_cast<bool>(feedAll(decoder, Span<const uint8_t>(input.bytes), chunkSize, decoded)));
+    TEST_ASSERT_TRUE(static_cast<bool>(decoder.finish()));
+    TEST_ASSERT_EQUAL(0, decoder.bufferedBytes());
+    TEST_ASSERT_EQUAL(input.transactions.size(), decoded.size());
+    for (size_t i = 0; i < decoded.size(); ++i)
+    {
+      TEST_ASSERT_EQUAL(input.transactions[i].size(), decoded[i].size());
+      TEST_ASSERT_EQUAL_UINT8_ARRAY(input.transactions[i].data(), decoded[i].data(), decoded[i].size());
+    }
+  }
+}
+
+void test_truncated()
+{
+  // Cut the stream at every byte of its last transaction
+  const Stream input = stream();
+  const size_t lastStart = input.bytes.size() - input.transactions.back().size();
+  for (size_t cut = lastStart + 1; cut < input.bytes.size(); ++cut)
+  {
+    for (size_t chunkSize : {size_t(1), size_t(64), input.bytes.size()})
+    {
+      TransactionDecoder decoder;
+      std::vector<std::vector<uint8_t>> decoded;
+      TEST_ASSERT_TRUE(static_cast<bool>(feedAll(decoder, Span<const uint8_t>(input.bytes.data(), cut), chunkSize, decoded)));
+      TEST_ASSERT_EQUAL(input.transactions.size() - 1, decoded.size());
+      TEST_ASSERT_EQUAL(cut - lastStart, decoder.bufferedBytes());
+
+      Result<void> finished = decoder.finish();
+      TEST_ASSERT_FALSE(static_cast<bool>(finished));
+      TEST_ASSERT_EQUAL_STRING("Truncated transaction", finished.error().what());
+
+      // The rest of the stream completes it
+      TEST_ASSERT_TRUE(static_cast<bool>(feedAll(decoder, Span<const uint8_t>(input.bytes).subspan(cut), chunkSize, decoded)));
+      TEST_ASSERT_TRUE(static_cast<bool>(decoder.finish()));
+      TEST_ASSERT_EQUAL(input.transactions.size(), decoded.size());
+      TEST_ASSERT_EQUAL_UINT8_ARRAY(input.transactions.back().data(), decoded.back().data(), decoded.back().size());
+    }
+  }
+}
+
+void test_oversize()
+{
+  // A well formed transaction one byte past the packet size limit, its
+  // data length taking a second compact-u16 byte
+  const size_t baseSize = signedTransaction(0, true).size();
+  std::vector<uint8_t> tooLarge = signedTransaction(PACKET_DATA_SIZE - baseSize, true);
+  TEST_ASSERT_EQUAL(PACKET_DATA_SIZE + 1, tooLarge.size());
+  for (size_t chunkSize : {size_t(1), size_t(100), tooLarge.size()})
+  {
+    checkFails(Span<const uint8_t>(tooLarge), chunkSize, "Transaction larger than PACKET_DATA_SIZE");
+  }
+
+  // One data byte less fits exactly
+  std::vector<uint8_t> largest = signedTransaction(PACKET_DATA_SIZE - baseSize - 1, true);
+  TEST_ASSERT_EQUAL(PACKET_DATA_SIZE, largest.size());
+  TransactionDecoder decoder;
+  std::vector<std::vector<uint8_t>> decoded;
+  TEST_ASSERT_TRUE(static_cast<bool>(feedAll(decoder, Span<const uint8_t>(largest), 100, decoded)));
+  TEST_ASSERT_EQUAL(1, decoded.size());
+
+  // Lengths that announce more than fits are rejected before the bytes
+  // they announce arrive
+  const uint8_t manySignatures[] = {0xff, 0x7f};
+  checkFails(Span<const uint8_t>(manySignatures), 1, "Transaction larger than PACKET_DATA_SIZE");
+}
+
+void test_malformed()
+{
+  const uint8_t overlongLength[] = {0x80, 0x00};
+  checkFails(Span<const uint8_t>(overlongLength), 1, "Invalid length");
+
+  std::vector<uint8_t> version1 = signedTransaction(12, true);
+  version1[1 + SIGNATURE_BYTES] = 0x81;
+  checkFails(Span<const uint8_t>(version1), 1, "Unsupported message version");
+}
+
+void test_error_sticks_until_reset()
+{
+  const Stream input = stream();
+  const uint8_t overlongLength[] = {0x80, 0x00};
+  TransactionDecoder decoder;
+  std::vector<std::vector<uint8_t>> decoded;
+  TEST_ASSERT_FALSE(static_cast<bool>(feedAll(decoder, Span<const uint8_t>(overlongLength), 2, decoded)));
+
+  Result<void> fed = feedAll(decoder, Span<const uint8_t>(input.bytes), input.bytes.size(), decoded);
+  TEST_ASSERT_FALSE(static_cast<bool>(fed));
+  TEST_ASSERT_EQUAL_STRING("Invalid length", fed.error().what());
+  TEST_ASSERT_FALSE(static_cast<bool>(decoder.finish()));
+
+  decoder.reset();
+  TEST_ASSERT_TRUE(static_cast<bool>(feedAll(decoder, Span<const uint8_t>(input.bytes), 7, decoded)));
+  TEST_ASSERT_EQUAL(input.transactions.size(), decoded.size());
+}
+
+void setup()
+{
+  // Wait for the serial monitor
+  delay(2000);
+
+  UNITY_BEGIN();
+  RUN_TEST(test_every_chunk_size);
+  RUN_TEST(test_truncated);
+  RUN_TEST(test_oversize);
+  RUN_TEST(test_malformed);
+  RUN_TEST(test_error_sticks_until_reset);
+  UNITY_END();
+}
+
+void loop() {}
@@ -0,0 +1,187 @@
+// Check that TransactionSizeEstimator predicts the exact serialized size and
+// header of the compiled transaction as instructions are added one by one,
+// and that packInstructions fills each batch as far as the limit allows.
+
+#include <Arduino.h>
+#include <unity.h>
+#include <vector>
+#include "SolanaSDK/transaction_size.h"
+
+namespace
+{
+  const PublicKey PAYER = PublicKey(std::vector<uint8_t>(PUBLIC_KEY_LEN, 0x01));
+  const Hash BLOCKHASH(std::vector<uint8_t>(HASH_BYTES, 0xbb));
+
+  // Small deterministic generator, so failures reproduce
+  struct Random
+  {
+    uint32_t state;
+
+    uint32_t next(uint32_t bound)
+    {
+      state = state * 1664525u + 1013904223u;
+      return (state >> 8) % bound;
+    }
+  };
+
+  PublicKey poolKey(size_t index)
+  {
+    std::vector<uint8_t> bytes(PUBLIC_KEY_LEN, 0);
+    bytes[0] = 0x80;
+    bytes[1] = static_cast<uint8_t>(index >> 8);
+    bytes[2] = static_cast<uint8_t>(index);
+    return PublicKey(bytes);
+  }
+
+  // An instruction over keys drawn from a pool of `poolSize`, the payer
+  // among them, so accounts repeat across instructions and are promoted to
+  // signer or writable by later ones. Data lengths straddle the one and two
+  // byte compact-u16 encodings.
+  Instruction randomInstruction(Random &random, size_t poolSize, size_t maxAccounts)
+  {
+    std::vector<AccountMeta> accounts(random.next(maxAccounts + 1));
+    for (AccountMeta &account : accounts)
+    {
+      const size_t index = random.next(poolSize);
+      const PublicKey key = index == 0 ? PAYER : poolKey(index);
+      const bool isSigner = random.next(8) == 0;
+      account = random.next(2) ? AccountMeta::newWritable(key, isSigner) : AccountMeta::newReadonly(key, isSigner);
+    }
+    std::vector<uint8_t> data(random.next(4) == 0 ? 120 + random.next(16) : random.next(40), 0x5a);
+    return Instruction(poolKey(1000 + random.next(4)), Span<const AccountMeta>(accounts), Span<const uint8_t>(data));
+  }
+
+  Transaction compile(Span<const Instruction> instructions)
+  {
+    std::vector<Instruction> copy(instructions.begin(), instructions.end());
+    return Transaction(Message::newWithBlockhash(copy, PAYER, BLOCKHASH));
+  }
+
+  void checkEstimates(uint32_t seed, size_t count, size_t poolSize, size_t maxAccounts)
+  {
+    Random random{seed};
+    TransactionSizeEstimator estimator(PAYER);
+    std::vector<Instruction> instructions;
+    TEST_ASSERT_EQUAL(compile(instructions).serializedSize(), estimator.size());
+
+    for (size_t i = 0; i < count; ++i)
+    {
+      Instruction instruction = randomInstruction(random, poolSize, maxAccounts);
+      const size_t predicted = estimator.sizeWith(instruction);
+      estimator.add(instruction);
+      instructions.push_back(instruction);
+
+      Transaction transaction = compile(instructions);
+      TEST_ASSERT_EQUAL(transaction.serializedSize(), estimator.size());
+      TEST_ASSERT_EQUAL(transaction.serialize().size(), estimator.size());
+      TEST_ASSERT_EQUAL(predicted, estimator.size());
+
+      const MessageHeader expected = transaction.getMessage().header;
+      const MessageHeader header = estimator.header();
+      TEST_ASSERT_EQUAL(expected.numRequiredSignatures, header.numRequiredSignatures);
+      TEST_ASSERT_EQUAL(expected.numReadonlySignedAccounts, header.numReadonlySignedAccounts);
+      TEST_ASSERT_EQUAL(expected.numReadonlyUnsignedAccounts, header.numReadonlyUnsignedAccounts);
+      TEST_ASSERT_EQUAL(transaction.getMessage().accountKeys.size(), estimator.numAccountKeys());
+    }
+  }
+}
+
+void setUp() {}
+
+void tearDown() {}
+
+void test_exact_size()
+{
+  checkEstimates(1, 40, 24, 6);
+  checkEstimates(2, 40, 64, 10);
+}
+
+void test_exact_size_past_127_keys()
+{
+  // The key count takes a second compact-u16 byte past 127 keys
+  checkEstimates(3, 24, 400, 24);
+}
+
+void test_clear()
+{
+  Random random{4};
+  TransactionSizeEstimator estimator(PAYER);
+  const size_t empty = estimator.size();
+  for (size_t i = 0; i < 10; ++i)
+  {
+    estimator.add(randomInstruction(random, 32, 6));
+  }
+  estimator.clear();
+  TEST_ASSERT_EQUAL(empty, estimator.size());
+  TEST_ASSERT_EQUAL(0, estimator.numInstructions());
+  TEST_ASSERT_EQUAL(1, estimator.numAccountKeys());
+  TEST_ASSERT_EQUAL(1, estimator.header().numRequiredSignatures);
+
+  // A cleared estimator is as exact as a new one
+  std::vector<Instruction> instructions;
+  for (size_t i = 0; i < 10; ++i)
+  {
+    instructions.push_back(randomInstruction(random, 32, 6));
+    estimator.add(instructions.back());
+  }
+  TEST_ASSERT_EQUAL(compile(instructions).serializedSize(), estimator.size());
+}
+
+void test_pack_instructions()
+{
+  Random random{5};
+  std::vector<Instruction> instructions;
+  for (size_t i = 0; i < 120; ++i)
+  {
+    instructions.push_back(randomInstruction(random, 80, 8));
+  }
+
+  Result<std::vector<Span<const Instruction>>> packed = packInstructions(instructions, PAYER);
+  TEST_ASSERT_TRUE(static_cast<bool>(packed));
+  const std::vector<Span<const Instruction>> &batches = packed.value();
+  TEST_ASSERT_TRUE(batches.size() > 1);
+
+  // Batches cover the instructions in order, each fits, and none could
+  // have taken the next instruction
+  const Instruction *next = instructions.data();
+  for (size_t b = 0; b < batches.size(); ++b)
+  {
+    TEST_ASSERT_TRUE(batches[b].data() == next);
+    TEST_ASSERT_TRUE(compile(batches[b]).serializedSize() <= PACKET_DATA_SIZE);
+    next += batches[b].size();
+    if (b + 1 < batches.size())
+    {
+      TEST_ASSERT_TRUE(compile(Span<const Instruction>(batches[b].data(), batches[b].size() + 1)).serializedSize() > PACKET_DATA_SIZE);
+    }
+  }
+  TEST_ASSERT_TRUE(next == instructions.data() + instructions.size());
+}
+
+void test_pack_rejects_oversize_instruction()
+{
+  std::vector<uint8_t> data(PACKET_DATA_SIZE, 0);
+  std::vector<Instruction> instructions;
+  instructions.emplace_back(poolKey(1000), Span<const AccountMeta>(), Span<const uint8_t>(data));
+
+  TransactionSizeEstimator estimator(PAYER);
+  TEST_ASSERT_FALSE(estimator.fits(instructions[0]));
+  TEST_ASSERT_FALSE(estimator.tryAdd(instructions[0]));
+  TEST_ASSERT_EQUAL(0, estimator.numInstructions());
+  TEST_ASSERT_FALSE(static_cast<bool>(packInstructions(instructions, PAYER)));
+}
+
+void setup()
+{
+  // Wait for the serial monitor
+  delay(2000);
+
+  UNITY_BEGIN();
+  RUN_TEST(test_exact_size);
+  RUN_TEST(test_exact_size_past_127_keys);
+  RUN_TEST(test_clear);
+  RUN_TEST(test_pack_instructions);
+  RUN_TEST(test_pack_rejects_oversize_instruction);
+  UNITY_END();
+}
+
+void loop() {}
@@ -0,0 +1,205 @@
+// Patch the blockhash, an amount and an account of a TransactionTemplate
+// and re-sign it, then check the bytes against a Transaction compiled and
+// signed from scratch with the patched values.
+
+#include <Arduino.h>
+#include <unity.h>
+#include <vector>
+#include "SolanaSDK/transaction_template.h"
+#include "SolanaSDK/transaction.h"
+
+namespace
+{
+  Keypair keypair(uint8_t fill)
+  {
+    return Keypair(std::vector<unsigned char>(SECRET_KEY_LEN, fill));
+  }
+
+  PublicKey key(uint8_t fill)
+  {
+    return PublicKey(std::vector<uint8_t>(PUBLIC_KEY_LEN, fill));
+  }
+
+  Hash blockhash(uint8_t fill)
+  {
+    return Hash(std::vector<uint8_t>(HASH_BYTES, fill));
+  }
+
+  const Keypair PAYER = keypair(1);
+  const PublicKey PROGRAM = key(0x30);
+  const PublicKey ORACLE = key(0x50);
+
+  // A transfer of `lamports` to `recipient`, which is the only writable
+  // non-signer, so replacing it keeps the compiled key order
+  std::vector<Instruction> transfer(const PublicKey &recipient, uint64_t lamports)
+  {
+    const AccountMeta accounts[] = {
+        AccountMeta::newWritable(PAYER.publicKey, true),
+        AccountMeta::newWritable(recipient, false),
+        AccountMeta::newReadonly(ORACLE, false),
+    };
+    uint8_t data[12] = {2, 0, 0, 0};
+    for (size_t i = 0; i < 8; ++i)
+    {
+      data[4 + i] = static_cast<uint8_t>(lamports >> (8 * i));
+    }
+    std::vector<Instruction> instructions;
+    instructions.emplace_back(PROGRAM, Span<const AccountMeta>(accounts), Span<const uint8_t>(data));
+    return instructions;
+  }
+
+  Message compile(const PublicKey &recipient, uint64_t lamports, const Hash &recentBlockhash, bool versioned)
+  {
+    Message message = Message::newWithBlockhash(transfer(recipient, lamports), PAYER.publicKey, recentBlockhash);
+    message.versioned = versioned;
+    return message;
+  }
+
+  std::vector<uint8_t> signedBytes(Message message)
+  {
+    Transaction transaction(std::move(message));
+    std::vector<KeypairSigner> keypairs = {KeypairSigner(PAYER)};
+    Signers signers(keypairs);
+    TEST_ASSERT_TRUE(static_cast<bool>(transaction.trySign(signers, transaction.getMessage().recentBlockhash)));
+    return transaction.serialize();
+  }
+
+  void checkBytes(const TransactionTemplate &transactionTemplate, const std::vector<uint8_t> &expected)
+  {
+    TEST_ASSERT_EQUAL(expected.size(), transactionTemplate.data().size());
+    TEST_ASSERT_EQUAL_UINT8_ARRAY(expected.data(), transactionTemplate.data().data(), expected.size());
+  }
+
+  size_t indexOf(const TransactionTemplate &transactionTemplate, const PublicKey &key)
+  {
+    size_t index = 0;
+    while (index < transactionTemplate.numAccountKeys() && !(transactionTemplate.accountKey(index) == key))
+    {
+      ++index;
+    }
+    return index;
+  }
+
+  void checkPatchAndResign(bool versioned)
+  {
+    TransactionTemplate transactionTemplate(compile(key(0x40), 1000, blockhash(0xb1), versioned));
+    TEST_ASSERT_FALSE(transactionTemplate.isSigned());
+    checkBytes(transactionTemplate, Transaction(compile(key(0x40), 1000, blockhash(0xb1), versioned)).serialize());
+
+    Result<size_t> amount = transactionTemplate.tryMarkData(0, 4, 8);
+    TEST_ASSERT_TRUE(static_cast<bool>(amount));
+    std::vector<KeypairSigner> keypairs = {KeypairSigner(PAYER)};
+    Signers signers(keypairs);
+
+    // Each round patches all three and signs again
+    for (uint8_t round = 0; round < 3; ++round)
+    {
+      const PublicKey recipient = key(0x41 + round);
+      const uint64_t lamports = 5000 + 0x0102030405ull * round;
+      const Hash recentBlockhash = blockhash(0xc0 + round);
+
+      const size_t recipientIndex = indexOf(transactionTemplate, key(0x40 + round));
+      TEST_ASSERT_TRUE(static_cast<bool>(transactionTemplate.trySetAccountKey(recipientIndex, recipient)));
+      TEST_ASSERT_TRUE(static_cast<bool>(transactionTemplate.trySetU64(amount.value(), lamports)));
+      transactionTemplate.setRecentBlockhash(recentBlockhash);
+      TEST_ASSERT_TRUE(static_cast<bool>(transactionTemplate.trySign(signers)));
+      TEST_ASSERT_TRUE(transactionTemplate.isSigned());
+
+      const std::vector<uint8_t> expected = signedBytes(compile(recipient, lamports, recentBlockhash, versioned));
+      checkBytes(transactionTemplate, expected);
+      TEST_ASSERT_TRUE(static_cast<bool>(Transaction::deserialize(expected).tryVerify()));
+
+      // Any patch makes the signature stale
+      TEST_ASSERT_TRUE(static_cast<bool>(transactionTemplate.trySetU64(amount.value(), lamports + 1)));
+      TEST_ASSERT_FALSE(transactionTemplate.isSigned());
+      TEST_ASSERT_TRUE(static_cast<bool>(transactionTemplate.trySetU64(amount.value(), lamports)));
+    }
+  }
+}
+
+void setUp() {}
+
+void tearDown() {}
+
+void test_patch_and_resign_v0()
+{
+  checkPatchAndResign(true);
+}
+
+void test_patch_and_resign_legacy()
+{
+  checkPatchAndResign(false);
+}
+
+void test_set_data()
+{
+  TransactionTemplate transactionTemplate(compile(key(0x40), 1000, blockhash(0xb1), true));
+  const size_t tag = transactionTemplate.markData(0, 0, 4);
+  const uint8_t newTag[] = {3, 0, 0, 0};
+  transactionTemplate.setData(tag, Span<const uint8_t>(newTag));
+
+  // The same message with the tag changed by hand
+  Message expected = compile(key(0x40), 1000, blockhash(0xb1), true);
+  expected.instructions[0].data[0] = 3;
+  checkBytes(transactionTemplate, Transaction(expected).serialize());
+}
+
+void test_errors()
+{
+  TransactionTemplate transactionTemplate(compile(key(0x40), 1000, blockhash(0xb1), true));
+
+  Result<size_t> marked = transactionTemplate.tryMarkData(1, 0, 1);
+  TEST_ASSERT_FALSE(static_cast<bool>(marked));
+  TEST_ASSERT_EQUAL_STRING("Instruction index out of range", marked.error().what());
+  marked = transactionTemplate.tryMarkData(0, 5, 8);
+  TEST_ASSERT_FALSE(static_cast<bool>(marked));
+  TEST_ASSERT_EQUAL_STRING("Field out of the instruction data", marked.error().what());
+
+  const size_t amount = transactionTemplate.markData(0, 4, 8);
+  const uint8_t shortValue[4] = {};
+  Result<void> result = transactionTemplate.trySetData(amount, Span<const uint8_t>(shortValue));
+  TEST_ASSERT_FALSE(static_cast<bool>(result));
+  TEST_ASSERT_EQUAL_STRING("Field length mismatch", result.error().what());
+  result = transactionTemplate.trySetU64(amount + 1, 1);
+  TEST_ASSERT_FALSE(static_cast<bool>(result));
+  TEST_ASSERT_EQUAL_STRING("Unknown field", result.error().what());
+
+  // The payer signs and the program is invoked, neither can move
+  const size_t pinned[] = {indexOf(transactionTemplate, PAYER.publicKey), indexOf(transactionTemplate, PROGRAM)};
+  for (size_t index : pinned)
+  {
+    result = transactionTemplate.trySetAccountKey(index, key(0x99));
+    TEST_ASSERT_FALSE(static_cast<bool>(result));
+    TEST_ASSERT_EQUAL_STRING("Signer and program keys cannot be replaced", result.error().what());
+  }
+  result = transactionTemplate.trySetAccountKey(indexOf(transactionTemplate, key(0x40)), ORACLE);
+  TEST_ASSERT_FALSE(static_cast<bool>(result));
+  TEST_ASSERT_EQUAL_STRING("Account key already in the message", result.error().what());
+  result = transactionTemplate.trySetAccountKey(transactionTemplate.numAccountKeys(), key(0x99));
+  TEST_ASSERT_FALSE(static_cast<bool>(result));
+  TEST_ASSERT_EQUAL_STRING("Account index out of range", result.error().what());
+
+  // A keypair that is not a signer signs nothing
+  std::vector<KeypairSigner> strangers = {KeypairSigner(keypair(9))};
+  Signers signers(strangers);
+  result = transactionTemplate.trySign(signers);
+  TEST_ASSERT_FALSE(static_cast<bool>(result));
+  TEST_ASSERT_EQUAL_STRING("Keypair public key mismatch", result.error().what());
+  TEST_ASSERT_FALSE(transactionTemplate.isSigned());
+  checkBytes(transactionTemplate, Transaction(compile(key(0x40), 1000, blockhash(0xb1), true)).serialize());
+}
+
+void setup()
+{
+  // Wait for the serial monitor
+  delay(2000);
+
+  UNITY_BEGIN();
+  RUN_TEST(test_patch_and_resign_v0);
+  RUN_TEST(test_patch_and_resign_legacy);
+  RUN_TEST(test_set_data);
+  RUN_TEST(test_errors);
+  UNITY_END();
+}
+
+void loop() {}
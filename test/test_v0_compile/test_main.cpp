@@ -0,0 +1,249 @@
+// Compile v0 messages against address lookup tables and check which keys
+// are loaded, where instructions then point, and that the bytes round trip.
+
+#include <Arduino.h>
+#include <unity.h>
+#include <vector>
+#include "SolanaSDK/message.h"
+
+namespace
+{
+  // A key of 32 copies of `byte`, so keys sort by `byte`
+  PublicKey key(uint8_t byte)
+  {
+    return PublicKey(std::vector<uint8_t>(PUBLIC_KEY_LEN, byte));
+  }
+
+  const PublicKey PAYER = key(0x10);
+  const PublicKey SIGNER = key(0x20);
+  const PublicKey PROGRAM = key(0x30);
+  const PublicKey WRITABLE_A = key(0x40);
+  const PublicKey WRITABLE_B = key(0x41);
+  const PublicKey READONLY_A = key(0x50);
+  const PublicKey READONLY_B = key(0x51);
+  const PublicKey UNLISTED = key(0x60);
+  const PublicKey OTHER = key(0x70);
+
+  const Hash BLOCKHASH(std::vector<uint8_t>(HASH_BYTES, 0xbb));
+
+  std::vector<Instruction> instructions()
+  {
+    const AccountMeta accounts[] = {
+        AccountMeta::newWritable(PAYER, true),
+        AccountMeta::newReadonly(SIGNER, true),
+        AccountMeta::newWritable(WRITABLE_A, false),
+        AccountMeta::newReadonly(READONLY_A, false),
+        AccountMeta::newWritable(WRITABLE_B, false),
+        AccountMeta::newReadonly(READONLY_B, false),
+        AccountMeta::newReadonly(UNLISTED, false),
+    };
+    const uint8_t data[] = {1, 2, 3};
+    std::vector<Instruction> result;
+    result.emplace_back(PROGRAM, Span<const AccountMeta>(accounts), Span<const uint8_t>(data));
+    return result;
+  }
+
+  // The static keys, then the keys each lookup loads, writable ones first,
+  // in the order the runtime resolves them
+  void resolveKeys(const Message &message, const std::vector<AddressLookupTableAccount> &tables, std::vector<PublicKey> &keys)
+  {
+    keys.assign(message.accountKeys.begin(), message.accountKeys.end());
+    std::vector<PublicKey> readonly;
+    for (const AddressLookupTable &lookup : message.addressTableLookups)
+    {
+      const AddressLookupTableAccount *table = nullptr;
+      for (const AddressLookupTableAccount &candidate : tables)
+      {
+        if (candidate.key == lookup.accountKey)
+        {
+          table = &candidate;
+        }
+      }
+      TEST_ASSERT_TRUE(table != nullptr);
+      for (uint8_t index : lookup.writableIndexes)
+      {
+        keys.push_back(table->addresses[index]);
+      }
+      for (uint8_t index : lookup.readonlyIndexes)
+      {
+        readonly.push_back(table->addresses[index]);
+      }
+    }
+    keys.insert(keys.end(), readonly.begin(), readonly.end());
+  }
+
+  // Every instruction resolves to the program and accounts it was built from
+  void checkResolves(const Message &message, const std::vector<AddressLookupTableAccount> &tables)
+  {
+    const std::vector<Instruction> expected = instructions();
+    std::vector<PublicKey> keys;
+    resolveKeys(message, tables, keys);
+    TEST_ASSERT_EQUAL(expected.size(), message.instructions.size());
+    for (size_t i = 0; i < expected.size(); ++i)
+    {
+      const CompiledInstruction &compiled = message.instructions[i];
+      TEST_ASSERT_TRUE(compiled.programIdIndex < message.accountKeys.size());
+      TEST_ASSERT_TRUE(keys[compiled.programIdIndex] == expected[i].programId);
+      TEST_ASSERT_EQUAL(expected[i].accounts.size(), compiled.accounts.size());
+      for (size_t a = 0; a < compiled.accounts.size(); ++a)
+      {
+        TEST_ASSERT_TRUE(compiled.accounts[a] < keys.size());
+        TEST_ASSERT_TRUE(keys[compiled.accounts[a]] == expected[i].accounts[a].publicKey);
+      }
+      TEST_ASSERT_EQUAL(expected[i].data.size(), compiled.data.size());
+      TEST_ASSERT_EQUAL_UINT8_ARRAY(expected[i].data.data(), compiled.data.data(), compiled.data.size());
+    }
+  }
+
+  // One instruction of PROGRAM over `count` distinct read-only accounts,
+  // which the two `tables` list alternately
+  std::vector<Instruction> manyAccounts(size_t count, std::vector<AddressLookupTableAccount> &tables)
+  {
+    std::vector<AccountMeta> accounts;
+    tables.assign(2, AddressLookupTableAccount{});
+    tables[0].key = key(0xa0);
+    tables[1].key = key(0xa1);
+    for (size_t i = 0; i < count; ++i)
+    {
+      std::vector<uint8_t> bytes(PUBLIC_KEY_LEN, 0);
+      bytes[0] = 0xc0;
+      bytes[1] = static_cast<uint8_t>(i >> 8);
+      bytes[2] = static_cast<uint8_t>(i);
+      accounts.push_back(AccountMeta::newReadonly(PublicKey(bytes), false));
+      tables[i % 2].addresses.push_back(accounts.back().publicKey);
+    }
+    std::vector<Instruction> result;
+    result.emplace_back(PROGRAM, Span<const AccountMeta>(accounts), Span<const uint8_t>());
+    return result;
+  }
+
+  void checkRoundTrips(const Message &message)
+  {
+    std::vector<uint8_t> bytes = message.serialize();
+    TEST_ASSERT_EQUAL(message.serializedSize(), bytes.size());
+    TEST_ASSERT_EQUAL(0x80, bytes[0]);
+    Message decoded = Message::deserialize(bytes);
+    TEST_ASSERT_TRUE(decoded.versioned);
+    std::vector<uint8_t> again = decoded.serialize();
+    TEST_ASSERT_EQUAL(bytes.size(), again.size());
+    TEST_ASSERT_EQUAL_UINT8_ARRAY(bytes.data(), again.data(), bytes.size());
+  }
+}
+
+void setUp() {}
+
+void tearDown() {}
+
+void test_without_tables_matches_legacy_compile()
+{
+  Message v0 = Message::compileV0(instructions(), PAYER, {}, BLOCKHASH);
+  Message legacy = Message::newWithBlockhash(instructions(), PAYER, BLOCKHASH);
+  TEST_ASSERT_EQUAL(0, v0.addressTableLookups.size());
+
+  std::vector<uint8_t> v0Bytes = v0.serialize();
+  std::vector<uint8_t> legacyBytes = legacy.serialize();
+  TEST_ASSERT_EQUAL(legacyBytes.size(), v0Bytes.size());
+  TEST_ASSERT_EQUAL_UINT8_ARRAY(legacyBytes.data(), v0Bytes.data(), v0Bytes.size());
+  checkResolves(v0, {});
+}
+
+void test_loads_from_table()
+{
+  // Signers and the invoked program stay static even when listed
+  std::vector<AddressLookupTableAccount> tables = {
+      {key(0xa0), {OTHER, READONLY_B, WRITABLE_A, SIGNER, PROGRAM, WRITABLE_B, READONLY_A}},
+  };
+  Message message = Message::compileV0(instructions(), PAYER, tables, BLOCKHASH);
+
+  TEST_ASSERT_EQUAL(2, message.header.numRequiredSignatures);
+  TEST_ASSERT_EQUAL(1, message.header.numReadonlySignedAccounts);
+  TEST_ASSERT_EQUAL(2, message.header.numReadonlyUnsignedAccounts);
+  TEST_ASSERT_EQUAL(4, message.accountKeys.size());
+  TEST_ASSERT_TRUE(message.accountKeys[0] == PAYER);
+  TEST_ASSERT_TRUE(message.accountKeys[1] == SIGNER);
+
+  TEST_ASSERT_EQUAL(1, message.addressTableLookups.size());
+  const AddressLookupTable &lookup = message.addressTableLookups[0];
+  TEST_ASSERT_TRUE(lookup.accountKey == tables[0].key);
+  const uint8_t writable[] = {2, 5};
+  const uint8_t readonly[] = {1, 6};
+  TEST_ASSERT_EQUAL(2, lookup.writableIndexes.size());
+  TEST_ASSERT_EQUAL_UINT8_ARRAY(writable, lookup.writableIndexes.data(), 2);
+  TEST_ASSERT_EQUAL(2, lookup.readonlyIndexes.size());
+  TEST_ASSERT_EQUAL_UINT8_ARRAY(readonly, lookup.readonlyIndexes.data(), 2);
+
+  checkResolves(message, tables);
+  checkRoundTrips(message);
+
+  // Each loaded key costs one index byte instead of 32 key bytes
+  Message withoutTables = Message::compileV0(instructions(), PAYER, {}, BLOCKHASH);
+  TEST_ASSERT_TRUE(message.serializedSize() < withoutTables.serializedSize());
+}
+
+void test_picks_tables_that_shrink_the_message()
+{
+  // The second table covers the most keys and is taken first, leaving one
+  // key for the first table, too few to pay for its lookup. The third
+  // covers only keys already loaded.
+  std::vector<AddressLookupTableAccount> tables = {
+      {key(0xa0), {WRITABLE_A, UNLISTED}},
+      {key(0xa1), {READONLY_A, WRITABLE_A, READONLY_B, WRITABLE_B}},
+      {key(0xa2), {WRITABLE_B, READONLY_B}},
+  };
+  Message message = Message::compileV0(instructions(), PAYER, tables, BLOCKHASH);
+
+  TEST_ASSERT_EQUAL(1, message.addressTableLookups.size());
+  TEST_ASSERT_TRUE(message.addressTableLookups[0].accountKey == tables[1].key);
+  const uint8_t writable[] = {1, 3};
+  const uint8_t readonly[] = {0, 2};
+  TEST_ASSERT_EQUAL_UINT8_ARRAY(writable, message.addressTableLookups[0].writableIndexes.data(), 2);
+  TEST_ASSERT_EQUAL_UINT8_ARRAY(readonly, message.addressTableLookups[0].readonlyIndexes.data(), 2);
+
+  // UNLISTED stays static, read-only with the program
+  TEST_ASSERT_EQUAL(4, message.accountKeys.size());
+  TEST_ASSERT_EQUAL(2, message.header.numReadonlyUnsignedAccounts);
+  checkResolves(message, tables);
+  checkRoundTrips(message);
+}
+
+void test_account_index_overflow()
+{
+  // With the payer and the program, 254 accounts are the most a one byte
+  // index reaches, whether their keys are static or loaded
+  std::vector<AddressLookupTableAccount> tables;
+  std::vector<Instruction> fits = manyAccounts(254, tables);
+  Result<Message> compiled = Message::tryCompileV0(fits, PAYER, {}, BLOCKHASH);
+  TEST_ASSERT_TRUE(static_cast<bool>(compiled));
+  TEST_ASSERT_EQUAL(256, compiled.value().accountKeys.size());
+
+  compiled = Message::tryCompileV0(fits, PAYER, tables, BLOCKHASH);
+  TEST_ASSERT_TRUE(static_cast<bool>(compiled));
+  TEST_ASSERT_EQUAL(2, compiled.value().accountKeys.size());
+  TEST_ASSERT_EQUAL(2, compiled.value().addressTableLookups.size());
+  TEST_ASSERT_EQUAL(127, compiled.value().addressTableLookups[0].readonlyIndexes.size());
+  TEST_ASSERT_EQUAL(127, compiled.value().addressTableLookups[1].readonlyIndexes.size());
+
+  std::vector<Instruction> tooMany = manyAccounts(255, tables);
+  compiled = Message::tryCompileV0(tooMany, PAYER, {}, BLOCKHASH);
+  TEST_ASSERT_FALSE(static_cast<bool>(compiled));
+  TEST_ASSERT_EQUAL_STRING("AccountIndexOverflow", compiled.error().what());
+
+  compiled = Message::tryCompileV0(tooMany, PAYER, tables, BLOCKHASH);
+  TEST_ASSERT_FALSE(static_cast<bool>(compiled));
+  TEST_ASSERT_EQUAL_STRING("AccountIndexOverflow", compiled.error().what());
+}
+
+void setup()
+{
+  // Wait for the serial monitor
+  delay(2000);
+
+  UNITY_BEGIN();
+  RUN_TEST(test_without_tables_matches_legacy_compile);
+  RUN_TEST(test_loads_from_table);
+  RUN_TEST(test_picks_tables_that_shrink_the_message);
+  RUN_TEST(test_account_index_overflow);
+  UNITY_END();
+}
+
+void loop() {}